@@ -1,111 +1,90 @@
-#include "ds18b20.h"
-#include <stdint.h>
-#include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
-#include "rom/ets_sys.h"
+/**
+ * @file ds18b20.c
+ * @brief DS18B20 protocol on top of onewire_bus_t
+ */
 
-static inline void ow_drive_low(gpio_num_t pin){
-    gpio_set_direction(pin, GPIO_MODE_OUTPUT);
-    gpio_set_level(pin, 0);
-}
-static inline void ow_release(gpio_num_t pin){
-    gpio_set_direction(pin, GPIO_MODE_INPUT);
-}
-static inline int ow_read(gpio_num_t pin){
-    return gpio_get_level(pin);
-}
+#include "ds18b20.h"
+#include <string.h>
 
+static int ds18b20_search(onewire_bus_t *bus, uint8_t command, uint8_t (*roms)[8], int max) {
+    onewire_search_t search = { .command = command };
+    int count = 0;
 
-static void ow_init(gpio_num_t pin)
-{
-    gpio_config_t io = {
-        .pin_bit_mask = 1ULL << pin,
-        .mode = GPIO_MODE_INPUT_OUTPUT_OD,   // open-drain!
-        .pull_up_en = GPIO_PULLUP_ENABLE,
-        .pull_down_en = GPIO_PULLDOWN_DISABLE,
-        .intr_type = GPIO_INTR_DISABLE
-    };
-    gpio_config(&io);
-    gpio_set_level(pin, 1);
+    while (count < max && onewire_search_next(bus, &search)) {
+        if (search.rom[0] != DS18B20_FAMILY_CODE) {
+            continue;
+        }
+        memcpy(roms[count++], search.rom, 8);
+    }
+    return count;
 }
 
-static int ow_reset(gpio_num_t pin)
-{
-    int presence;
-
-    gpio_set_direction(pin, GPIO_MODE_OUTPUT_OD);
-    gpio_set_level(pin, 0);
-    ets_delay_us(480);
-
-    gpio_set_level(pin, 1);
-    gpio_set_direction(pin, GPIO_MODE_INPUT);
-    ets_delay_us(70);
-
-    presence = (gpio_get_level(pin) == 0);   // DS18 trage low dacă e prezent
-    ets_delay_us(410);
-
-    return presence;
+int ds18b20_enumerate(onewire_bus_t *bus, uint8_t (*roms)[8], int max) {
+    return ds18b20_search(bus, OW_CMD_SEARCH_ROM, roms, max);
 }
 
-static void ow_write_bit(gpio_num_t pin, int v){
-    ow_drive_low(pin);
-    if (v) { ets_delay_us(6);  ow_release(pin); ets_delay_us(64); }
-    else   { ets_delay_us(60); ow_release(pin); ets_delay_us(10); }
+int ds18b20_alarm_search(onewire_bus_t *bus, uint8_t (*roms)[8], int max) {
+    return ds18b20_search(bus, OW_CMD_ALARM_SEARCH, roms, max);
 }
 
-static int ow_read_bit(gpio_num_t pin){
-    ow_drive_low(pin);
-    ets_delay_us(6);
-    ow_release(pin);
-    ets_delay_us(9);
-    int r = ow_read(pin);
-    ets_delay_us(55);
-    return r;
+esp_err_t ds18b20_convert_all(onewire_bus_t *bus) {
+    esp_err_t err = onewire_select(bus, NULL);
+    if (err != ESP_OK) {
+        return err;
+    }
+    return onewire_write_byte(bus, DS18B20_CMD_CONVERT_T);
 }
 
-static void ow_write_byte(gpio_num_t pin, uint8_t b){
-    for (int i=0;i<8;i++) ow_write_bit(pin, (b>>i)&1);
-}
-static uint8_t ow_read_byte(gpio_num_t pin){
-    uint8_t r=0;
-    for (int i=0;i<8;i++) r |= (uint8_t)(ow_read_bit(pin)<<i);
-    return r;
+esp_err_t ds18b20_read_scratchpad(onewire_bus_t *bus, const uint8_t *rom, uint8_t sp[DS18B20_SCRATCHPAD_LEN]) {
+    esp_err_t err = onewire_select(bus, rom);
+    if (err != ESP_OK) {
+        return err;
+    }
+    err = onewire_write_byte(bus, DS18B20_CMD_READ_SCRATCH);
+    if (err != ESP_OK) {
+        return err;
+    }
+    return onewire_read_bytes(bus, sp, DS18B20_SCRATCHPAD_LEN);
 }
 
-static uint8_t crc8(const uint8_t *data, int len){
-    uint8_t crc=0;
-    for (int i=0;i<len;i++){
-        uint8_t inbyte=data[i];
-        for (int j=0;j<8;j++){
-            uint8_t mix=(crc^inbyte)&1;
-            crc>>=1;
-            if(mix) crc^=0x8C;
-            inbyte>>=1;
-        }
+esp_err_t ds18b20_write_scratchpad(onewire_bus_t *bus, const uint8_t *rom, int8_t th, int8_t tl, uint8_t config) {
+    esp_err_t err = onewire_select(bus, rom);
+    if (err != ESP_OK) {
+        return err;
     }
-    return crc;
+    const uint8_t frame[4] = { DS18B20_CMD_WRITE_SCRATCH, (uint8_t)th, (uint8_t)tl, config };
+    return onewire_write_bytes(bus, frame, sizeof(frame));
 }
 
-float ds18b20_read_temperature(gpio_num_t pin)
-{
-    ow_init(pin);
-
-    if(!ow_reset(pin)) return NAN;
-
-    ow_write_byte(pin, 0xCC); // SKIP ROM
-    ow_write_byte(pin, 0x44); // CONVERT T
-    vTaskDelay(pdMS_TO_TICKS(750));
-
-    if(!ow_reset(pin)) return NAN;
+esp_err_t ds18b20_parse_scratchpad(const uint8_t sp[DS18B20_SCRATCHPAD_LEN], int16_t *raw) {
+    // All-0 passes the CRC, all-1 is an idle bus: reject both up front
+    uint8_t all_or = 0, all_and = 0xFF;
+    for (int i = 0; i < DS18B20_SCRATCHPAD_LEN; i++) {
+        all_or |= sp[i];
+        all_and &= sp[i];
+    }
+    if (all_or == 0x00 || all_and == 0xFF) {
+        return ESP_ERR_INVALID_RESPONSE;
+    }
 
-    ow_write_byte(pin, 0xCC);
-    ow_write_byte(pin, 0xBE); // READ SCRATCHPAD
+    if (onewire_crc8(sp, DS18B20_SP_CRC) != sp[DS18B20_SP_CRC]) {
+        return ESP_ERR_INVALID_CRC;
+    }
 
-    uint8_t l = ow_read_byte(pin);
-    uint8_t h = ow_read_byte(pin);
+    int16_t value = (int16_t)((sp[DS18B20_SP_TEMP_MSB] << 8) | sp[DS18B20_SP_TEMP_LSB]);
+    if (value == DS18B20_POWER_ON_RAW) {
+        return ESP_ERR_INVALID_STATE;
+    }
 
-    int16_t raw = (int16_t)((h << 8) | l);
-    return (float)raw / 16.0f;
+    *raw = value;
+    return ESP_OK;
 }
 
-
+esp_err_t ds18b20_read_raw(onewire_bus_t *bus, const uint8_t *rom, int16_t *raw) {
+    uint8_t sp[DS18B20_SCRATCHPAD_LEN];
+    esp_err_t err = ds18b20_read_scratchpad(bus, rom, sp);
+    if (err != ESP_OK) {
+        return err;
+    }
+    return ds18b20_parse_scratchpad(sp, raw);
+}
@@ -1,4 +1,97 @@
+/**
+ * @file ds18b20.h
+ * @brief DS18B20 protocol on top of onewire_bus_t
+ *
+ * Temperatures are raw sensor units: 1/16 degC, signed.
+ */
+
 #pragma once
-#include <math.h>
-#include "driver/gpio.h"
-float ds18b20_read_temperature(gpio_num_t pin);
+#include <stdint.h>
+#include "onewire_bus.h"
+
+#define DS18B20_FAMILY_CODE         0x28
+
+// Function commands
+#define DS18B20_CMD_CONVERT_T       0x44
+#define DS18B20_CMD_WRITE_SCRATCH   0x4E
+#define DS18B20_CMD_READ_SCRATCH    0xBE
+#define DS18B20_CMD_COPY_SCRATCH    0x48
+#define DS18B20_CMD_RECALL_E2       0xB8
+
+// Scratchpad layout
+#define DS18B20_SCRATCHPAD_LEN      9
+#define DS18B20_SP_TEMP_LSB         0
+#define DS18B20_SP_TEMP_MSB         1
+#define DS18B20_SP_TH               2
+#define DS18B20_SP_TL               3
+#define DS18B20_SP_CONFIG           4
+#define DS18B20_SP_CRC              8
+
+// Temperature register before the first conversion (85.0 degC)
+#define DS18B20_POWER_ON_RAW        0x0550
+
+// Resolution range (bits). Conversion time halves with every bit dropped.
+#define DS18B20_RESOLUTION_MIN      9
+#define DS18B20_RESOLUTION_MAX      12
+
+/**
+ * Search the bus for DS18B20s (other families are skipped).
+ * @return number of ROM codes stored in roms
+ */
+int ds18b20_enumerate(onewire_bus_t *bus, uint8_t (*roms)[8], int max);
+
+/**
+ * Alarm Search: DS18B20s whose last conversion had the integer part of the
+ * temperature <= TL or >= TH.
+ * @return number of ROM codes stored in roms (0: no alarm)
+ */
+int ds18b20_alarm_search(onewire_bus_t *bus, uint8_t (*roms)[8], int max);
+
+/**
+ * Skip ROM + Convert T: every device on the bus starts converting.
+ */
+esp_err_t ds18b20_convert_all(onewire_bus_t *bus);
+
+/**
+ * Read the 9-byte scratchpad of one device (rom == NULL: Skip ROM, single drop).
+ */
+esp_err_t ds18b20_read_scratchpad(onewire_bus_t *bus, const uint8_t *rom, uint8_t sp[DS18B20_SCRATCHPAD_LEN]);
+
+/**
+ * Validate a scratchpad and extract the temperature register.
+ * @return ESP_ERR_INVALID_CRC on CRC mismatch,
+ *         ESP_ERR_INVALID_RESPONSE for an all-0 / all-1 frame (bus stuck),
+ *         ESP_ERR_INVALID_STATE for the power-on value (no conversion yet)
+ */
+esp_err_t ds18b20_parse_scratchpad(const uint8_t sp[DS18B20_SCRATCHPAD_LEN], int16_t *raw);
+
+/**
+ * Write TH, TL and the configuration register (rom == NULL: every device).
+ */
+esp_err_t ds18b20_write_scratchpad(onewire_bus_t *bus, const uint8_t *rom, int8_t th, int8_t tl, uint8_t config);
+
+// Raw (1/16 degC) to centi-degC, rounded half away from zero. Exact:
+// raw * 25 is the value in quarter centi-degrees.
+static inline int16_t ds18b20_raw_to_centi(int16_t raw) {
+    int32_t q = (int32_t)raw * 25;
+    return (int16_t)((q >= 0 ? q + 2 : q - 2) / 4);
+}
+
+// Configuration register value for 9..12 bits (R1:R0 in bits 6:5)
+static inline uint8_t ds18b20_resolution_to_config(int bits) {
+    return (uint8_t)(((bits - DS18B20_RESOLUTION_MIN) << 5) | 0x1F);
+}
+
+static inline int ds18b20_config_to_resolution(uint8_t config) {
+    return DS18B20_RESOLUTION_MIN + ((config >> 5) & 0x03);
+}
+
+// Maximum conversion time from the datasheet: 93.75ms << (bits - 9), rounded up
+static inline uint32_t ds18b20_conversion_time_ms(int bits) {
+    return (750u >> (DS18B20_RESOLUTION_MAX - bits)) + (bits < 11 ? 1 : 0);
+}
+
+/**
+ * Read and validate the temperature of one device.
+ */
+esp_err_t ds18b20_read_raw(onewire_bus_t *bus, const uint8_t *rom, int16_t *raw);
@@ -0,0 +1,124 @@
+/**
+ * @file onewire_bus.h
+ * @brief 1-Wire bus with pluggable transports
+ *
+ * Transports:
+ * - RMT: slots generated and sampled by the RMT peripheral, no critical sections
+ * - GPIO bit-bang: fallback, short critical sections per byte (pin access via
+ *   onewire_gpio_hal_t, so the slot logic also runs on the host)
+ * - Simulation: DS18B20 devices modelled in software (onewire_sim.h)
+ *
+ * This header and the generic layer have no driver dependencies and build
+ * for the linux target.
+ *
+ * Bit order on the wire is LSB first for every transfer.
+ */
+
+#ifndef ONEWIRE_BUS_H
+#define ONEWIRE_BUS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+// Slot timing (microseconds), shared by all transports
+#define OW_RESET_LOW_US         480     // Reset pulse
+#define OW_PRESENCE_SAMPLE_US   70      // Release -> sample presence
+#define OW_RESET_RECOVERY_US    410     // Rest of the presence window
+#define OW_WRITE1_LOW_US        6
+#define OW_WRITE1_HIGH_US       64
+#define OW_WRITE0_LOW_US        60
+#define OW_WRITE0_HIGH_US       10
+#define OW_READ_LOW_US          6       // Read slot start pulse
+#define OW_READ_SAMPLE_US       15      // Slot start -> sample point
+#define OW_READ_HIGH_US         64      // Release -> end of slot
+
+// ROM commands
+#define OW_CMD_SEARCH_ROM   0xF0
+#define OW_CMD_MATCH_ROM    0x55
+#define OW_CMD_SKIP_ROM     0xCC
+#define OW_CMD_ALARM_SEARCH 0xEC    // Search among devices with an alarm flag
+
+typedef struct onewire_bus onewire_bus_t;
+
+/**
+ * Transport operations. Every call is a complete, self-timed bus action.
+ */
+typedef struct {
+    // Reset pulse + presence detect. ESP_ERR_NOT_FOUND if nobody answered.
+    esp_err_t (*reset)(onewire_bus_t *bus);
+    // Write `bits` bits from data (LSB first)
+    esp_err_t (*write_bits)(onewire_bus_t *bus, const uint8_t *data, size_t bits);
+    // Issue `bits` read slots into data (LSB first)
+    esp_err_t (*read_bits)(onewire_bus_t *bus, uint8_t *data, size_t bits);
+    // Optional: claim/release the peripheral between transactions (so an
+    // idle bus does not hold the driver's power management lock)
+    esp_err_t (*set_active)(onewire_bus_t *bus, bool active);
+    void (*del)(onewire_bus_t *bus);
+} onewire_ops_t;
+
+struct onewire_bus {
+    const onewire_ops_t *ops;
+    int pin;                // GPIO number, -1 for simulated buses
+    const char *name;
+};
+
+/**
+ * Pin access for the bit-bang transport. All callbacks get `ctx`.
+ */
+typedef struct {
+    void (*setup)(void *ctx);           // Open-drain + pull-up, line released
+    void (*drive_low)(void *ctx);
+    void (*release)(void *ctx);
+    int  (*read)(void *ctx);            // Line level: 0 or 1
+    void (*delay_us)(void *ctx, uint32_t us);
+    void (*enter_critical)(void *ctx);  // Around each reset and byte
+    void (*exit_critical)(void *ctx);
+    void *ctx;
+} onewire_gpio_hal_t;
+
+// Search state (Maxim AN187). Zero-initialize before the first call.
+typedef struct {
+    uint8_t command;            // 0: Search ROM, or OW_CMD_ALARM_SEARCH
+    uint8_t rom[8];
+    int last_discrepancy;
+    bool last_device;
+} onewire_search_t;
+
+/**
+ * Create a bus on GPIO `pin` driven by the RMT peripheral.
+ */
+esp_err_t onewire_new_rmt_bus(int pin, onewire_bus_t **ret_bus);
+
+/**
+ * Create a bus on GPIO `pin` driven by bit-banging (fallback).
+ */
+esp_err_t onewire_new_gpio_bus(int pin, onewire_bus_t **ret_bus);
+
+/**
+ * Create a bit-banged bus on top of any pin implementation. `hal` is copied.
+ */
+esp_err_t onewire_new_gpio_bus_with_hal(const onewire_gpio_hal_t *hal, int pin, onewire_bus_t **ret_bus);
+
+void onewire_del_bus(onewire_bus_t *bus);
+
+// Bracket bus work with active = true / false. No-op for transports that
+// hold nothing while idle. The line is left released (high) when inactive.
+esp_err_t onewire_set_active(onewire_bus_t *bus, bool active);
+
+esp_err_t onewire_reset(onewire_bus_t *bus);
+esp_err_t onewire_write_bytes(onewire_bus_t *bus, const uint8_t *data, size_t len);
+esp_err_t onewire_read_bytes(onewire_bus_t *bus, uint8_t *data, size_t len);
+esp_err_t onewire_write_byte(onewire_bus_t *bus, uint8_t value);
+
+// Reset + Match ROM (rom != NULL) or Skip ROM (rom == NULL)
+esp_err_t onewire_select(onewire_bus_t *bus, const uint8_t rom[8]);
+
+// Find the next ROM. Returns false when done or on bus/CRC error.
+bool onewire_search_next(onewire_bus_t *bus, onewire_search_t *search);
+
+// Dallas/Maxim CRC8 (x^8 + x^5 + x^4 + 1), table driven
+uint8_t onewire_crc8(const uint8_t *data, size_t len);
+
+#endif // ONEWIRE_BUS_H
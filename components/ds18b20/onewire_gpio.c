@@ -0,0 +1,111 @@
+/**
+ * @file onewire_gpio.c
+ * @brief Bit-banged 1-Wire transport (fallback when RMT is unavailable)
+ *
+ * Slot timing comes from busy-waits, so each reset and each byte runs inside
+ * a critical section. Pin access goes through onewire_gpio_hal_t; the ESP
+ * implementation lives in onewire_gpio_esp.c. Prefer the RMT transport.
+ */
+
+#include "onewire_bus.h"
+#include <stdlib.h>
+
+typedef struct {
+    onewire_bus_t base;
+    onewire_gpio_hal_t hal;
+} onewire_gpio_bus_t;
+
+static void ow_write_bit(const onewire_gpio_hal_t *h, int v) {
+    h->drive_low(h->ctx);
+    if (v) {
+        h->delay_us(h->ctx, OW_WRITE1_LOW_US);
+        h->release(h->ctx);
+        h->delay_us(h->ctx, OW_WRITE1_HIGH_US);
+    } else {
+        h->delay_us(h->ctx, OW_WRITE0_LOW_US);
+        h->release(h->ctx);
+        h->delay_us(h->ctx, OW_WRITE0_HIGH_US);
+    }
+}
+
+static int ow_read_bit(const onewire_gpio_hal_t *h) {
+    h->drive_low(h->ctx);
+    h->delay_us(h->ctx, OW_READ_LOW_US);
+    h->release(h->ctx);
+    h->delay_us(h->ctx, OW_READ_SAMPLE_US - OW_READ_LOW_US);
+    int b = h->read(h->ctx);
+    h->delay_us(h->ctx, OW_READ_HIGH_US - (OW_READ_SAMPLE_US - OW_READ_LOW_US));
+    return b;
+}
+
+static esp_err_t gpio_reset(onewire_bus_t *bus) {
+    const onewire_gpio_hal_t *h = &((onewire_gpio_bus_t *)bus)->hal;
+
+    // Configure GPIO each time (needed for reliable readings)
+    h->setup(h->ctx);
+
+    h->enter_critical(h->ctx);
+    h->drive_low(h->ctx);
+    h->delay_us(h->ctx, OW_RESET_LOW_US);
+    h->release(h->ctx);
+    h->delay_us(h->ctx, OW_PRESENCE_SAMPLE_US);
+    int presence = (h->read(h->ctx) == 0);
+    h->delay_us(h->ctx, OW_RESET_RECOVERY_US);
+    h->exit_critical(h->ctx);
+
+    return presence ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+// One critical section per byte keeps interrupts masked for ~560us at most
+static esp_err_t gpio_write_bits(onewire_bus_t *bus, const uint8_t *data, size_t bits) {
+    const onewire_gpio_hal_t *h = &((onewire_gpio_bus_t *)bus)->hal;
+    for (size_t i = 0; i < bits; i += 8) {
+        size_t n = (bits - i) < 8 ? (bits - i) : 8;
+        uint8_t v = data[i / 8];
+        h->enter_critical(h->ctx);
+        for (size_t b = 0; b < n; b++)
+            ow_write_bit(h, (v >> b) & 1);
+        h->exit_critical(h->ctx);
+    }
+    return ESP_OK;
+}
+
+static esp_err_t gpio_read_bits(onewire_bus_t *bus, uint8_t *data, size_t bits) {
+    const onewire_gpio_hal_t *h = &((onewire_gpio_bus_t *)bus)->hal;
+    for (size_t i = 0; i < bits; i += 8) {
+        size_t n = (bits - i) < 8 ? (bits - i) : 8;
+        uint8_t r = 0;
+        h->enter_critical(h->ctx);
+        for (size_t b = 0; b < n; b++)
+            r |= (ow_read_bit(h) << b);
+        h->exit_critical(h->ctx);
+        data[i / 8] = r;
+    }
+    return ESP_OK;
+}
+
+static void gpio_del(onewire_bus_t *bus) {
+    free(bus);
+}
+
+static const onewire_ops_t gpio_ops = {
+    .reset = gpio_reset,
+    .write_bits = gpio_write_bits,
+    .read_bits = gpio_read_bits,
+    .del = gpio_del,
+};
+
+esp_err_t onewire_new_gpio_bus_with_hal(const onewire_gpio_hal_t *hal, int pin, onewire_bus_t **ret_bus) {
+    onewire_gpio_bus_t *g = calloc(1, sizeof(*g));
+    if (g == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    g->base.ops = &gpio_ops;
+    g->base.pin = pin;
+    g->base.name = "gpio";
+    g->hal = *hal;
+
+    g->hal.setup(g->hal.ctx);
+    *ret_bus = &g->base;
+    return ESP_OK;
+}
@@ -0,0 +1,86 @@
+/**
+ * @file onewire_gpio_esp.c
+ * @brief ESP GPIO implementation of onewire_gpio_hal_t
+ */
+
+#include "onewire_bus.h"
+#include "freertos/FreeRTOS.h"
+#include "driver/gpio.h"
+#include "esp_rom_sys.h"
+#include <stdlib.h>
+
+typedef struct {
+    gpio_num_t pin;
+    portMUX_TYPE lock;
+} ow_esp_pin_t;
+
+static void esp_setup(void *ctx) {
+    ow_esp_pin_t *p = ctx;
+    gpio_config_t io = {
+        .pin_bit_mask = 1ULL << p->pin,
+        .mode = GPIO_MODE_INPUT_OUTPUT_OD,
+        .pull_up_en = GPIO_PULLUP_ENABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_DISABLE,
+    };
+    gpio_config(&io);
+    gpio_set_level(p->pin, 1);
+}
+
+static void esp_drive_low(void *ctx) {
+    ow_esp_pin_t *p = ctx;
+    gpio_set_direction(p->pin, GPIO_MODE_OUTPUT_OD);
+    gpio_set_level(p->pin, 0);
+}
+
+static void esp_release(void *ctx) {
+    ow_esp_pin_t *p = ctx;
+    gpio_set_direction(p->pin, GPIO_MODE_INPUT_OUTPUT_OD);
+    gpio_set_level(p->pin, 1);
+}
+
+static int esp_read(void *ctx) {
+    ow_esp_pin_t *p = ctx;
+    return gpio_get_level(p->pin);
+}
+
+static void esp_delay_us(void *ctx, uint32_t us) {
+    (void)ctx;
+    esp_rom_delay_us(us);
+}
+
+static void esp_enter_critical(void *ctx) {
+    ow_esp_pin_t *p = ctx;
+    portENTER_CRITICAL(&p->lock);
+}
+
+static void esp_exit_critical(void *ctx) {
+    ow_esp_pin_t *p = ctx;
+    portEXIT_CRITICAL(&p->lock);
+}
+
+esp_err_t onewire_new_gpio_bus(int pin, onewire_bus_t **ret_bus) {
+    // Pin context lives as long as the firmware; buses are never torn down
+    ow_esp_pin_t *p = calloc(1, sizeof(*p));
+    if (p == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    p->pin = (gpio_num_t)pin;
+    portMUX_INITIALIZE(&p->lock);
+
+    const onewire_gpio_hal_t hal = {
+        .setup = esp_setup,
+        .drive_low = esp_drive_low,
+        .release = esp_release,
+        .read = esp_read,
+        .delay_us = esp_delay_us,
+        .enter_critical = esp_enter_critical,
+        .exit_critical = esp_exit_critical,
+        .ctx = p,
+    };
+    esp_err_t err = onewire_new_gpio_bus_with_hal(&hal, pin, ret_bus);
+    if (err != ESP_OK) {
+        free(p);
+    }
+    return err;
+}
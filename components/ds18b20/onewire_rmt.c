@@ -0,0 +1,263 @@
+/**
+ * @file onewire_rmt.c
+ * @brief RMT-driven 1-Wire transport
+ *
+ * TX and RX channels share the open-drain pin (loop-back). Slots are timed by
+ * the RMT peripheral and the task blocks on the RX-done queue, so interrupts
+ * stay enabled for the whole transfer.
+ *
+ * An enabled RMT channel holds the driver's power management lock, so the
+ * channels are disabled while the bus is inactive (onewire_set_active).
+ */
+
+#include "onewire_bus.h"
+#include "onewire_rmt_symbols.h"
+#include "driver/rmt_tx.h"
+#include "driver/rmt_rx.h"
+#include "driver/gpio.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include <stdlib.h>
+
+static const char *TAG = "OW_RMT";
+
+// Slots per RMT transfer: fits one RX memory block, so no refill is needed
+#define OW_RMT_MAX_SLOTS        32
+#define OW_RMT_MEM_SYMBOLS      48
+#define OW_RMT_TIMEOUT_MS       50
+
+// RX ends when the line is idle this long: longer than the reset pulse for
+// reset frames, longer than a released slot for read frames
+#define OW_RMT_RESET_IDLE_NS    ((OW_RESET_LOW_US + 100) * 1000)
+#define OW_RMT_SLOT_IDLE_NS     ((OW_READ_HIGH_US + 30) * 1000)
+#define OW_RMT_GLITCH_NS        1000
+
+typedef struct {
+    onewire_bus_t base;
+    rmt_channel_handle_t tx_chan;
+    rmt_channel_handle_t rx_chan;
+    rmt_encoder_handle_t copy_encoder;
+    QueueHandle_t rx_queue;
+    rmt_symbol_word_t tx_buf[OW_RMT_MAX_SLOTS];
+    rmt_symbol_word_t rx_buf[OW_RMT_MEM_SYMBOLS];
+    bool active;                // Channels enabled
+} onewire_rmt_bus_t;
+
+static const rmt_transmit_config_t ow_tx_config = {
+    .loop_count = 0,
+    .flags.eot_level = 1,   // Leave the bus released
+};
+
+static bool IRAM_ATTR ow_rx_done_cb(rmt_channel_handle_t chan, const rmt_rx_done_event_data_t *edata, void *user_ctx) {
+    BaseType_t woken = pdFALSE;
+    xQueueSendFromISR((QueueHandle_t)user_ctx, edata, &woken);
+    return woken == pdTRUE;
+}
+
+static esp_err_t ow_rmt_transmit(onewire_rmt_bus_t *r, size_t count) {
+    esp_err_t err = rmt_transmit(r->tx_chan, r->copy_encoder, r->tx_buf,
+                                 count * sizeof(rmt_symbol_word_t), &ow_tx_config);
+    if (err != ESP_OK) {
+        return err;
+    }
+    return rmt_tx_wait_all_done(r->tx_chan, OW_RMT_TIMEOUT_MS);
+}
+
+// Transmit tx_buf[0..count) while capturing the looped-back line
+static esp_err_t ow_rmt_transceive(onewire_rmt_bus_t *r, size_t count, uint32_t idle_ns, size_t *rx_count) {
+    const rmt_receive_config_t rx_config = {
+        .signal_range_min_ns = OW_RMT_GLITCH_NS,
+        .signal_range_max_ns = idle_ns,
+    };
+    rmt_rx_done_event_data_t evt;
+
+    xQueueReset(r->rx_queue);
+    esp_err_t err = rmt_receive(r->rx_chan, r->rx_buf, sizeof(r->rx_buf), &rx_config);
+    if (err != ESP_OK) {
+        return err;
+    }
+    err = ow_rmt_transmit(r, count);
+    if (err != ESP_OK) {
+        return err;
+    }
+    if (xQueueReceive(r->rx_queue, &evt, pdMS_TO_TICKS(OW_RMT_TIMEOUT_MS)) != pdTRUE) {
+        // Abort the pending receive so the next transfer starts clean
+        rmt_disable(r->rx_chan);
+        rmt_enable(r->rx_chan);
+        return ESP_ERR_TIMEOUT;
+    }
+    *rx_count = evt.num_symbols;
+    return ESP_OK;
+}
+
+static esp_err_t rmt_bus_reset(onewire_bus_t *bus) {
+    onewire_rmt_bus_t *r = (onewire_rmt_bus_t *)bus;
+    size_t rx_count = 0;
+
+    size_t n = onewire_rmt_encode_reset(r->tx_buf);
+    esp_err_t err = ow_rmt_transceive(r, n, OW_RMT_RESET_IDLE_NS, &rx_count);
+    if (err != ESP_OK) {
+        return err;
+    }
+    return onewire_rmt_decode_presence(r->rx_buf, rx_count) ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+static esp_err_t rmt_bus_write_bits(onewire_bus_t *bus, const uint8_t *data, size_t bits) {
+    onewire_rmt_bus_t *r = (onewire_rmt_bus_t *)bus;
+    for (size_t done = 0; done < bits; ) {
+        size_t chunk = bits - done < OW_RMT_MAX_SLOTS ? bits - done : OW_RMT_MAX_SLOTS;
+        size_t n = onewire_rmt_encode_write(data, done, chunk, r->tx_buf);
+        esp_err_t err = ow_rmt_transmit(r, n);
+        if (err != ESP_OK) {
+            return err;
+        }
+        done += chunk;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t rmt_bus_read_bits(onewire_bus_t *bus, uint8_t *data, size_t bits) {
+    onewire_rmt_bus_t *r = (onewire_rmt_bus_t *)bus;
+    for (size_t done = 0; done < bits; ) {
+        size_t chunk = bits - done < OW_RMT_MAX_SLOTS ? bits - done : OW_RMT_MAX_SLOTS;
+        size_t rx_count = 0;
+        size_t n = onewire_rmt_encode_read(chunk, r->tx_buf);
+        esp_err_t err = ow_rmt_transceive(r, n, OW_RMT_SLOT_IDLE_NS, &rx_count);
+        if (err != ESP_OK) {
+            return err;
+        }
+        if (!onewire_rmt_decode_read(r->rx_buf, rx_count, data, done, chunk)) {
+            return ESP_ERR_INVALID_RESPONSE;
+        }
+        done += chunk;
+    }
+    return ESP_OK;
+}
+
+// TX is disabled only once idle, with the line released (eot_level = 1)
+static esp_err_t rmt_bus_set_active(onewire_bus_t *bus, bool active) {
+    onewire_rmt_bus_t *r = (onewire_rmt_bus_t *)bus;
+    esp_err_t err = ESP_OK;
+    if (active == r->active) {
+        return ESP_OK;
+    }
+    if (active) {
+        if ((err = rmt_enable(r->rx_chan)) != ESP_OK) {
+            return err;
+        }
+        if ((err = rmt_enable(r->tx_chan)) != ESP_OK) {
+            rmt_disable(r->rx_chan);
+            return err;
+        }
+    } else {
+        rmt_tx_wait_all_done(r->tx_chan, OW_RMT_TIMEOUT_MS);
+        rmt_disable(r->tx_chan);
+        rmt_disable(r->rx_chan);
+    }
+    r->active = active;
+    return ESP_OK;
+}
+
+static void rmt_bus_del(onewire_bus_t *bus) {
+    onewire_rmt_bus_t *r = (onewire_rmt_bus_t *)bus;
+    if (r->active) {
+        rmt_disable(r->tx_chan);
+        rmt_disable(r->rx_chan);
+    }
+    if (r->tx_chan) {
+        rmt_del_channel(r->tx_chan);
+    }
+    if (r->rx_chan) {
+        rmt_del_channel(r->rx_chan);
+    }
+    if (r->copy_encoder) {
+        rmt_del_encoder(r->copy_encoder);
+    }
+    if (r->rx_queue) {
+        vQueueDelete(r->rx_queue);
+    }
+    free(r);
+}
+
+static const onewire_ops_t rmt_ops = {
+    .reset = rmt_bus_reset,
+    .write_bits = rmt_bus_write_bits,
+    .read_bits = rmt_bus_read_bits,
+    .set_active = rmt_bus_set_active,
+    .del = rmt_bus_del,
+};
+
+esp_err_t onewire_new_rmt_bus(int pin, onewire_bus_t **ret_bus) {
+    esp_err_t err = ESP_ERR_NO_MEM;
+    onewire_rmt_bus_t *r = calloc(1, sizeof(*r));
+    if (r == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    r->base.ops = &rmt_ops;
+    r->base.pin = pin;
+    r->base.name = "rmt";
+
+    r->rx_queue = xQueueCreate(1, sizeof(rmt_rx_done_event_data_t));
+    if (r->rx_queue == NULL) {
+        goto fail;
+    }
+
+    // RX first, TX on the same pin in open-drain loop-back mode
+    const rmt_rx_channel_config_t rx_cfg = {
+        .clk_src = RMT_CLK_SRC_DEFAULT,
+        .gpio_num = (gpio_num_t)pin,
+        .mem_block_symbols = OW_RMT_MEM_SYMBOLS,
+        .resolution_hz = OW_RMT_RESOLUTION_HZ,
+    };
+    if ((err = rmt_new_rx_channel(&rx_cfg, &r->rx_chan)) != ESP_OK) {
+        goto fail;
+    }
+
+    const rmt_tx_channel_config_t tx_cfg = {
+        .clk_src = RMT_CLK_SRC_DEFAULT,
+        .gpio_num = (gpio_num_t)pin,
+        .mem_block_symbols = OW_RMT_MEM_SYMBOLS,
+        .resolution_hz = OW_RMT_RESOLUTION_HZ,
+        .trans_queue_depth = 1,
+        .flags.io_loop_back = true,
+        .flags.io_od_mode = true,
+    };
+    if ((err = rmt_new_tx_channel(&tx_cfg, &r->tx_chan)) != ESP_OK) {
+        goto fail;
+    }
+
+    const rmt_copy_encoder_config_t enc_cfg = {};
+    if ((err = rmt_new_copy_encoder(&enc_cfg, &r->copy_encoder)) != ESP_OK) {
+        goto fail;
+    }
+
+    const rmt_rx_event_callbacks_t cbs = {
+        .on_recv_done = ow_rx_done_cb,
+    };
+    if ((err = rmt_rx_register_event_callbacks(r->rx_chan, &cbs, r->rx_queue)) != ESP_OK) {
+        goto fail;
+    }
+
+    // Internal pull-up on top of the external one
+    gpio_pullup_en((gpio_num_t)pin);
+
+    if ((err = rmt_bus_set_active(&r->base, true)) != ESP_OK) {
+        goto fail;
+    }
+
+    // Release the bus: a zero-length low level, ending high
+    r->tx_buf[0] = (rmt_symbol_word_t){ .level0 = 1, .duration0 = 1, .level1 = 1, .duration1 = 0 };
+    if ((err = ow_rmt_transmit(r, 1)) != ESP_OK) {
+        goto fail;
+    }
+
+    *ret_bus = &r->base;
+    return ESP_OK;
+
+fail:
+    ESP_LOGE(TAG, "RMT 1-Wire init failed on GPIO%d: %s", pin, esp_err_to_name(err));
+    rmt_bus_del(&r->base);
+    return err;
+}
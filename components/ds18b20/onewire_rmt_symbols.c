@@ -0,0 +1,75 @@
+/**
+ * @file onewire_rmt_symbols.c
+ * @brief 1-Wire slot <-> RMT symbol encoding
+ */
+
+#include "onewire_rmt_symbols.h"
+#include "onewire_bus.h"
+
+static inline rmt_symbol_word_t ow_slot(uint16_t low_us, uint16_t high_us) {
+    rmt_symbol_word_t s = {
+        .level0 = 0,
+        .duration0 = low_us,
+        .level1 = 1,
+        .duration1 = high_us,
+    };
+    return s;
+}
+
+size_t onewire_rmt_encode_reset(rmt_symbol_word_t *out) {
+    out[0] = ow_slot(OW_RESET_LOW_US, OW_PRESENCE_SAMPLE_US + OW_RESET_RECOVERY_US);
+    return 1;
+}
+
+size_t onewire_rmt_encode_write(const uint8_t *data, size_t first, size_t bits, rmt_symbol_word_t *out) {
+    for (size_t i = 0; i < bits; i++) {
+        size_t bit = first + i;
+        if ((data[bit / 8] >> (bit % 8)) & 1) {
+            out[i] = ow_slot(OW_WRITE1_LOW_US, OW_WRITE1_HIGH_US);
+        } else {
+            out[i] = ow_slot(OW_WRITE0_LOW_US, OW_WRITE0_HIGH_US);
+        }
+    }
+    return bits;
+}
+
+size_t onewire_rmt_encode_read(size_t bits, rmt_symbol_word_t *out) {
+    for (size_t i = 0; i < bits; i++) {
+        out[i] = ow_slot(OW_READ_LOW_US, OW_READ_HIGH_US);
+    }
+    return bits;
+}
+
+bool onewire_rmt_decode_presence(const rmt_symbol_word_t *rx, size_t count) {
+    // [0] our reset pulse + gap before presence, [1] presence pulse
+    if (count < 2 || rx[0].level0 != 0) {
+        return false;
+    }
+    if (rx[0].duration0 < OW_RESET_LOW_US - OW_PRESENCE_WAIT_MIN_US) {
+        return false;
+    }
+    if (rx[0].duration1 < OW_PRESENCE_WAIT_MIN_US || rx[0].duration1 > OW_PRESENCE_WAIT_MAX_US) {
+        return false;
+    }
+    return rx[1].level0 == 0 && rx[1].duration0 >= OW_PRESENCE_LOW_MIN_US;
+}
+
+bool onewire_rmt_decode_read(const rmt_symbol_word_t *rx, size_t count, uint8_t *data, size_t first, size_t bits) {
+    if (count < bits) {
+        return false;
+    }
+    for (size_t i = 0; i < bits; i++) {
+        if (rx[i].level0 != 0) {
+            return false;
+        }
+        size_t bit = first + i;
+        uint8_t mask = 1 << (bit % 8);
+        // A device writing 0 stretches our start pulse past the sample point
+        if (rx[i].duration0 < OW_READ_SAMPLE_US) {
+            data[bit / 8] |= mask;
+        } else {
+            data[bit / 8] &= ~mask;
+        }
+    }
+    return true;
+}
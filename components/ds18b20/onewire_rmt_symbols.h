@@ -0,0 +1,41 @@
+/**
+ * @file onewire_rmt_symbols.h
+ * @brief 1-Wire slot <-> RMT symbol encoding (no driver calls)
+ *
+ * RMT runs at 1 MHz, so one tick is one microsecond. Each slot is a single
+ * symbol: low for the start/data part, then released (high) for the rest.
+ * On receive the line is looped back, so each slot shows up as one symbol
+ * whose duration0 is the time the line was held low.
+ */
+
+#ifndef ONEWIRE_RMT_SYMBOLS_H
+#define ONEWIRE_RMT_SYMBOLS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "hal/rmt_types.h"
+
+#define OW_RMT_RESOLUTION_HZ    1000000
+
+// Presence pulse must start within this window after release and last at least the minimum
+#define OW_PRESENCE_WAIT_MIN_US 15
+#define OW_PRESENCE_WAIT_MAX_US 60
+#define OW_PRESENCE_LOW_MIN_US  60
+
+// Reset pulse followed by the presence window
+size_t onewire_rmt_encode_reset(rmt_symbol_word_t *out);
+
+// Write slots for `bits` bits of data starting at bit `first` (LSB first)
+size_t onewire_rmt_encode_write(const uint8_t *data, size_t first, size_t bits, rmt_symbol_word_t *out);
+
+// `bits` read slots
+size_t onewire_rmt_encode_read(size_t bits, rmt_symbol_word_t *out);
+
+// True if the received reset frame contains a valid presence pulse
+bool onewire_rmt_decode_presence(const rmt_symbol_word_t *rx, size_t count);
+
+// Decode `bits` read slots into data starting at bit `first`. False on framing error.
+bool onewire_rmt_decode_read(const rmt_symbol_word_t *rx, size_t count, uint8_t *data, size_t first, size_t bits);
+
+#endif // ONEWIRE_RMT_SYMBOLS_H
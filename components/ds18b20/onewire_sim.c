@@ -0,0 +1,394 @@
+/**
+ * @file onewire_sim.c
+ * @brief Simulated 1-Wire bus with DS18B20 devices
+ *
+ * The bus decodes the master's bit stream with a small state machine and
+ * answers read slots as the wired-AND of every device that is driving.
+ */
+
+#include "onewire_sim.h"
+#include "ds18b20.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define SIM_RESET_US        (OW_RESET_LOW_US + OW_PRESENCE_SAMPLE_US + OW_RESET_RECOVERY_US)
+#define SIM_SLOT_US         (OW_READ_LOW_US + OW_READ_HIGH_US)
+
+// Power-on EEPROM: TH = +75, TL = +70, 12-bit
+#define SIM_DEFAULT_TH      0x4B
+#define SIM_DEFAULT_TL      0x46
+#define SIM_DEFAULT_CONFIG  0x7F
+
+typedef struct {
+    uint8_t rom[8];
+    uint8_t scratchpad[DS18B20_SCRATCHPAD_LEN];
+    uint8_t eeprom[3];          // TH, TL, config
+    int16_t temperature;
+    bool present;
+    bool corrupt_next;
+    bool alarm;                 // Set by the last conversion
+    bool selected;              // Addressed / still active in a search
+} sim_device_t;
+
+typedef enum {
+    SIM_IDLE,                   // Ignore everything until the next reset
+    SIM_ROM_CMD,
+    SIM_MATCH_ROM,
+    SIM_SEARCH,
+    SIM_FUNC_CMD,
+    SIM_WRITE_SCRATCH,
+    SIM_READ,
+} sim_state_t;
+
+typedef struct {
+    onewire_bus_t base;
+    sim_device_t devices[ONEWIRE_SIM_MAX_DEVICES];
+    int count;
+
+    sim_state_t state;
+    uint8_t shift;              // Incoming byte, LSB first
+    int shift_bits;
+    int byte_index;             // Match ROM / write scratchpad progress
+    uint8_t match_rom[8];
+    int search_bit;             // 0..63
+    int search_phase;           // 0: id bit, 1: complement, 2: direction
+    int read_bit;               // Scratchpad bit being read
+    uint8_t read_buf[DS18B20_SCRATCHPAD_LEN];
+
+    onewire_sim_stats_t stats;
+} onewire_sim_bus_t;
+
+static void sim_update_crc(sim_device_t *d) {
+    d->scratchpad[DS18B20_SP_CRC] = onewire_crc8(d->scratchpad, DS18B20_SP_CRC);
+}
+
+static void sim_power_on(sim_device_t *d) {
+    d->scratchpad[DS18B20_SP_TEMP_LSB] = DS18B20_POWER_ON_RAW & 0xFF;
+    d->scratchpad[DS18B20_SP_TEMP_MSB] = DS18B20_POWER_ON_RAW >> 8;
+    d->scratchpad[DS18B20_SP_TH] = d->eeprom[0];
+    d->scratchpad[DS18B20_SP_TL] = d->eeprom[1];
+    d->scratchpad[DS18B20_SP_CONFIG] = d->eeprom[2];
+    d->scratchpad[5] = 0xFF;
+    d->scratchpad[6] = 0x0C;
+    d->scratchpad[7] = 0x10;
+    sim_update_crc(d);
+    d->alarm = false;
+}
+
+// R1:R0 in config bits 6:5 select 9..12 bits
+static int sim_resolution_bits(const sim_device_t *d) {
+    return 9 + ((d->scratchpad[DS18B20_SP_CONFIG] >> 5) & 0x03);
+}
+
+static void sim_convert(onewire_sim_bus_t *sim, sim_device_t *d) {
+    int bits = sim_resolution_bits(d);
+    // Undefined low bits read as 0 at reduced resolution
+    int16_t raw = d->temperature & ~((1 << (12 - bits)) - 1);
+    d->scratchpad[DS18B20_SP_TEMP_LSB] = (uint8_t)(raw & 0xFF);
+    d->scratchpad[DS18B20_SP_TEMP_MSB] = (uint8_t)((uint16_t)raw >> 8);
+    sim_update_crc(d);
+
+    // Integer part against TH/TL (signed bytes)
+    int whole = raw >> 4;
+    d->alarm = whole >= (int8_t)d->scratchpad[DS18B20_SP_TH] ||
+               whole <= (int8_t)d->scratchpad[DS18B20_SP_TL];
+
+    sim->stats.conversions++;
+    sim->stats.conversion_time_us += 750000 >> (12 - bits);
+}
+
+static void sim_select_all(onewire_sim_bus_t *sim) {
+    for (int i = 0; i < sim->count; i++) {
+        sim->devices[i].selected = sim->devices[i].present;
+    }
+}
+
+static void sim_func_cmd(onewire_sim_bus_t *sim, uint8_t cmd) {
+    sim->state = SIM_IDLE;
+    for (int i = 0; i < sim->count; i++) {
+        sim_device_t *d = &sim->devices[i];
+        if (!d->selected) {
+            continue;
+        }
+        switch (cmd) {
+            case DS18B20_CMD_CONVERT_T:
+                sim_convert(sim, d);
+                break;
+            case DS18B20_CMD_COPY_SCRATCH:
+                memcpy(d->eeprom, &d->scratchpad[DS18B20_SP_TH], 3);
+                break;
+            case DS18B20_CMD_RECALL_E2:
+                memcpy(&d->scratchpad[DS18B20_SP_TH], d->eeprom, 3);
+                sim_update_crc(d);
+                break;
+            default:
+                break;
+        }
+    }
+
+    if (cmd == DS18B20_CMD_READ_SCRATCH) {
+        // Wired-AND of everyone addressed (a Skip ROM read with several
+        // devices yields garbage, like the real bus)
+        memset(sim->read_buf, 0xFF, sizeof(sim->read_buf));
+        for (int i = 0; i < sim->count; i++) {
+            sim_device_t *d = &sim->devices[i];
+            if (!d->selected) {
+                continue;
+            }
+            for (int b = 0; b < DS18B20_SCRATCHPAD_LEN; b++) {
+                sim->read_buf[b] &= d->scratchpad[b];
+            }
+            if (d->corrupt_next) {
+                sim->read_buf[DS18B20_SP_TEMP_LSB] ^= 0x01;
+                d->corrupt_next = false;
+            }
+        }
+        sim->read_bit = 0;
+        sim->state = SIM_READ;
+    } else if (cmd == DS18B20_CMD_WRITE_SCRATCH) {
+        sim->byte_index = 0;
+        sim->state = SIM_WRITE_SCRATCH;
+    }
+}
+
+static void sim_on_byte(onewire_sim_bus_t *sim, uint8_t b) {
+    switch (sim->state) {
+        case SIM_ROM_CMD:
+            if (b == OW_CMD_SKIP_ROM) {
+                sim_select_all(sim);
+                sim->state = SIM_FUNC_CMD;
+            } else if (b == OW_CMD_MATCH_ROM) {
+                sim->byte_index = 0;
+                sim->state = SIM_MATCH_ROM;
+            } else if (b == OW_CMD_SEARCH_ROM || b == OW_CMD_ALARM_SEARCH) {
+                sim_select_all(sim);
+                if (b == OW_CMD_ALARM_SEARCH) {
+                    for (int i = 0; i < sim->count; i++) {
+                        sim->devices[i].selected &= sim->devices[i].alarm;
+                    }
+                }
+                sim->search_bit = 0;
+                sim->search_phase = 0;
+                sim->state = SIM_SEARCH;
+            } else {
+                sim->state = SIM_IDLE;
+            }
+            break;
+
+        case SIM_MATCH_ROM:
+            sim->match_rom[sim->byte_index++] = b;
+            if (sim->byte_index == 8) {
+                for (int i = 0; i < sim->count; i++) {
+                    sim_device_t *d = &sim->devices[i];
+                    d->selected = d->present && memcmp(d->rom, sim->match_rom, 8) == 0;
+                }
+                sim->state = SIM_FUNC_CMD;
+            }
+            break;
+
+        case SIM_FUNC_CMD:
+            sim_func_cmd(sim, b);
+            break;
+
+        case SIM_WRITE_SCRATCH:
+            for (int i = 0; i < sim->count; i++) {
+                sim_device_t *d = &sim->devices[i];
+                if (!d->selected) {
+                    continue;
+                }
+                if (sim->byte_index == 2) {
+                    // Only R1:R0 are writable in the config register
+                    d->scratchpad[DS18B20_SP_CONFIG] = (b & 0x60) | 0x1F;
+                } else {
+                    d->scratchpad[DS18B20_SP_TH + sim->byte_index] = b;
+                }
+                sim_update_crc(d);
+            }
+            if (++sim->byte_index == 3) {
+                sim->state = SIM_IDLE;
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+static int sim_rom_bit(const sim_device_t *d, int bit) {
+    return (d->rom[bit / 8] >> (bit % 8)) & 1;
+}
+
+static void sim_write_bit(onewire_sim_bus_t *sim, int v) {
+    if (sim->state == SIM_SEARCH) {
+        if (sim->search_phase != 2) {
+            return;
+        }
+        for (int i = 0; i < sim->count; i++) {
+            sim_device_t *d = &sim->devices[i];
+            if (d->selected && sim_rom_bit(d, sim->search_bit) != v) {
+                d->selected = false;
+            }
+        }
+        sim->search_phase = 0;
+        if (++sim->search_bit == 64) {
+            sim->state = SIM_FUNC_CMD;  // Search ends with the last device selected
+        }
+        return;
+    }
+
+    sim->shift |= (uint8_t)(v << sim->shift_bits);
+    if (++sim->shift_bits == 8) {
+        uint8_t b = sim->shift;
+        sim->shift = 0;
+        sim->shift_bits = 0;
+        sim_on_byte(sim, b);
+    }
+}
+
+static int sim_read_bit(onewire_sim_bus_t *sim) {
+    if (sim->state == SIM_SEARCH && sim->search_phase < 2) {
+        // Each active device drives its bit (phase 0) or the complement (phase 1)
+        int level = 1;
+        for (int i = 0; i < sim->count; i++) {
+            sim_device_t *d = &sim->devices[i];
+            if (d->selected) {
+                int bit = sim_rom_bit(d, sim->search_bit);
+                level &= sim->search_phase == 0 ? bit : !bit;
+            }
+        }
+        sim->search_phase++;
+        return level;
+    }
+
+    if (sim->state == SIM_READ && sim->read_bit < DS18B20_SCRATCHPAD_LEN * 8) {
+        int bit = sim->read_bit++;
+        return (sim->read_buf[bit / 8] >> (bit % 8)) & 1;
+    }
+
+    return 1;   // Nobody drives: pull-up
+}
+
+static esp_err_t sim_reset(onewire_bus_t *bus) {
+    onewire_sim_bus_t *sim = (onewire_sim_bus_t *)bus;
+    sim->stats.resets++;
+    sim->stats.bus_time_us += SIM_RESET_US;
+
+    sim->shift = 0;
+    sim->shift_bits = 0;
+    bool presence = false;
+    for (int i = 0; i < sim->count; i++) {
+        sim->devices[i].selected = false;
+        presence |= sim->devices[i].present;
+    }
+    sim->state = presence ? SIM_ROM_CMD : SIM_IDLE;
+    return presence ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+static esp_err_t sim_write_bits(onewire_bus_t *bus, const uint8_t *data, size_t bits) {
+    onewire_sim_bus_t *sim = (onewire_sim_bus_t *)bus;
+    sim->stats.bits_written += bits;
+    sim->stats.bus_time_us += (uint64_t)bits * SIM_SLOT_US;
+    for (size_t i = 0; i < bits; i++) {
+        sim_write_bit(sim, (data[i / 8] >> (i % 8)) & 1);
+    }
+    return ESP_OK;
+}
+
+static esp_err_t sim_read_bits(onewire_bus_t *bus, uint8_t *data, size_t bits) {
+    onewire_sim_bus_t *sim = (onewire_sim_bus_t *)bus;
+    sim->stats.bits_read += bits;
+    sim->stats.bus_time_us += (uint64_t)bits * SIM_SLOT_US;
+    for (size_t i = 0; i < bits; i++) {
+        uint8_t mask = 1 << (i % 8);
+        if (sim_read_bit(sim)) {
+            data[i / 8] |= mask;
+        } else {
+            data[i / 8] &= ~mask;
+        }
+    }
+    return ESP_OK;
+}
+
+static void sim_del(onewire_bus_t *bus) {
+    free(bus);
+}
+
+static const onewire_ops_t sim_ops = {
+    .reset = sim_reset,
+    .write_bits = sim_write_bits,
+    .read_bits = sim_read_bits,
+    .del = sim_del,
+};
+
+esp_err_t onewire_new_sim_bus(onewire_bus_t **ret_bus) {
+    onewire_sim_bus_t *sim = calloc(1, sizeof(*sim));
+    if (sim == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    sim->base.ops = &sim_ops;
+    sim->base.pin = -1;
+    sim->base.name = "sim";
+    sim->state = SIM_IDLE;
+    *ret_bus = &sim->base;
+    return ESP_OK;
+}
+
+int onewire_sim_add_ds18b20(onewire_bus_t *bus, uint64_t serial) {
+    onewire_sim_bus_t *sim = (onewire_sim_bus_t *)bus;
+    if (sim->count >= ONEWIRE_SIM_MAX_DEVICES) {
+        return -1;
+    }
+    sim_device_t *d = &sim->devices[sim->count];
+    memset(d, 0, sizeof(*d));
+    d->rom[0] = DS18B20_FAMILY_CODE;
+    for (int i = 0; i < 6; i++) {
+        d->rom[1 + i] = (uint8_t)(serial >> (8 * i));
+    }
+    d->rom[7] = onewire_crc8(d->rom, 7);
+    d->eeprom[0] = SIM_DEFAULT_TH;
+    d->eeprom[1] = SIM_DEFAULT_TL;
+    d->eeprom[2] = SIM_DEFAULT_CONFIG;
+    d->temperature = 25 * 16;
+    d->present = true;
+    sim_power_on(d);
+    return sim->count++;
+}
+
+void onewire_sim_get_rom(onewire_bus_t *bus, int index, uint8_t rom[8]) {
+    onewire_sim_bus_t *sim = (onewire_sim_bus_t *)bus;
+    memcpy(rom, sim->devices[index].rom, 8);
+}
+
+void onewire_sim_set_temperature(onewire_bus_t *bus, int index, int16_t raw) {
+    onewire_sim_bus_t *sim = (onewire_sim_bus_t *)bus;
+    sim->devices[index].temperature = raw;
+}
+
+void onewire_sim_set_present(onewire_bus_t *bus, int index, bool present) {
+    onewire_sim_bus_t *sim = (onewire_sim_bus_t *)bus;
+    sim->devices[index].present = present;
+}
+
+void onewire_sim_power_cycle(onewire_bus_t *bus, int index) {
+    onewire_sim_bus_t *sim = (onewire_sim_bus_t *)bus;
+    sim_power_on(&sim->devices[index]);
+}
+
+bool onewire_sim_get_alarm(onewire_bus_t *bus, int index) {
+    onewire_sim_bus_t *sim = (onewire_sim_bus_t *)bus;
+    return sim->devices[index].alarm;
+}
+
+void onewire_sim_corrupt_next_read(onewire_bus_t *bus, int index) {
+    onewire_sim_bus_t *sim = (onewire_sim_bus_t *)bus;
+    sim->devices[index].corrupt_next = true;
+}
+
+const onewire_sim_stats_t *onewire_sim_get_stats(onewire_bus_t *bus) {
+    return &((onewire_sim_bus_t *)bus)->stats;
+}
+
+void onewire_sim_reset_stats(onewire_bus_t *bus) {
+    onewire_sim_bus_t *sim = (onewire_sim_bus_t *)bus;
+    memset(&sim->stats, 0, sizeof(sim->stats));
+}
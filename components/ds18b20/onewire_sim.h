@@ -0,0 +1,61 @@
+/**
+ * @file onewire_sim.h
+ * @brief Simulated 1-Wire bus with DS18B20 devices
+ *
+ * A software model of the bus at transport level: ROM commands (Skip, Match,
+ * Search, Alarm Search), Convert T, scratchpad read/write, EEPROM copy/recall. Runs on the
+ * linux target for off-target tests and benchmarks, and on the device as a
+ * stand-in when no probe is wired.
+ *
+ * Conversions complete instantly; the time they would take on the wire is
+ * accounted in the stats instead.
+ */
+
+#ifndef ONEWIRE_SIM_H
+#define ONEWIRE_SIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "onewire_bus.h"
+
+#define ONEWIRE_SIM_MAX_DEVICES 8
+
+typedef struct {
+    uint32_t resets;
+    uint32_t bits_written;
+    uint32_t bits_read;
+    uint32_t conversions;
+    uint64_t bus_time_us;           // Wire time of resets and slots
+    uint64_t conversion_time_us;    // Conversion time at each device's resolution
+} onewire_sim_stats_t;
+
+esp_err_t onewire_new_sim_bus(onewire_bus_t **ret_bus);
+
+/**
+ * Add a DS18B20 with a 48-bit serial number. Starts in the power-on state
+ * (temperature register 0x0550, 12-bit resolution).
+ * @return device index, or -1 if the bus is full
+ */
+int onewire_sim_add_ds18b20(onewire_bus_t *bus, uint64_t serial);
+
+void onewire_sim_get_rom(onewire_bus_t *bus, int index, uint8_t rom[8]);
+
+// Temperature the next Convert T will latch (1/16 degC)
+void onewire_sim_set_temperature(onewire_bus_t *bus, int index, int16_t raw);
+
+// Unplug/replug a probe (absent devices don't answer resets or searches)
+void onewire_sim_set_present(onewire_bus_t *bus, int index, bool present);
+
+// Brown-out: scratchpad returns to the power-on value, EEPROM is kept
+void onewire_sim_power_cycle(onewire_bus_t *bus, int index);
+
+// Alarm flag from the last conversion (what Alarm Search answers to)
+bool onewire_sim_get_alarm(onewire_bus_t *bus, int index);
+
+// Flip one bit in the next scratchpad read of this device (CRC error)
+void onewire_sim_corrupt_next_read(onewire_bus_t *bus, int index);
+
+const onewire_sim_stats_t *onewire_sim_get_stats(onewire_bus_t *bus);
+void onewire_sim_reset_stats(onewire_bus_t *bus);
+
+#endif // ONEWIRE_SIM_H
@@ -0,0 +1,155 @@
+/**
+ * @file onewire_sim_bench.c
+ * Micro-benchmark of the DS18B20 protocol layer on the simulated bus: host
+ * CPU time per CRC8 (table against the bitwise loop it replaced), per
+ * scratchpad check, per ROM search and per sample (broadcast Convert T +
+ * Match ROM read of every probe), next to the wire time the same sample
+ * takes on a real bus (from the sim's slot accounting).
+ *
+ * The sim's own work is in the per-sample figure, so it is an upper bound
+ * of the protocol cost. Host timings only show the trend. Built and run as
+ * a smoke test by the LVGL test harness (OPTIONS_AQUARIUM).
+ *
+ * onewire_sim_bench [ITERATIONS]
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "onewire_sim.h"
+#include "ds18b20.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*********************
+ *      DEFINES
+ *********************/
+#define ITERATIONS      20000
+#define PROBES          3       /*Water, sump, ambient*/
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static uint8_t crc8_bitwise(const uint8_t * data, size_t len);
+static uint64_t time_ns(void);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static volatile uint32_t sink;  /*Keeps the results alive*/
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+int main(int argc, char ** argv)
+{
+    uint32_t iterations = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 10) : ITERATIONS;
+    if(iterations == 0) {
+        fprintf(stderr, "usage: %s [ITERATIONS]\n", argv[0]);
+        return 2;
+    }
+
+    onewire_bus_t * bus;
+    if(onewire_new_sim_bus(&bus) != ESP_OK) return 1;
+    uint8_t roms[PROBES][8];
+    for(int i = 0; i < PROBES; i++) {
+        int idx = onewire_sim_add_ds18b20(bus, 0xA0001 + i);
+        onewire_sim_set_temperature(bus, idx, (int16_t)(25 * 16 + i));
+    }
+    if(ds18b20_enumerate(bus, roms, PROBES) != PROBES) {
+        fprintf(stderr, "search failed\n");
+        return 1;
+    }
+
+    printf("# onewire_sim_bench: %u iterations, %d probes\n", (unsigned)iterations, PROBES);
+    printf("# %-30s %10s\n", "case", "ns/op");
+
+    /*CRC8 of a scratchpad (8 bytes)*/
+    uint8_t sp[DS18B20_SCRATCHPAD_LEN];
+    if(ds18b20_read_scratchpad(bus, roms[0], sp) != ESP_OK) return 1;
+    uint64_t start = time_ns();
+    for(uint32_t i = 0; i < iterations; i++) {
+        sp[0] = (uint8_t)i;
+        sink += crc8_bitwise(sp, DS18B20_SP_CRC);
+    }
+    uint64_t bitwise_ns = time_ns() - start;
+    start = time_ns();
+    for(uint32_t i = 0; i < iterations; i++) {
+        sp[0] = (uint8_t)i;
+        sink += onewire_crc8(sp, DS18B20_SP_CRC);
+    }
+    uint64_t table_ns = time_ns() - start;
+    printf("%-32s %10.1f\n", "crc8, bitwise", (double)bitwise_ns / iterations);
+    printf("%-32s %10.1f (%.1fx)\n", "crc8, table", (double)table_ns / iterations,
+           (double)bitwise_ns / (double)(table_ns ? table_ns : 1));
+
+    /*Scratchpad validation: frame check, CRC, power-on value*/
+    if(ds18b20_convert_all(bus) != ESP_OK || ds18b20_read_scratchpad(bus, roms[0], sp) != ESP_OK) return 1;
+    int16_t raw = 0;
+    start = time_ns();
+    for(uint32_t i = 0; i < iterations; i++) {
+        if(ds18b20_parse_scratchpad(sp, &raw) != ESP_OK) return 1;
+        sink += (uint32_t)raw;
+    }
+    printf("%-32s %10.1f\n", "parse scratchpad", (double)(time_ns() - start) / iterations);
+
+    /*ROM search of every probe*/
+    uint32_t searches = iterations / 100 + 1;
+    start = time_ns();
+    for(uint32_t i = 0; i < searches; i++) {
+        sink += (uint32_t)ds18b20_enumerate(bus, roms, PROBES);
+    }
+    printf("%-32s %10.1f\n", "search, all probes", (double)(time_ns() - start) / searches);
+
+    /*One sample as the controller takes it*/
+    onewire_sim_reset_stats(bus);
+    uint32_t samples = iterations / 10 + 1;
+    start = time_ns();
+    for(uint32_t i = 0; i < samples; i++) {
+        if(ds18b20_convert_all(bus) != ESP_OK) return 1;
+        for(int p = 0; p < PROBES; p++) {
+            if(ds18b20_read_raw(bus, roms[p], &raw) != ESP_OK) return 1;
+            sink += (uint32_t)raw;
+        }
+    }
+    uint64_t sample_ns = time_ns() - start;
+    const onewire_sim_stats_t * st = onewire_sim_get_stats(bus);
+    printf("%-32s %10.1f\n", "sample (convert + reads)", (double)sample_ns / samples);
+    printf("# wire time per sample: %llu us (%lu resets, %lu slots), conversion %llu ms at 12 bits\n",
+           (unsigned long long)(st->bus_time_us / samples),
+           (unsigned long)(st->resets / samples),
+           (unsigned long)((st->bits_written + st->bits_read) / samples),
+           (unsigned long long)(st->conversion_time_us / st->conversions / 1000));
+
+    onewire_del_bus(bus);
+    return 0;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+/*The CRC the table replaced: x^8 + x^5 + x^4 + 1, LSB first*/
+static uint8_t crc8_bitwise(const uint8_t * data, size_t len)
+{
+    uint8_t crc = 0;
+    for(size_t i = 0; i < len; i++) {
+        uint8_t b = data[i];
+        for(int j = 0; j < 8; j++) {
+            uint8_t mix = (crc ^ b) & 0x01;
+            crc >>= 1;
+            if(mix) crc ^= 0x8C;
+            b >>= 1;
+        }
+    }
+    return crc;
+}
+
+static uint64_t time_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
@@ -0,0 +1,219 @@
+/**
+ * @file test_onewire_rmt_symbols.c
+ * RMT symbols of the 1-Wire slots (onewire_rmt_symbols.c) against the
+ * standard-speed timing of the DS18B20 datasheet, and the decoding of what
+ * the loopback receives. Host test: built and run by the LVGL test harness
+ * (components/lvgl__lvgl/tests, OPTIONS_AQUARIUM).
+ */
+#if LV_BUILD_TEST
+#include "onewire_rmt_symbols.h"
+#include "onewire_bus.h"
+#include "ds18b20.h"
+#include <string.h>
+
+#include "unity/unity.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+/*Standard speed, microseconds (DS18B20 datasheet, AC electrical characteristics)*/
+#define T_RSTL_MIN      480     /*Reset low*/
+#define T_RSTH_MIN      480     /*Presence detect window after release*/
+#define T_PDHIGH_MIN    15      /*Release -> presence pulse*/
+#define T_PDHIGH_MAX    60
+#define T_PDLOW_MIN     60      /*Presence pulse*/
+#define T_PDLOW_MAX     240
+#define T_SLOT_MIN      60      /*Time slot*/
+#define T_SLOT_MAX      120
+#define T_REC_MIN       1       /*Recovery between slots*/
+#define T_LOW1_MIN      1       /*Write 1 low time*/
+#define T_LOW1_MAX      15
+#define T_LOW0_MIN      60      /*Write 0 low time*/
+#define T_LOW0_MAX      120
+#define T_LOWR_MIN      1       /*Read low time*/
+#define T_RDV           15      /*Read data valid: the master samples before this*/
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void check_slot(const rmt_symbol_word_t * s, uint32_t low_min, uint32_t low_max);
+static rmt_symbol_word_t rx_symbol(uint32_t low_us, uint32_t high_us);
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_reset_symbol_timing(void)
+{
+    rmt_symbol_word_t s[2];
+    TEST_ASSERT_EQUAL(1, onewire_rmt_encode_reset(s));
+
+    TEST_ASSERT_EQUAL(0, s[0].level0);
+    TEST_ASSERT_EQUAL(1, s[0].level1);
+    TEST_ASSERT_EQUAL(OW_RESET_LOW_US, s[0].duration0);
+    TEST_ASSERT_EQUAL(OW_PRESENCE_SAMPLE_US + OW_RESET_RECOVERY_US, s[0].duration1);
+    TEST_ASSERT_GREATER_OR_EQUAL(T_RSTL_MIN, s[0].duration0);
+    TEST_ASSERT_GREATER_OR_EQUAL(T_RSTH_MIN, s[0].duration1);
+
+    /*The bit-bang transport samples presence inside the presence pulse of
+     *any device: after the latest start, before the earliest end*/
+    TEST_ASSERT_GREATER_THAN(T_PDHIGH_MAX, OW_PRESENCE_SAMPLE_US);
+    TEST_ASSERT_LESS_THAN(T_PDHIGH_MIN + T_PDLOW_MIN, OW_PRESENCE_SAMPLE_US);
+}
+
+void test_write_symbol_timing(void)
+{
+    const uint8_t data = 0x01;  /*Bit 0 = 1, bit 1 = 0*/
+    rmt_symbol_word_t s[2];
+    TEST_ASSERT_EQUAL(2, onewire_rmt_encode_write(&data, 0, 2, s));
+
+    TEST_ASSERT_EQUAL(OW_WRITE1_LOW_US, s[0].duration0);
+    TEST_ASSERT_EQUAL(OW_WRITE1_HIGH_US, s[0].duration1);
+    check_slot(&s[0], T_LOW1_MIN, T_LOW1_MAX);
+
+    TEST_ASSERT_EQUAL(OW_WRITE0_LOW_US, s[1].duration0);
+    TEST_ASSERT_EQUAL(OW_WRITE0_HIGH_US, s[1].duration1);
+    check_slot(&s[1], T_LOW0_MIN, T_LOW0_MAX);
+}
+
+void test_read_symbol_timing(void)
+{
+    rmt_symbol_word_t s[3];
+    TEST_ASSERT_EQUAL(3, onewire_rmt_encode_read(3, s));
+    for(int i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL(OW_READ_LOW_US, s[i].duration0);
+        TEST_ASSERT_EQUAL(OW_READ_HIGH_US, s[i].duration1);
+        /*Released well before the sample point, so a device's 1 is seen*/
+        check_slot(&s[i], T_LOWR_MIN, OW_READ_SAMPLE_US - 1);
+    }
+    TEST_ASSERT_LESS_OR_EQUAL(T_RDV, OW_READ_SAMPLE_US);
+}
+
+void test_write_is_lsb_first_from_any_bit(void)
+{
+    const uint8_t data[2] = {0xA5, 0x3C};
+    rmt_symbol_word_t s[16];
+    TEST_ASSERT_EQUAL(16, onewire_rmt_encode_write(data, 0, 16, s));
+    for(int i = 0; i < 16; i++) {
+        int bit = (data[i / 8] >> (i % 8)) & 1;
+        TEST_ASSERT_EQUAL_MESSAGE(bit ? OW_WRITE1_LOW_US : OW_WRITE0_LOW_US, s[i].duration0, "bit order");
+    }
+
+    /*From bit 5: the two search direction bits of a Search ROM step start mid-byte*/
+    TEST_ASSERT_EQUAL(5, onewire_rmt_encode_write(data, 5, 5, s));
+    for(int i = 0; i < 5; i++) {
+        int b = 5 + i;
+        int bit = (data[b / 8] >> (b % 8)) & 1;
+        TEST_ASSERT_EQUAL(bit ? OW_WRITE1_LOW_US : OW_WRITE0_LOW_US, s[i].duration0);
+    }
+}
+
+void test_presence_window(void)
+{
+    rmt_symbol_word_t rx[2];
+
+    /*Earliest and latest presence pulse a device may give*/
+    rx[0] = rx_symbol(OW_RESET_LOW_US, T_PDHIGH_MIN);
+    rx[1] = rx_symbol(T_PDLOW_MIN, 300);
+    TEST_ASSERT_TRUE(onewire_rmt_decode_presence(rx, 2));
+    rx[0] = rx_symbol(OW_RESET_LOW_US, T_PDHIGH_MAX);
+    rx[1] = rx_symbol(T_PDLOW_MAX, 200);
+    TEST_ASSERT_TRUE(onewire_rmt_decode_presence(rx, 2));
+
+    /*Outside the datasheet window: a glitch, not a device*/
+    rx[0] = rx_symbol(OW_RESET_LOW_US, T_PDHIGH_MIN - 1);
+    rx[1] = rx_symbol(T_PDLOW_MIN, 300);
+    TEST_ASSERT_FALSE(onewire_rmt_decode_presence(rx, 2));
+    rx[0] = rx_symbol(OW_RESET_LOW_US, T_PDHIGH_MAX + 1);
+    TEST_ASSERT_FALSE(onewire_rmt_decode_presence(rx, 2));
+    rx[0] = rx_symbol(OW_RESET_LOW_US, 30);
+    rx[1] = rx_symbol(T_PDLOW_MIN - 1, 300);
+    TEST_ASSERT_FALSE(onewire_rmt_decode_presence(rx, 2));
+
+    /*Nobody answered: only our own reset pulse comes back*/
+    TEST_ASSERT_FALSE(onewire_rmt_decode_presence(rx, 1));
+
+    /*Our reset pulse cut short (bus fault)*/
+    rx[0] = rx_symbol(OW_RESET_LOW_US - OW_PRESENCE_WAIT_MIN_US - 1, 30);
+    rx[1] = rx_symbol(T_PDLOW_MIN, 300);
+    TEST_ASSERT_FALSE(onewire_rmt_decode_presence(rx, 2));
+}
+
+void test_read_slot_decoding(void)
+{
+    /*A device writing 1 leaves our start pulse alone; writing 0 it holds the
+     *line past the sample point (15..60 us)*/
+    rmt_symbol_word_t rx[6];
+    rx[0] = rx_symbol(OW_READ_LOW_US, 64);
+    rx[1] = rx_symbol(OW_READ_SAMPLE_US - 1, 56);
+    rx[2] = rx_symbol(OW_READ_SAMPLE_US, 55);
+    rx[3] = rx_symbol(T_PDHIGH_MAX, 10);
+    rx[4] = rx_symbol(OW_READ_LOW_US + 1, 63);
+    rx[5] = rx_symbol(30, 40);
+
+    uint8_t data[2] = {0x00, 0xFF};
+    TEST_ASSERT_TRUE(onewire_rmt_decode_read(rx, 6, data, 4, 6));
+    /*Bits 4..9 = 1, 1, 0, 0, 1, 0; the others untouched*/
+    TEST_ASSERT_EQUAL_HEX8(0x30, data[0]);
+    TEST_ASSERT_EQUAL_HEX8(0xFD, data[1]);
+
+    /*Too few symbols, or a slot that did not start low*/
+    TEST_ASSERT_FALSE(onewire_rmt_decode_read(rx, 5, data, 0, 6));
+    rx[2].level0 = 1;
+    TEST_ASSERT_FALSE(onewire_rmt_decode_read(rx, 6, data, 0, 6));
+}
+
+void test_read_slots_round_trip(void)
+{
+    /*Encode read slots, let a device answer a scratchpad, decode*/
+    const uint8_t sp[DS18B20_SCRATCHPAD_LEN] = {0x91, 0x01, 0x4B, 0x46, 0x7F, 0xFF, 0x0C, 0x10, 0xA3};
+    rmt_symbol_word_t s[DS18B20_SCRATCHPAD_LEN * 8];
+    TEST_ASSERT_EQUAL(sizeof(s) / sizeof(s[0]), onewire_rmt_encode_read(sizeof(s) / sizeof(s[0]), s));
+    for(size_t i = 0; i < sizeof(s) / sizeof(s[0]); i++) {
+        if(((sp[i / 8] >> (i % 8)) & 1) == 0) {
+            s[i].duration0 = 30;
+            s[i].duration1 = OW_READ_LOW_US + OW_READ_HIGH_US - 30;
+        }
+    }
+    uint8_t out[DS18B20_SCRATCHPAD_LEN];
+    memset(out, 0x55, sizeof(out));
+    TEST_ASSERT_TRUE(onewire_rmt_decode_read(s, sizeof(s) / sizeof(s[0]), out, 0, sizeof(s) / sizeof(s[0])));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(sp, out, sizeof(sp));
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+/*One slot: low for the given range, a slot length within the standard, recovery at the end*/
+static void check_slot(const rmt_symbol_word_t * s, uint32_t low_min, uint32_t low_max)
+{
+    TEST_ASSERT_EQUAL(0, s->level0);
+    TEST_ASSERT_EQUAL(1, s->level1);
+    TEST_ASSERT_GREATER_OR_EQUAL(low_min, s->duration0);
+    TEST_ASSERT_LESS_OR_EQUAL(low_max, s->duration0);
+    TEST_ASSERT_GREATER_OR_EQUAL(T_REC_MIN, s->duration1);
+    TEST_ASSERT_GREATER_OR_EQUAL(T_SLOT_MIN, s->duration0 + s->duration1);
+    TEST_ASSERT_LESS_OR_EQUAL(T_SLOT_MAX + T_REC_MIN, s->duration0 + s->duration1);
+}
+
+static rmt_symbol_word_t rx_symbol(uint32_t low_us, uint32_t high_us)
+{
+    rmt_symbol_word_t s;
+    s.val = 0;
+    s.level0 = 0;
+    s.duration0 = low_us;
+    s.level1 = 1;
+    s.duration1 = high_us;
+    return s;
+}
+
+#endif
@@ -0,0 +1,284 @@
+/**
+ * @file test_onewire_sim.c
+ * The protocol layer (onewire_bus.c, ds18b20.c) on the simulated bus
+ * (onewire_sim.c): CRC8, ROM search, Match/Skip ROM, scratchpad validation,
+ * resolution and EEPROM commands. Host test: built and run by the LVGL test
+ * harness (components/lvgl__lvgl/tests, OPTIONS_AQUARIUM).
+ */
+#if LV_BUILD_TEST
+#include "onewire_sim.h"
+#include "ds18b20.h"
+#include <string.h>
+
+#include "unity/unity.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define DEVICES     5
+
+/*Wire time of the standard-speed slots the sim accounts*/
+#define RESET_US    (OW_RESET_LOW_US + OW_PRESENCE_SAMPLE_US + OW_RESET_RECOVERY_US)
+#define SLOT_US     (OW_READ_LOW_US + OW_READ_HIGH_US)
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static uint8_t crc8_bitwise(const uint8_t * data, size_t len);
+static int find_rom(const uint8_t rom[8]);
+static void convert_and_read(int dev, int16_t * raw, esp_err_t expected);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static onewire_bus_t * bus;
+static uint8_t roms[DEVICES][8];
+
+/*Serial numbers that branch at several bit positions during a search*/
+static const uint64_t serials[DEVICES] = {0x000000000001, 0x000000000003, 0x0000000000F0, 0x800000000001, 0x123456789ABC};
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+void setUp(void)
+{
+    TEST_ASSERT_EQUAL(ESP_OK, onewire_new_sim_bus(&bus));
+    for(int i = 0; i < DEVICES; i++) {
+        TEST_ASSERT_EQUAL(i, onewire_sim_add_ds18b20(bus, serials[i]));
+        onewire_sim_get_rom(bus, i, roms[i]);
+    }
+}
+
+void tearDown(void)
+{
+    onewire_del_bus(bus);
+}
+
+void test_crc8_table_matches_bitwise(void)
+{
+    /*Maxim AN27 example ROM: family 0x02, serial 00000001B81C -> CRC 0xA2*/
+    const uint8_t an27[7] = {0x02, 0x1C, 0xB8, 0x01, 0x00, 0x00, 0x00};
+    TEST_ASSERT_EQUAL_HEX8(0xA2, onewire_crc8(an27, sizeof(an27)));
+
+    uint8_t buf[64];
+    for(int b = 0; b < 256; b++) {
+        buf[0] = (uint8_t)b;
+        TEST_ASSERT_EQUAL_HEX8(crc8_bitwise(buf, 1), onewire_crc8(buf, 1));
+    }
+    uint32_t seed = 12345;
+    for(int n = 0; n < 200; n++) {
+        size_t len = (size_t)(n % sizeof(buf));
+        for(size_t i = 0; i < len; i++) {
+            seed = seed * 1103515245u + 12345u;
+            buf[i] = (uint8_t)(seed >> 16);
+        }
+        TEST_ASSERT_EQUAL_HEX8(crc8_bitwise(buf, len), onewire_crc8(buf, len));
+    }
+
+    /*A frame followed by its CRC checks to 0*/
+    uint8_t rom[8];
+    memcpy(rom, roms[4], sizeof(rom));
+    TEST_ASSERT_EQUAL_HEX8(0, onewire_crc8(rom, 8));
+}
+
+void test_search_finds_every_device(void)
+{
+    uint8_t found[8][8];
+    TEST_ASSERT_EQUAL(DEVICES, ds18b20_enumerate(bus, found, 8));
+    bool seen[DEVICES] = {false};
+    for(int i = 0; i < DEVICES; i++) {
+        TEST_ASSERT_EQUAL_HEX8(DS18B20_FAMILY_CODE, found[i][0]);
+        TEST_ASSERT_EQUAL_HEX8(onewire_crc8(found[i], 7), found[i][7]);
+        int dev = find_rom(found[i]);
+        TEST_ASSERT_TRUE(dev >= 0);
+        TEST_ASSERT_FALSE_MESSAGE(seen[dev], "ROM found twice");
+        seen[dev] = true;
+    }
+
+    /*At most `max`, and an unplugged device is not found*/
+    TEST_ASSERT_EQUAL(2, ds18b20_enumerate(bus, found, 2));
+    onewire_sim_set_present(bus, 2, false);
+    TEST_ASSERT_EQUAL(DEVICES - 1, ds18b20_enumerate(bus, found, 8));
+    for(int i = 0; i < DEVICES - 1; i++) TEST_ASSERT_NOT_EQUAL(2, find_rom(found[i]));
+
+    for(int i = 0; i < DEVICES; i++) onewire_sim_set_present(bus, i, false);
+    TEST_ASSERT_EQUAL(0, ds18b20_enumerate(bus, found, 8));
+}
+
+void test_alarm_search_finds_the_flagged_devices(void)
+{
+    uint8_t found[8][8];
+    /*Defaults: TH +75, TL +70. Device 1 at 80 (>= TH), device 3 at 70 (<= TL).*/
+    for(int i = 0; i < DEVICES; i++) onewire_sim_set_temperature(bus, i, 72 * 16);
+    onewire_sim_set_temperature(bus, 1, 80 * 16);
+    onewire_sim_set_temperature(bus, 3, 70 * 16 + 15);
+    TEST_ASSERT_EQUAL(0, ds18b20_alarm_search(bus, found, 8));     /*No conversion yet*/
+
+    TEST_ASSERT_EQUAL(ESP_OK, ds18b20_convert_all(bus));
+    TEST_ASSERT_EQUAL(2, ds18b20_alarm_search(bus, found, 8));
+    int a = find_rom(found[0]);
+    int b = find_rom(found[1]);
+    TEST_ASSERT_TRUE((a == 1 && b == 3) || (a == 3 && b == 1));
+
+    /*Limits from the scratchpad: nobody outside -10..+100*/
+    TEST_ASSERT_EQUAL(ESP_OK, ds18b20_write_scratchpad(bus, NULL, 100, -10, ds18b20_resolution_to_config(12)));
+    TEST_ASSERT_EQUAL(ESP_OK, ds18b20_convert_all(bus));
+    TEST_ASSERT_EQUAL(0, ds18b20_alarm_search(bus, found, 8));
+}
+
+void test_match_rom_reads_one_device(void)
+{
+    for(int i = 0; i < DEVICES; i++) onewire_sim_set_temperature(bus, i, (int16_t)(20 * 16 + i));
+    TEST_ASSERT_EQUAL(ESP_OK, ds18b20_convert_all(bus));
+    for(int i = 0; i < DEVICES; i++) {
+        int16_t raw = 0;
+        TEST_ASSERT_EQUAL(ESP_OK, ds18b20_read_raw(bus, roms[i], &raw));
+        TEST_ASSERT_EQUAL_INT16(20 * 16 + i, raw);
+    }
+
+    /*Skip ROM with several devices: they all drive the bus at once*/
+    int16_t raw;
+    TEST_ASSERT_NOT_EQUAL(ESP_OK, ds18b20_read_raw(bus, NULL, &raw));
+}
+
+void test_parse_rejects_bad_frames(void)
+{
+    int16_t raw = 0;
+
+    /*Power-on value: converted nothing yet*/
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, ds18b20_read_raw(bus, roms[0], &raw));
+
+    onewire_sim_set_temperature(bus, 0, 0x0191);
+    convert_and_read(0, &raw, ESP_OK);
+    TEST_ASSERT_EQUAL_INT16(0x0191, raw);
+
+    /*One flipped bit*/
+    onewire_sim_corrupt_next_read(bus, 0);
+    convert_and_read(0, &raw, ESP_ERR_INVALID_CRC);
+    convert_and_read(0, &raw, ESP_OK);
+
+    /*Nobody answers the Match ROM: the line stays high (all 1)*/
+    onewire_sim_set_present(bus, 0, false);
+    convert_and_read(0, &raw, ESP_ERR_INVALID_RESPONSE);
+
+    /*All 0 (line shorted) has a valid CRC of 0: only the frame check catches it*/
+    uint8_t sp[DS18B20_SCRATCHPAD_LEN] = {0};
+    TEST_ASSERT_EQUAL_HEX8(0, onewire_crc8(sp, DS18B20_SP_CRC));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_RESPONSE, ds18b20_parse_scratchpad(sp, &raw));
+    memset(sp, 0xFF, sizeof(sp));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_RESPONSE, ds18b20_parse_scratchpad(sp, &raw));
+
+    /*A real 85.0 reading is the power-on value too: rejected, read again*/
+    onewire_sim_set_present(bus, 0, true);
+    onewire_sim_set_temperature(bus, 0, DS18B20_POWER_ON_RAW);
+    convert_and_read(0, &raw, ESP_ERR_INVALID_STATE);
+
+    /*Negative temperatures keep their sign*/
+    onewire_sim_set_temperature(bus, 0, -10 * 16 - 8);
+    convert_and_read(0, &raw, ESP_OK);
+    TEST_ASSERT_EQUAL_INT16(-168, raw);
+}
+
+void test_resolution_masks_low_bits_and_halves_conversion_time(void)
+{
+    int16_t raw;
+    for(int bits = DS18B20_RESOLUTION_MIN; bits <= DS18B20_RESOLUTION_MAX; bits++) {
+        TEST_ASSERT_EQUAL(ESP_OK, ds18b20_write_scratchpad(bus, NULL, 75, 70, ds18b20_resolution_to_config(bits)));
+        onewire_sim_set_temperature(bus, 0, 0x0197);
+        onewire_sim_reset_stats(bus);
+        convert_and_read(0, &raw, ESP_OK);
+        TEST_ASSERT_EQUAL_HEX16(0x0197 & ~((1 << (12 - bits)) - 1), raw);
+        /*Every device converted, at 93.75 ms << (bits - 9)*/
+        const onewire_sim_stats_t * st = onewire_sim_get_stats(bus);
+        TEST_ASSERT_EQUAL_UINT32(DEVICES, st->conversions);
+        TEST_ASSERT_EQUAL_UINT64((uint64_t)DEVICES * (750000 >> (12 - bits)), st->conversion_time_us);
+        TEST_ASSERT_TRUE(st->conversion_time_us <= (uint64_t)DEVICES * ds18b20_conversion_time_ms(bits) * 1000);
+
+        uint8_t sp[DS18B20_SCRATCHPAD_LEN];
+        TEST_ASSERT_EQUAL(ESP_OK, ds18b20_read_scratchpad(bus, roms[3], sp));
+        TEST_ASSERT_EQUAL(bits, ds18b20_config_to_resolution(sp[DS18B20_SP_CONFIG]));
+    }
+}
+
+void test_eeprom_copy_and_recall(void)
+{
+    uint8_t sp[DS18B20_SCRATCHPAD_LEN];
+
+    /*Scratchpad only: a brown-out brings the EEPROM values back*/
+    TEST_ASSERT_EQUAL(ESP_OK, ds18b20_write_scratchpad(bus, roms[0], 30, 20, ds18b20_resolution_to_config(9)));
+    onewire_sim_power_cycle(bus, 0);
+    TEST_ASSERT_EQUAL(ESP_OK, ds18b20_read_scratchpad(bus, roms[0], sp));
+    TEST_ASSERT_EQUAL_HEX8(0x4B, sp[DS18B20_SP_TH]);
+    TEST_ASSERT_EQUAL_HEX8(0x46, sp[DS18B20_SP_TL]);
+    TEST_ASSERT_EQUAL(12, ds18b20_config_to_resolution(sp[DS18B20_SP_CONFIG]));
+    TEST_ASSERT_EQUAL_HEX8(onewire_crc8(sp, DS18B20_SP_CRC), sp[DS18B20_SP_CRC]);
+
+    /*Copy Scratchpad, then change the scratchpad again: power-on and Recall E2 restore the copy*/
+    TEST_ASSERT_EQUAL(ESP_OK, ds18b20_write_scratchpad(bus, roms[0], 30, 20, ds18b20_resolution_to_config(9)));
+    TEST_ASSERT_EQUAL(ESP_OK, onewire_select(bus, roms[0]));
+    TEST_ASSERT_EQUAL(ESP_OK, onewire_write_byte(bus, DS18B20_CMD_COPY_SCRATCH));
+    TEST_ASSERT_EQUAL(ESP_OK, ds18b20_write_scratchpad(bus, roms[0], 50, 40, ds18b20_resolution_to_config(11)));
+    TEST_ASSERT_EQUAL(ESP_OK, onewire_select(bus, roms[0]));
+    TEST_ASSERT_EQUAL(ESP_OK, onewire_write_byte(bus, DS18B20_CMD_RECALL_E2));
+    TEST_ASSERT_EQUAL(ESP_OK, ds18b20_read_scratchpad(bus, roms[0], sp));
+    TEST_ASSERT_EQUAL(30, (int8_t)sp[DS18B20_SP_TH]);
+    TEST_ASSERT_EQUAL(20, (int8_t)sp[DS18B20_SP_TL]);
+    onewire_sim_power_cycle(bus, 0);
+    TEST_ASSERT_EQUAL(ESP_OK, ds18b20_read_scratchpad(bus, roms[0], sp));
+    TEST_ASSERT_EQUAL(9, ds18b20_config_to_resolution(sp[DS18B20_SP_CONFIG]));
+
+    /*The other devices were not addressed*/
+    TEST_ASSERT_EQUAL(ESP_OK, ds18b20_read_scratchpad(bus, roms[1], sp));
+    TEST_ASSERT_EQUAL_HEX8(0x4B, sp[DS18B20_SP_TH]);
+}
+
+void test_wire_time_accounting(void)
+{
+    onewire_sim_reset_stats(bus);
+    uint8_t sp[DS18B20_SCRATCHPAD_LEN];
+    TEST_ASSERT_EQUAL(ESP_OK, ds18b20_read_scratchpad(bus, roms[0], sp));
+
+    /*Reset, Match ROM + 8 ROM bytes + Read Scratchpad, 9 bytes back*/
+    const onewire_sim_stats_t * st = onewire_sim_get_stats(bus);
+    TEST_ASSERT_EQUAL_UINT32(1, st->resets);
+    TEST_ASSERT_EQUAL_UINT32(10 * 8, st->bits_written);
+    TEST_ASSERT_EQUAL_UINT32(DS18B20_SCRATCHPAD_LEN * 8, st->bits_read);
+    TEST_ASSERT_EQUAL_UINT64(RESET_US + (10 + DS18B20_SCRATCHPAD_LEN) * 8 * SLOT_US, st->bus_time_us);
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+/*The CRC the table replaced: x^8 + x^5 + x^4 + 1, LSB first*/
+static uint8_t crc8_bitwise(const uint8_t * data, size_t len)
+{
+    uint8_t crc = 0;
+    for(size_t i = 0; i < len; i++) {
+        uint8_t b = data[i];
+        for(int j = 0; j < 8; j++) {
+            uint8_t mix = (crc ^ b) & 0x01;
+            crc >>= 1;
+            if(mix) crc ^= 0x8C;
+            b >>= 1;
+        }
+    }
+    return crc;
+}
+
+static int find_rom(const uint8_t rom[8])
+{
+    for(int i = 0; i < DEVICES; i++) {
+        if(memcmp(roms[i], rom, 8) == 0) return i;
+    }
+    return -1;
+}
+
+static void convert_and_read(int dev, int16_t * raw, esp_err_t expected)
+{
+    TEST_ASSERT_EQUAL(ESP_OK, ds18b20_convert_all(bus));
+    TEST_ASSERT_EQUAL(expected, ds18b20_read_raw(bus, roms[dev], raw));
+}
+
+#endif
@@ -116,6 +116,10 @@
     *Caching has LV_SHADOW_CACHE_SIZE^2 RAM cost*/
     #define LV_SHADOW_CACHE_SIZE 0
 
+    /*Number of shadows to cache (least recently used is replaced).
+    *Caching has LV_SHADOW_CACHE_CNT * LV_SHADOW_CACHE_SIZE^2 RAM cost*/
+    #define LV_SHADOW_CACHE_CNT 1
+
     /* Set number of maximally cached circle data.
     * The circumference of 1/4 circle are saved for anti-aliasing
     * radius * 4 bytes are used per circle (the most often used radiuses are saved)
@@ -15,9 +15,30 @@
  *      DEFINES
  *********************/
 
+/*Word parallel (SWAR) RGB565 kernels: 2 pixels (or 2 channels of a pixel) in the 16 bit lanes of a 32 bit word.
+ *Fill and copy only need 16 bit pixels in little endian words. The blends also unpack the channels
+ *(no LV_COLOR_16_SWAP) and compute the rounded mix exactly like `lv_color_mix()`; with
+ *LV_COLOR_MIX_ROUND_OFS 0 `lv_color_mix()` is already a one multiply SWAR mix and is kept.*/
+#ifndef LV_DRAW_SW_SWAR_565
+#define LV_DRAW_SW_SWAR_565         (LV_COLOR_DEPTH == 16 && LV_BIG_ENDIAN_SYSTEM == 0)
+#endif
+#define LV_DRAW_SW_SWAR_565_MIX     (LV_DRAW_SW_SWAR_565 && LV_COLOR_16_SWAP == 0 && LV_COLOR_MIX_ROUND_OFS != 0)
+
+/*LV_UDIV255() in both 16 bit lanes, exact for x < 65535 (a blend sum is at most 63 * 255 + 254)*/
+#define SWAR_UDIV255(x)     ((((x) + 0x00010001U + (((x) >> 8) & 0x00FF00FFU)) >> 8) & 0x00FF00FFU)
+
 /**********************
  *      TYPEDEFS
  **********************/
+#if LV_DRAW_SW_SWAR_565_MIX
+/*A color premultiplied with an opacity, LV_COLOR_MIX_ROUND_OFS added, in both 16 bit lanes*/
+typedef struct {
+    uint32_t r;
+    uint32_t g;
+    uint32_t b;
+    lv_opa_t opa;
+} premult_565_t;
+#endif
 
 /**********************
  *  STATIC PROTOTYPES
@@ -42,6 +63,20 @@ static void fill_blended(lv_color_t * dest_buf, const lv_area_t * dest_area, lv_
                          lv_opa_t opa, const lv_opa_t * mask, lv_coord_t mask_stride, lv_blend_mode_t blend_mode);
 #endif  /*LV_DRAW_COMPLEX*/
 
+#if LV_DRAW_SW_SWAR_565
+static void /* LV_ATTRIBUTE_FAST_MEM */ fill_565(lv_color_t * dest_buf, lv_color_t color, int32_t px_num);
+static void /* LV_ATTRIBUTE_FAST_MEM */ copy_565(lv_color_t * dest_buf, const lv_color_t * src_buf, int32_t px_num);
+#endif /*LV_DRAW_SW_SWAR_565*/
+
+#if LV_DRAW_SW_SWAR_565_MIX
+static inline void premult_565_set(premult_565_t * premult, lv_color_t color, lv_opa_t opa);
+static inline uint32_t mix_premult_565_x2(uint32_t dest32, const premult_565_t * premult);
+static void /* LV_ATTRIBUTE_FAST_MEM */ fill_opa_565(lv_color_t * dest_buf, int32_t w, int32_t h,
+                                                     lv_coord_t dest_stride, lv_color_t color, lv_opa_t opa);
+static inline void fill_mask_565_x2(lv_color_t * dest_buf, lv_color_t color, const lv_opa_t * mask,
+                                    premult_565_t * premult);
+#endif /*LV_DRAW_SW_SWAR_565_MIX*/
+
 static void map_set_px(lv_color_t * dest_buf, const lv_area_t * dest_area, lv_coord_t dest_stride,
                        const lv_color_t * src_buf, lv_coord_t src_stride, lv_opa_t opa,
                        const lv_opa_t * mask, lv_coord_t mask_stride);
@@ -257,13 +292,28 @@ static LV_ATTRIBUTE_FAST_MEM void fill_normal(lv_color_t * dest_buf, const lv_ar
     /*No mask*/
     if(mask == NULL) {
         if(opa >= LV_OPA_MAX) {
+#if LV_DRAW_SW_SWAR_565
+            /*Full width rows are one run*/
+            if(dest_stride == w) {
+                fill_565(dest_buf, color, w * h);
+                return;
+            }
+            for(y = 0; y < h; y++) {
+                fill_565(dest_buf, color, w);
+                dest_buf += dest_stride;
+            }
+#else
             for(y = 0; y < h; y++) {
                 lv_color_fill(dest_buf, color, w);
                 dest_buf += dest_stride;
             }
+#endif
         }
         /*Has opacity*/
         else {
+#if LV_DRAW_SW_SWAR_565_MIX
+            fill_opa_565(dest_buf, w, h, dest_stride, color, opa);
+#else
             lv_color_t last_dest_color = lv_color_black();
             lv_color_t last_res_color = lv_color_mix(color, last_dest_color, opa);
 
@@ -289,6 +339,7 @@ static LV_ATTRIBUTE_FAST_MEM void fill_normal(lv_color_t * dest_buf, const lv_ar
                 }
                 dest_buf += dest_stride;
             }
+#endif
         }
     }
     /*Masked*/
@@ -298,6 +349,9 @@ static LV_ATTRIBUTE_FAST_MEM void fill_normal(lv_color_t * dest_buf, const lv_ar
 #endif
         /*Only the mask matters*/
         if(opa >= LV_OPA_MAX) {
+#if LV_DRAW_SW_SWAR_565_MIX
+            premult_565_t premult = {0, 0, 0, LV_OPA_TRANSP};
+#endif
             int32_t x_end4 = w - 4;
             for(y = 0; y < h; y++) {
                 for(x = 0; x < w && ((lv_uintptr_t)(mask) & 0x3); x++) {
@@ -329,6 +383,15 @@ static LV_ATTRIBUTE_FAST_MEM void fill_normal(lv_color_t * dest_buf, const lv_ar
                         mask += 4;
                     }
                     else if(mask32) {
+#if LV_DRAW_SW_SWAR_565_MIX
+                        if(((lv_uintptr_t)dest_buf & 0x3) == 0) {
+                            fill_mask_565_x2(dest_buf, color, mask, &premult);
+                            fill_mask_565_x2(dest_buf + 2, color, mask + 2, &premult);
+                            dest_buf += 4;
+                            mask += 4;
+                            continue;
+                        }
+#endif
                         FILL_NORMAL_MASK_PX(color)
                         FILL_NORMAL_MASK_PX(color)
                         FILL_NORMAL_MASK_PX(color)
@@ -659,7 +722,11 @@ static void LV_ATTRIBUTE_FAST_MEM map_normal(lv_color_t * dest_buf, const lv_are
     if(mask == NULL) {
         if(opa >= LV_OPA_MAX) {
             for(y = 0; y < h; y++) {
+#if LV_DRAW_SW_SWAR_565
+                copy_565(dest_buf, src_buf, w);
+#else
                 lv_memcpy(dest_buf, src_buf, w * sizeof(lv_color_t));
+#endif
                 dest_buf += dest_stride;
                 src_buf += src_stride;
             }
@@ -1059,3 +1126,175 @@ static inline lv_color_t color_blend_true_color_multiply(lv_color_t fg, lv_color
 
 #endif
 
+#if LV_DRAW_SW_SWAR_565
+static void LV_ATTRIBUTE_FAST_MEM fill_565(lv_color_t * dest_buf, lv_color_t color, int32_t px_num)
+{
+    if(px_num <= 0) return;
+
+    if((lv_uintptr_t)dest_buf & 0x3) {
+        *dest_buf = color;
+        dest_buf++;
+        px_num--;
+    }
+
+    uint32_t c32 = (uint32_t)color.full | ((uint32_t)color.full << 16);
+    uint32_t * d32 = (uint32_t *)dest_buf;
+    while(px_num >= 8) {
+        d32[0] = c32;
+        d32[1] = c32;
+        d32[2] = c32;
+        d32[3] = c32;
+        d32 += 4;
+        px_num -= 8;
+    }
+    while(px_num >= 2) {
+        *d32 = c32;
+        d32++;
+        px_num -= 2;
+    }
+    if(px_num) *((lv_color_t *)d32) = color;
+}
+
+static void LV_ATTRIBUTE_FAST_MEM copy_565(lv_color_t * dest_buf, const lv_color_t * src_buf, int32_t px_num)
+{
+    if(px_num <= 0) return;
+
+    if((lv_uintptr_t)dest_buf & 0x3) {
+        *dest_buf = *src_buf;
+        dest_buf++;
+        src_buf++;
+        px_num--;
+        if(px_num == 0) return;
+    }
+
+    uint32_t * d32 = (uint32_t *)dest_buf;
+    if(((lv_uintptr_t)src_buf & 0x3) == 0) {
+        const uint32_t * s32 = (const uint32_t *)src_buf;
+        while(px_num >= 8) {
+            d32[0] = s32[0];
+            d32[1] = s32[1];
+            d32[2] = s32[2];
+            d32[3] = s32[3];
+            d32 += 4;
+            s32 += 4;
+            px_num -= 8;
+        }
+        while(px_num >= 2) {
+            *d32 = *s32;
+            d32++;
+            s32++;
+            px_num -= 2;
+        }
+        if(px_num) *((lv_color_t *)d32) = *((const lv_color_t *)s32);
+    }
+    else {
+        /*The source is a half word off (lv_memcpy() would copy bytes): aligned loads, each stored
+         *word joins the high half of one with the low half of the next. Never reads past the row.*/
+        uint32_t prev = src_buf->full;
+        const uint32_t * s32 = (const uint32_t *)(src_buf + 1);
+        while(px_num >= 5) {
+            uint32_t cur0 = s32[0];
+            uint32_t cur1 = s32[1];
+            d32[0] = prev | (cur0 << 16);
+            d32[1] = (cur0 >> 16) | (cur1 << 16);
+            prev = cur1 >> 16;
+            d32 += 2;
+            s32 += 2;
+            px_num -= 4;
+        }
+        while(px_num >= 3) {
+            uint32_t cur = *s32;
+            *d32 = prev | (cur << 16);
+            prev = cur >> 16;
+            d32++;
+            s32++;
+            px_num -= 2;
+        }
+        /*1 or 2 pixels left: `prev` and maybe the one after it*/
+        lv_color_t * d16 = (lv_color_t *)d32;
+        d16[0].full = (uint16_t)prev;
+        if(px_num == 2) d16[1] = *((const lv_color_t *)s32);
+    }
+}
+#endif /*LV_DRAW_SW_SWAR_565*/
+
+#if LV_DRAW_SW_SWAR_565_MIX
+static inline void LV_ATTRIBUTE_FAST_MEM premult_565_set(premult_565_t * premult, lv_color_t color, lv_opa_t opa)
+{
+    premult->r = ((uint32_t)LV_COLOR_GET_R(color) * opa + LV_COLOR_MIX_ROUND_OFS) * 0x00010001U;
+    premult->g = ((uint32_t)LV_COLOR_GET_G(color) * opa + LV_COLOR_MIX_ROUND_OFS) * 0x00010001U;
+    premult->b = ((uint32_t)LV_COLOR_GET_B(color) * opa + LV_COLOR_MIX_ROUND_OFS) * 0x00010001U;
+    premult->opa = opa;
+}
+
+/**
+ * `lv_color_mix(color, dest, premult->opa)` on a pixel pair. Each channel of both pixels
+ * takes 1 multiply (scalar: 2 per channel and pixel, and 1 more for LV_UDIV255()).
+ */
+static inline uint32_t LV_ATTRIBUTE_FAST_MEM mix_premult_565_x2(uint32_t dest32, const premult_565_t * premult)
+{
+    uint32_t opa_inv = 255 - premult->opa;
+    uint32_t r = ((dest32 >> 11) & 0x001F001FU) * opa_inv + premult->r;
+    uint32_t g = ((dest32 >> 5) & 0x003F003FU) * opa_inv + premult->g;
+    uint32_t b = (dest32 & 0x001F001FU) * opa_inv + premult->b;
+
+    return (SWAR_UDIV255(r) << 11) | (SWAR_UDIV255(g) << 5) | SWAR_UDIV255(b);
+}
+
+static void LV_ATTRIBUTE_FAST_MEM fill_opa_565(lv_color_t * dest_buf, int32_t w, int32_t h,
+                                               lv_coord_t dest_stride, lv_color_t color, lv_opa_t opa)
+{
+    premult_565_t premult;
+    premult_565_set(&premult, color, opa);
+
+    /*Buffer the result of the last pixel pair: the background is mostly flat*/
+    uint32_t last_dest32 = 0;
+    uint32_t last_res32 = mix_premult_565_x2(last_dest32, &premult);
+
+    int32_t x;
+    int32_t y;
+    for(y = 0; y < h; y++) {
+        x = 0;
+        if((lv_uintptr_t)dest_buf & 0x3) {
+            dest_buf[0].full = (uint16_t)mix_premult_565_x2(dest_buf[0].full, &premult);
+            x = 1;
+        }
+        for(; x < w - 1; x += 2) {
+            uint32_t * d32 = (uint32_t *)&dest_buf[x];
+            if(*d32 != last_dest32) {
+                last_dest32 = *d32;
+                last_res32 = mix_premult_565_x2(last_dest32, &premult);
+            }
+            *d32 = last_res32;
+        }
+        if(x < w) dest_buf[x].full = (uint16_t)mix_premult_565_x2(dest_buf[x].full, &premult);
+        dest_buf += dest_stride;
+    }
+}
+
+/**
+ * Two pixels of a partly covered mask quad, `dest_buf` word aligned. An equal partial mask
+ * value (the horizontal anti-aliased edges) mixes the pair in one word, `premult` keeps the
+ * color premultiplied with the last one. Different values are mixed one by one.
+ */
+static inline void LV_ATTRIBUTE_FAST_MEM fill_mask_565_x2(lv_color_t * dest_buf, lv_color_t color,
+                                                          const lv_opa_t * mask, premult_565_t * premult)
+{
+    lv_opa_t m = mask[0];
+    if(m != mask[1]) {
+        if(m == LV_OPA_COVER) dest_buf[0] = color;
+        else if(m) dest_buf[0] = lv_color_mix(color, dest_buf[0], m);
+        if(mask[1] == LV_OPA_COVER) dest_buf[1] = color;
+        else if(mask[1]) dest_buf[1] = lv_color_mix(color, dest_buf[1], mask[1]);
+    }
+    else if(m == LV_OPA_COVER) {
+        dest_buf[0] = color;
+        dest_buf[1] = color;
+    }
+    else if(m != LV_OPA_TRANSP) {
+        if(m != premult->opa) premult_565_set(premult, color, m);
+        uint32_t * d32 = (uint32_t *)dest_buf;
+        *d32 = mix_premult_565_x2(*d32, premult);
+    }
+}
+#endif /*LV_DRAW_SW_SWAR_565_MIX*/
@@ -20,10 +20,26 @@
 #define SHADOW_ENHANCE          1
 #define SPLIT_LIMIT             50
 
+#if defined(LV_SHADOW_CACHE_SIZE) && LV_SHADOW_CACHE_SIZE > 0 && LV_SHADOW_CACHE_CNT > 0
+    #define SHADOW_CACHE 1
+#else
+    #define SHADOW_CACHE 0
+#endif
 
 /**********************
  *      TYPEDEFS
  **********************/
+#if SHADOW_CACHE
+/*A blurred corner. It's an opacity map: color and opa are applied only when blending*/
+typedef struct {
+    uint8_t buf[LV_SHADOW_CACHE_SIZE * LV_SHADOW_CACHE_SIZE];
+    int32_t size;           /*Corner size (`shadow_width + radius`), 0: unused*/
+    int32_t r;
+    lv_coord_t w;           /*Size of the blurred rectangle, clamped where it can't affect the corner*/
+    lv_coord_t h;
+    uint32_t last_used;
+} sh_cache_entry_t;
+#endif
 
 /**********************
  *  STATIC PROTOTYPES
@@ -40,6 +56,10 @@ static void /* LV_ATTRIBUTE_FAST_MEM */ draw_shadow(lv_draw_ctx_t * draw_ctx, co
 static void /* LV_ATTRIBUTE_FAST_MEM */ shadow_draw_corner_buf(const lv_area_t * coords, uint16_t * sh_buf,
                                                                lv_coord_t s, lv_coord_t r);
 static void /* LV_ATTRIBUTE_FAST_MEM */ shadow_blur_corner(lv_coord_t size, lv_coord_t sw, uint16_t * sh_ups_buf);
+#if SHADOW_CACHE
+static sh_cache_entry_t * shadow_cache_get(int32_t size, int32_t r, lv_coord_t w, lv_coord_t h);
+static sh_cache_entry_t * shadow_cache_add(int32_t size, int32_t r, lv_coord_t w, lv_coord_t h);
+#endif
 #endif
 
 void draw_border_generic(lv_draw_ctx_t * draw_ctx, const lv_area_t * outer_area, const lv_area_t * inner_area,
@@ -52,10 +72,9 @@ static void draw_border_simple(lv_draw_ctx_t * draw_ctx, const lv_area_t * outer
 /**********************
  *  STATIC VARIABLES
  **********************/
-#if defined(LV_SHADOW_CACHE_SIZE) && LV_SHADOW_CACHE_SIZE > 0
-    static uint8_t sh_cache[LV_SHADOW_CACHE_SIZE * LV_SHADOW_CACHE_SIZE];
-    static int32_t sh_cache_size = -1;
-    static int32_t sh_cache_r = -1;
+#if SHADOW_CACHE
+    static sh_cache_entry_t sh_cache[LV_SHADOW_CACHE_CNT];
+    static uint32_t sh_cache_tick;
 #endif
 
 /**********************
@@ -485,11 +504,15 @@ static void LV_ATTRIBUTE_FAST_MEM draw_shadow(lv_draw_ctx_t * draw_ctx, const lv
 
     lv_opa_t * sh_buf;
 
-#if LV_SHADOW_CACHE_SIZE
-    if(sh_cache_size == corner_size && sh_cache_r == r_sh) {
+#if SHADOW_CACHE
+    /*The corner also depends on the size of small rectangles: their other corners reach into it*/
+    lv_coord_t core_w = LV_MIN(lv_area_get_width(&core_area), 2 * corner_size);
+    lv_coord_t core_h = LV_MIN(lv_area_get_height(&core_area), 2 * corner_size);
+    sh_cache_entry_t * cached = shadow_cache_get(corner_size, r_sh, core_w, core_h);
+    if(cached) {
         /*Use the cache if available*/
         sh_buf = lv_mem_buf_get(corner_size * corner_size);
-        lv_memcpy(sh_buf, sh_cache, corner_size * corner_size);
+        lv_memcpy(sh_buf, cached->buf, corner_size * corner_size);
     }
     else {
         /*A larger buffer is required for calculation*/
@@ -497,10 +520,9 @@ static void LV_ATTRIBUTE_FAST_MEM draw_shadow(lv_draw_ctx_t * draw_ctx, const lv
         shadow_draw_corner_buf(&core_area, (uint16_t *)sh_buf, dsc->shadow_width, r_sh);
 
         /*Cache the corner if it fits into the cache size*/
-        if((uint32_t)corner_size * corner_size < sizeof(sh_cache)) {
-            lv_memcpy(sh_cache, sh_buf, corner_size * corner_size);
-            sh_cache_size = corner_size;
-            sh_cache_r = r_sh;
+        if((uint32_t)corner_size * corner_size < sizeof(cached->buf)) {
+            cached = shadow_cache_add(corner_size, r_sh, core_w, core_h);
+            lv_memcpy(cached->buf, sh_buf, corner_size * corner_size);
         }
     }
 #else
@@ -1109,6 +1131,52 @@ static void LV_ATTRIBUTE_FAST_MEM shadow_blur_corner(lv_coord_t size, lv_coord_t
 
     lv_mem_buf_release(sh_ups_blur_buf);
 }
+
+#if SHADOW_CACHE
+/**
+ * Find a blurred corner in the cache
+ * @param size corner size (`shadow_width + radius`)
+ * @param r radius
+ * @param w width of the blurred rectangle (clamped)
+ * @param h height of the blurred rectangle (clamped)
+ * @return the cache entry or NULL if not cached
+ */
+static sh_cache_entry_t * shadow_cache_get(int32_t size, int32_t r, lv_coord_t w, lv_coord_t h)
+{
+    uint32_t i;
+    for(i = 0; i < LV_SHADOW_CACHE_CNT; i++) {
+        sh_cache_entry_t * entry = &sh_cache[i];
+        if(entry->size == size && entry->r == r && entry->w == w && entry->h == h) {
+            entry->last_used = ++sh_cache_tick;
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Reserve a cache entry for a new corner, replacing the least recently used one
+ * @param size corner size (`shadow_width + radius`)
+ * @param r radius
+ * @param w width of the blurred rectangle (clamped)
+ * @param h height of the blurred rectangle (clamped)
+ * @return the entry whose `buf` should be filled
+ */
+static sh_cache_entry_t * shadow_cache_add(int32_t size, int32_t r, lv_coord_t w, lv_coord_t h)
+{
+    sh_cache_entry_t * entry = &sh_cache[0];
+    uint32_t i;
+    for(i = 1; i < LV_SHADOW_CACHE_CNT; i++) {
+        if(sh_cache[i].last_used < entry->last_used) entry = &sh_cache[i];
+    }
+    entry->size = size;
+    entry->r = r;
+    entry->w = w;
+    entry->h = h;
+    entry->last_used = ++sh_cache_tick;
+    return entry;
+}
+#endif /*SHADOW_CACHE*/
 #endif
 
 static void draw_outline(lv_draw_ctx_t * draw_ctx, const lv_draw_rect_dsc_t * dsc, const lv_area_t * coords)
@@ -302,6 +302,20 @@
         #endif
     #endif
 
+    /*Number of shadows to cache (least recently used is replaced).
+    *Caching has LV_SHADOW_CACHE_CNT * LV_SHADOW_CACHE_SIZE^2 RAM cost*/
+    #ifndef LV_SHADOW_CACHE_CNT
+        #ifdef _LV_KCONFIG_PRESENT
+            #ifdef CONFIG_LV_SHADOW_CACHE_CNT
+                #define LV_SHADOW_CACHE_CNT CONFIG_LV_SHADOW_CACHE_CNT
+            #else
+                #define LV_SHADOW_CACHE_CNT 0
+            #endif
+        #else
+            #define LV_SHADOW_CACHE_CNT 1
+        #endif
+    #endif
+
     /* Set number of maximally cached circle data.
     * The circumference of 1/4 circle are saved for anti-aliasing
     * radius * 4 bytes are used per circle (the most often used radiuses are saved)
@@ -31,6 +31,8 @@
 static void anim_timer(lv_timer_t * param);
 static void anim_mark_list_change(void);
 static void anim_ready_handler(lv_anim_t * a);
+static bool anim_is_last_round(const lv_anim_t * a);
+static void anim_timer_reschedule(uint32_t now);
 
 /**********************
  *  STATIC VARIABLES
@@ -110,6 +112,9 @@ lv_anim_t * lv_anim_start(const lv_anim_t * a)
      *It's important if it happens in a ready callback. (see `anim_timer`)*/
     anim_mark_list_change();
 
+    /*The timer might sleep for a rate limited animation: run it soon to reschedule*/
+    lv_timer_set_period(_lv_anim_tmr, LV_DISP_DEF_REFR_PERIOD);
+
     TRACE_ANIM("finished");
     return new_anim;
 }
@@ -351,6 +356,7 @@ static void anim_timer(lv_timer_t * param)
 {
     LV_UNUSED(param);
 
+    uint32_t now = lv_tick_get();
     uint32_t elaps = lv_tick_elaps(last_timer_run);
 
     /*Flip the run round*/
@@ -383,13 +389,24 @@ static void anim_timer(lv_timer_t * param)
             if(a->act_time >= 0) {
                 if(a->act_time > a->time) a->act_time = a->time;
 
-                int32_t new_value;
-                new_value = a->path_cb(a);
+                /*A rate limited animation is updated only once per frame slot
+                 *(and with its final value before it's deleted)*/
+                bool update = true;
+                if(a->period) {
+                    uint32_t frame = now / a->period;
+                    if(frame == a->last_frame && (a->act_time < a->time || !anim_is_last_round(a))) update = false;
+                    else a->last_frame = frame;
+                }
+
+                if(update) {
+                    int32_t new_value;
+                    new_value = a->path_cb(a);
 
-                if(new_value != a->current_value) {
-                    a->current_value = new_value;
-                    /*Apply the calculated value*/
-                    if(a->exec_cb) a->exec_cb(a->var, new_value);
+                    if(new_value != a->current_value) {
+                        a->current_value = new_value;
+                        /*Apply the calculated value*/
+                        if(a->exec_cb) a->exec_cb(a->var, new_value);
+                    }
                 }
 
                 /*If the time is elapsed the animation is ready*/
@@ -408,6 +425,48 @@ static void anim_timer(lv_timer_t * param)
     }
 
     last_timer_run = lv_tick_get();
+    anim_timer_reschedule(last_timer_run);
+}
+
+/**
+ * Set when the animation timer runs next: at the refresh period if any animation is not
+ * rate limited, else when the first limited animation enters a new frame slot (or ends)
+ * @param now       current tick
+ */
+static void anim_timer_reschedule(uint32_t now)
+{
+    uint32_t next = UINT32_MAX;
+    lv_anim_t * a;
+    _LV_LL_READ(&LV_GC_ROOT(_lv_anim_ll), a) {
+        uint32_t wait;
+        if(a->period == 0) {
+            wait = LV_DISP_DEF_REFR_PERIOD;
+        }
+        else if(a->act_time < 0) {
+            wait = -a->act_time;
+        }
+        else {
+            wait = a->period - now % a->period;
+            if(anim_is_last_round(a) && a->time - a->act_time < (int32_t)wait) wait = a->time - a->act_time;
+        }
+        if(wait < next) next = wait;
+    }
+
+    if(next == UINT32_MAX) return;  /*No animations: the timer is paused*/
+    if(next == 0) next = 1;
+    lv_timer_set_period(_lv_anim_tmr, next);
+}
+
+/**
+ * Tell whether the current forward or play back run is the animation's last one
+ * @param a         pointer to an animation
+ * @return          true: the animation is deleted when `act_time` reaches `time`
+ */
+static bool anim_is_last_round(const lv_anim_t * a)
+{
+    if(a->repeat_cnt == LV_ANIM_REPEAT_INFINITE) return false;
+    if(a->playback_now) return a->repeat_cnt == 0;
+    return a->playback_time == 0 && a->repeat_cnt <= 1;
 }
 
 /**
@@ -90,12 +90,14 @@ typedef struct _lv_anim_t {
     uint32_t playback_time;      /**< Duration of playback animation*/
     uint32_t repeat_delay;       /**< Wait before repeat*/
     uint16_t repeat_cnt;         /**< Repeat count for the animation*/
+    uint16_t period;             /**< Min. time between two updates in ms, 0: update on every animation timer run*/
     uint8_t early_apply  : 1;    /**< 1: Apply start value immediately even is there is `delay`*/
 
     /*Animation system use these - user shouldn't set*/
     uint8_t playback_now : 1; /**< Play back is in progress*/
     uint8_t run_round : 1;    /**< Indicates the animation has run in this round*/
     uint8_t start_cb_called : 1;    /**< Indicates that the `start_cb` was already called*/
+    uint32_t last_frame;      /**< Frame slot (`tick / period`) of the last update*/
 } lv_anim_t;
 
 /**********************
@@ -290,6 +292,18 @@ static inline void lv_anim_set_early_apply(lv_anim_t * a, bool en)
     a->early_apply = en;
 }
 
+/**
+ * Limit how often the animation updates its variable, e.g. for decorative animations.
+ * The updates are aligned to the tick, so animations with the same limit invalidate in the
+ * same refresh, and the animation timer sleeps between them if every animation is limited.
+ * @param a         pointer to an initialized `lv_anim_t` variable
+ * @param fps       max. updates per second, 0: no limit (update on every animation timer run)
+ */
+static inline void lv_anim_set_max_fps(lv_anim_t * a, uint16_t fps)
+{
+    a->period = fps ? 1000 / fps : 0;
+}
+
 /**
  * Set the custom user data field of the animation.
  * @param a           pointer to an initialized `lv_anim_t` variable
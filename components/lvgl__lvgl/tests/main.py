@@ -22,6 +22,7 @@ build_only_options = {
 test_options = {
     'OPTIONS_TEST_SYSHEAP': 'Test config, system heap, 32 bit color depth',
     'OPTIONS_TEST_DEFHEAP': 'Test config, LVGL heap, 32 bit color depth',
+    'OPTIONS_AQUARIUM': 'Aquarium screen, device config, render benchmark',
 }
 
 
@@ -52,9 +53,10 @@ def generate_test_runners():
 
     # TODO: Intermediate files should be in the build folders, not alongside
     #       the other repo source.
-    for f in glob.glob("./src/test_cases/test_*.c"):
-        r = f[:-2] + "_Runner.c"
-        r = r.replace("/test_cases/", "/test_runners/")
+    # The aquarium build also runs the host tests of the DS18B20 component
+    for f in glob.glob("./src/test_cases/test_*.c") + glob.glob("./src/aquarium/test_*.c") + \
+            glob.glob("../../ds18b20/test/test_*.c"):
+        r = os.path.join("./src/test_runners", os.path.basename(f)[:-2] + "_Runner.c")
         subprocess.check_call(['ruby', 'unity/generate_test_runner.rb',
                                f, r, 'config.yml'])
 
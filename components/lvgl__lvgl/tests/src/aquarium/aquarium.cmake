@@ -0,0 +1,204 @@
+# The aquarium screen (main/aquarium_ui.c) on the host, built with the
+# device's LVGL configuration (OPTIONS_AQUARIUM).
+
+get_filename_component(AQUARIUM_MAIN_DIR ${LVGL_DIR}/../../main ABSOLUTE)
+get_filename_component(DS18B20_DIR ${LVGL_DIR}/../ds18b20 ABSOLUTE)
+set(AQUARIUM_TEST_DIR ${LVGL_TEST_DIR}/src/aquarium)
+
+# A Unity test: `source` plus the runner main.py generates for it
+function(aquarium_unity_test name source)
+    add_executable(${name} ${source} ${LVGL_TEST_DIR}/src/test_runners/${name}_Runner.c)
+    target_link_libraries(${name} test_common ${ARGN} lvgl png m)
+    target_include_directories(${name} PUBLIC ${TEST_INCLUDE_DIRS})
+    add_test(
+        NAME ${name}
+        WORKING_DIRECTORY ${LVGL_TEST_DIR}
+        COMMAND ${name})
+endfunction()
+
+add_library(aquarium_ui
+    STATIC
+        ${AQUARIUM_MAIN_DIR}/aquarium_ui.c
+        ${AQUARIUM_MAIN_DIR}/fonts/font_temp_72.c
+        ${AQUARIUM_MAIN_DIR}/fonts/font_temp_36.c
+        ${AQUARIUM_MAIN_DIR}/LVGL_UI/nemo_img.c
+        ${AQUARIUM_MAIN_DIR}/LVGL_Driver/LVGL_Flush_Filter.c
+)
+# stub/ first: it replaces the ESP-IDF headers the screen includes
+target_include_directories(aquarium_ui PUBLIC
+    ${AQUARIUM_TEST_DIR}/stub
+    ${AQUARIUM_MAIN_DIR}
+    ${AQUARIUM_MAIN_DIR}/LVGL_Driver
+    ${TEST_INCLUDE_DIRS}
+)
+target_compile_options(aquarium_ui PUBLIC ${LVGL_TESTFILE_COMPILE_OPTIONS})
+# The app is written for ESP-IDF's warnings, not LVGL's -pedantic-errors
+# (and its snprintf()s are bounded by the value ranges, not the formats)
+target_compile_options(aquarium_ui PRIVATE -Wno-pedantic -Wno-format-truncation)
+target_link_libraries(aquarium_ui lvgl)
+
+add_executable(aquarium_bench ${AQUARIUM_TEST_DIR}/aquarium_bench.c)
+target_link_libraries(aquarium_bench aquarium_ui lvgl m)
+
+# Fails if a counter (invalidated area, bytes, glyphs, heap) grew past the baseline
+add_test(
+    NAME aquarium_bench
+    WORKING_DIRECTORY ${LVGL_TEST_DIR}
+    COMMAND aquarium_bench --check ${AQUARIUM_TEST_DIR}/aquarium_bench_baseline.txt)
+
+# The same benchmark with the shadow cache compiled out (only lv_draw_sw_rect.c
+# is rebuilt: its object comes before liblvgl's): the counters must match the
+# baseline, the render time of the pulse (the status dot's glow) shows the gain
+add_library(lv_draw_sw_rect_nocache OBJECT ${LVGL_DIR}/src/draw/sw/lv_draw_sw_rect.c)
+target_include_directories(lv_draw_sw_rect_nocache PUBLIC ${TEST_INCLUDE_DIRS})
+target_compile_options(lv_draw_sw_rect_nocache PRIVATE ${COMPILE_OPTIONS} -ULV_SHADOW_CACHE_SIZE)
+
+add_executable(aquarium_bench_nocache ${AQUARIUM_TEST_DIR}/aquarium_bench.c $<TARGET_OBJECTS:lv_draw_sw_rect_nocache>)
+target_link_libraries(aquarium_bench_nocache aquarium_ui lvgl m)
+
+add_test(
+    NAME aquarium_bench_nocache
+    WORKING_DIRECTORY ${LVGL_TEST_DIR}
+    COMMAND aquarium_bench_nocache --check ${AQUARIUM_TEST_DIR}/aquarium_bench_baseline.txt)
+
+# Golden images (ref_imgs/aquarium_*.png) and budgets of each UI state.
+# The runner is generated by main.py like the ones of src/test_cases.
+add_executable(test_aquarium_ui
+    ${AQUARIUM_TEST_DIR}/test_aquarium_ui.c
+    ${LVGL_TEST_DIR}/src/test_runners/test_aquarium_ui_Runner.c
+)
+target_link_libraries(test_aquarium_ui test_common aquarium_ui lvgl png m)
+target_include_directories(test_aquarium_ui PUBLIC ${TEST_INCLUDE_DIRS})
+
+add_test(
+    NAME test_aquarium_ui
+    WORKING_DIRECTORY ${LVGL_TEST_DIR}
+    COMMAND test_aquarium_ui)
+
+# Flush filter: skipped blocks, every single-pixel change of a stripe flushed
+aquarium_unity_test(test_flush_filter ${AQUARIUM_TEST_DIR}/test_flush_filter.c aquarium_ui)
+
+# Wake schedule of the device: the real screen and the power counters, the
+# aquarium and LVGL tasks simulated on one core (display on, dimmed, asleep)
+aquarium_unity_test(test_aquarium_power ${AQUARIUM_TEST_DIR}/test_aquarium_power.c aquarium_ui aquarium_app)
+
+# The SWAR RGB565 blend kernels (src/draw/sw/lv_draw_sw_blend.c) against the scalar blends:
+# bit exactness, and a micro-benchmark (run as a smoke test, the timings are only printed)
+add_library(blend565_ref STATIC ${AQUARIUM_TEST_DIR}/blend565_ref.c)
+target_include_directories(blend565_ref PUBLIC ${AQUARIUM_TEST_DIR} ${TEST_INCLUDE_DIRS})
+target_compile_options(blend565_ref PUBLIC ${LVGL_TESTFILE_COMPILE_OPTIONS})
+target_link_libraries(blend565_ref lvgl)
+
+add_executable(test_blend565
+    ${AQUARIUM_TEST_DIR}/test_blend565.c
+    ${LVGL_TEST_DIR}/src/test_runners/test_blend565_Runner.c
+)
+target_link_libraries(test_blend565 test_common blend565_ref lvgl png m)
+target_include_directories(test_blend565 PUBLIC ${TEST_INCLUDE_DIRS})
+
+add_test(
+    NAME test_blend565
+    WORKING_DIRECTORY ${LVGL_TEST_DIR}
+    COMMAND test_blend565)
+
+add_executable(blend565_bench ${AQUARIUM_TEST_DIR}/blend565_bench.c)
+target_link_libraries(blend565_bench blend565_ref lvgl m)
+
+add_test(
+    NAME blend565_bench
+    WORKING_DIRECTORY ${LVGL_TEST_DIR}
+    COMMAND blend565_bench 200)
+
+# The controller (main/aquarium_*.c) and the DS18B20 component on the simulated
+# bus; the fake clock and esp_timer of aquarium_host.c stand in for ESP-IDF
+add_library(ds18b20_host
+    STATIC
+        ${DS18B20_DIR}/onewire_bus.c
+        ${DS18B20_DIR}/onewire_gpio.c
+        ${DS18B20_DIR}/onewire_sim.c
+        ${DS18B20_DIR}/ds18b20.c
+        ${DS18B20_DIR}/onewire_rmt_symbols.c
+)
+target_include_directories(ds18b20_host PUBLIC ${AQUARIUM_TEST_DIR}/stub ${DS18B20_DIR})
+target_compile_options(ds18b20_host PUBLIC ${LVGL_TESTFILE_COMPILE_OPTIONS})
+target_compile_options(ds18b20_host PRIVATE -Wno-pedantic)
+
+add_library(aquarium_app
+    STATIC
+        ${AQUARIUM_MAIN_DIR}/aquarium_sample.c
+        ${AQUARIUM_MAIN_DIR}/aquarium_history.c
+        ${AQUARIUM_MAIN_DIR}/aquarium_filter.c
+        ${AQUARIUM_MAIN_DIR}/aquarium_trend.c
+        ${AQUARIUM_MAIN_DIR}/aquarium_power.c
+        ${AQUARIUM_TEST_DIR}/aquarium_host.c
+        ${AQUARIUM_TEST_DIR}/aquarium_host_ui.c
+)
+target_include_directories(aquarium_app PUBLIC
+    ${AQUARIUM_TEST_DIR}/stub
+    ${AQUARIUM_TEST_DIR}
+    ${AQUARIUM_MAIN_DIR}
+    ${TEST_INCLUDE_DIRS}
+)
+target_compile_options(aquarium_app PUBLIC ${LVGL_TESTFILE_COMPILE_OPTIONS})
+target_compile_options(aquarium_app PRIVATE -Wno-pedantic)
+target_link_libraries(aquarium_app ds18b20_host)
+
+# Read schedule: slot grid, retry backoff, recovery (fake clock)
+aquarium_unity_test(test_aquarium_controller ${AQUARIUM_TEST_DIR}/test_aquarium_controller.c aquarium_app)
+
+# Adaptive interval over a simulated day: samples/day, detection delay
+aquarium_unity_test(test_aquarium_interval ${AQUARIUM_TEST_DIR}/test_aquarium_interval.c aquarium_app)
+
+# Resolution policy over simulated hours: the 9..12-bit split, conversion time saved
+aquarium_unity_test(test_aquarium_resolution ${AQUARIUM_TEST_DIR}/test_aquarium_resolution.c aquarium_app)
+
+# Alarm mode: quiet slots, heartbeat, alarm latch/clear, bus loss, power cycle
+aquarium_unity_test(test_aquarium_alarm ${AQUARIUM_TEST_DIR}/test_aquarium_alarm.c aquarium_app)
+target_compile_definitions(test_aquarium_alarm PRIVATE AQUARIUM_ALARM_MODE=1)
+
+# Delta-encoded history: round trip, queries, ring wrap, long gaps; and
+# its micro-benchmark (run as a smoke test, the timings are only printed)
+aquarium_unity_test(test_aquarium_history ${AQUARIUM_TEST_DIR}/test_aquarium_history.c aquarium_app)
+
+add_executable(history_bench ${AQUARIUM_TEST_DIR}/history_bench.c)
+target_link_libraries(history_bench aquarium_app)
+
+add_test(
+    NAME history_bench
+    WORKING_DIRECTORY ${LVGL_TEST_DIR}
+    COMMAND history_bench 2)
+
+# Integer temperature conversions against a double reference, every code
+aquarium_unity_test(test_aquarium_conversions ${AQUARIUM_TEST_DIR}/test_aquarium_conversions.c aquarium_app)
+
+# Trend: the O(1) sliding regression against a brute-force one
+aquarium_unity_test(test_aquarium_trend ${AQUARIUM_TEST_DIR}/test_aquarium_trend.c aquarium_app)
+
+# Sample filter on a recorded-style trace (traces/gen_filter_trace.py):
+# false alarms against detection latency per configuration; fails if the
+# shipped one lets a false alarm through or reports an excursion late
+add_executable(filter_replay ${AQUARIUM_TEST_DIR}/filter_replay.c)
+target_link_libraries(filter_replay aquarium_app)
+
+add_test(
+    NAME filter_replay
+    WORKING_DIRECTORY ${LVGL_TEST_DIR}
+    COMMAND filter_replay ${AQUARIUM_TEST_DIR}/traces/filter_spikes.csv --check)
+
+# Sample seqlock and statistics getters read from other threads
+aquarium_unity_test(test_aquarium_concurrency ${AQUARIUM_TEST_DIR}/test_aquarium_concurrency.c aquarium_app pthread)
+
+# components/ds18b20/test: slot timing of the RMT symbols
+aquarium_unity_test(test_onewire_rmt_symbols ${DS18B20_DIR}/test/test_onewire_rmt_symbols.c ds18b20_host)
+
+# components/ds18b20/test: protocol layer on the simulated bus, and its
+# micro-benchmark (run as a smoke test, the timings are only printed)
+aquarium_unity_test(test_onewire_sim ${DS18B20_DIR}/test/test_onewire_sim.c ds18b20_host)
+
+add_executable(onewire_sim_bench ${DS18B20_DIR}/test/onewire_sim_bench.c)
+target_link_libraries(onewire_sim_bench ds18b20_host)
+
+add_test(
+    NAME onewire_sim_bench
+    WORKING_DIRECTORY ${LVGL_TEST_DIR}
+    COMMAND onewire_sim_bench 2000)
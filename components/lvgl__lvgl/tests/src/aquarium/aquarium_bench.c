@@ -0,0 +1,402 @@
+/**
+ * @file aquarium_bench.c
+ * Render benchmark of the aquarium screen (main/aquarium_ui.c) with the
+ * device's LVGL configuration, a fake flush and a simulated clock
+ * (lv_tick_inc() per step, like the LVGL task would see the time pass).
+ *
+ * A scripted sample stream is replayed (normal, cold, hot, sensor lost)
+ * with the backlight dimmed, so the status dot pulse is stopped and only
+ * the cost of the samples counts; the pulse scenario then runs the pulse
+ * alone (an unchanged reading, display on). For each scenario it reports
+ * frames, render time per frame,
+ * invalidated area, bytes flushed by LVGL, bytes left after the flush
+ * filter (what the panel would get), glyphs drawn, pixels of the static
+ * objects (Nemo, CELSIUS) redrawn and the lv_mem peak.
+ *
+ * static_px is all a cached static layer could skip: the background under a
+ * dynamic widget would be copied from the layer instead of filled, the same
+ * work. It is 0 after boot (the baseline holds it there), the layer would
+ * take a whole frame of RAM.
+ *
+ * aquarium_bench_nocache is the same with the shadow cache compiled out:
+ * the pulse scenario, which redraws the status dot's glow every frame,
+ * shows in its render time what the cache saves.
+ *
+ * aquarium_bench                  print the results (the baseline format)
+ * aquarium_bench --check FILE     also compare with FILE: fails if a counter
+ *                                 grew, render time is only reported
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "lvgl.h"
+#include "aquarium_ui.h"
+#include "aquarium_controller.h"
+#include "LVGL_Flush_Filter.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*********************
+ *      DEFINES
+ *********************/
+#define HOR_RES             172
+#define VER_RES             320
+#define BUF_LINES           20      /*LVGL_BUF_MIN_LINES: the smallest stripes the device may get*/
+#define TICK_MS             5       /*Simulated lv_timer_handler() period*/
+#define SAMPLE_PERIOD_MS    5000    /*TEMP_UPDATE_INTERVAL_MS*/
+#define PASSES              50      /*Render time: best pass, counters: last pass*/
+#define MAX_SCENARIOS       8
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct {
+    int16_t temp_centi;
+    bool valid;
+} bench_sample_t;
+
+typedef struct {
+    const char * name;
+    const bench_sample_t * samples;     /*Terminated by temp_centi == 0*/
+    bool pulse;                         /*Display on: the status dot pulses*/
+} bench_scenario_t;
+
+typedef struct {
+    uint32_t frames;
+    uint64_t render_ns;
+    uint64_t inv_px;
+    uint64_t flushed_bytes;
+    uint64_t panel_bytes;
+    uint32_t glyphs;
+    uint64_t static_px;
+    uint32_t mem_peak;
+} bench_result_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void flush_cb(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * color_p);
+static void rounder_cb(lv_disp_drv_t * drv, lv_area_t * area);
+static void monitor_cb(lv_disp_drv_t * drv, uint32_t time, uint32_t px);
+static void draw_letter_count(lv_draw_ctx_t * draw_ctx, const lv_draw_label_dsc_t * dsc, const lv_point_t * pos_p,
+                              uint32_t letter);
+static void static_draw_cb(lv_event_t * e);
+static uint32_t hook_static_objs(lv_obj_t * scr);
+static uint64_t time_ns(void);
+static void run_for(uint32_t ms, bench_result_t * res);
+static void run_scenario(const bench_scenario_t * sc, bench_result_t * res);
+static void print_result(const char * name, const bench_result_t * res);
+static int check_one(const char * scenario, const char * what, uint64_t now, unsigned long base);
+static int check_baseline(const char * path, const bench_result_t * res, uint32_t cnt);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static const bench_sample_t normal[] = {{2500, true}, {2500, true}, {2502, true}, {2510, true}, {2610, true}, {2610, true}, {0}};
+static const bench_sample_t cold[] = {{2280, true}, {2280, true}, {2260, true}, {2200, true}, {0}};
+static const bench_sample_t hot[] = {{2840, true}, {2840, true}, {2890, true}, {2950, true}, {0}};
+static const bench_sample_t lost[] = {{2950, false}, {2950, false}, {2950, false}, {0}};
+static const bench_sample_t steady[] = {{2950, false}, {2950, false}, {0}};    /*Where lost leaves it*/
+
+static const bench_scenario_t scenarios[] = {
+    {"normal", normal, false},
+    {"cold", cold, false},
+    {"hot", hot, false},
+    {"sensor_lost", lost, false},
+    {"pulse", steady, true},
+};
+#define SCENARIO_CNT (sizeof(scenarios) / sizeof(scenarios[0]))
+
+static aquarium_sample_t sample;
+static uint32_t sample_seq;
+
+static lv_color_t buf1[HOR_RES * BUF_LINES];
+static lv_color_t buf2[HOR_RES * BUF_LINES];
+static uint32_t filter_hash[FLUSH_FILTER_HASHES(HOR_RES, VER_RES)];
+static flush_filter_t filter;
+static void (*draw_letter_orig)(lv_draw_ctx_t *, const lv_draw_label_dsc_t *, const lv_point_t *, uint32_t);
+
+static bench_result_t * cur;    /*Where the callbacks count*/
+static bool refreshed;
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+void lv_test_assert_fail(void)
+{
+    fprintf(stderr, "LVGL assert failed\n");
+    abort();
+}
+
+/*The controller and the LVGL task, as seen by aquarium_ui.c*/
+bool aquarium_get_sample(int index, aquarium_sample_t * out)
+{
+    LV_UNUSED(index);
+    *out = sample;
+    return sample_seq != 0;
+}
+
+uint32_t aquarium_get_sample_seq(int index)
+{
+    LV_UNUSED(index);
+    return sample_seq;
+}
+
+bool LVGL_Lock(int timeout_ms)
+{
+    LV_UNUSED(timeout_ms);
+    return true;
+}
+
+void LVGL_Unlock(void)
+{
+}
+
+void LVGL_Wake(void)
+{
+}
+
+int main(int argc, char ** argv)
+{
+    const char * baseline = NULL;
+    if(argc == 3 && strcmp(argv[1], "--check") == 0) baseline = argv[2];
+    else if(argc != 1) {
+        fprintf(stderr, "usage: %s [--check BASELINE]\n", argv[0]);
+        return 2;
+    }
+
+    lv_init();
+    static lv_disp_draw_buf_t draw_buf;
+    lv_disp_draw_buf_init(&draw_buf, buf1, buf2, HOR_RES * BUF_LINES);
+    static lv_disp_drv_t disp_drv;
+    lv_disp_drv_init(&disp_drv);
+    disp_drv.hor_res = HOR_RES;
+    disp_drv.ver_res = VER_RES;
+    disp_drv.draw_buf = &draw_buf;
+    disp_drv.flush_cb = flush_cb;
+    disp_drv.rounder_cb = rounder_cb;
+    disp_drv.monitor_cb = monitor_cb;
+    Flush_Filter_Init(&filter, filter_hash, HOR_RES, VER_RES);
+    lv_disp_t * disp = lv_disp_drv_register(&disp_drv);
+    draw_letter_orig = disp->driver->draw_ctx->draw_letter;
+    disp->driver->draw_ctx->draw_letter = draw_letter_count;
+
+    bench_result_t res[MAX_SCENARIOS];
+    lv_memset_00(res, sizeof(res));
+
+    /*Boot: the screen before the first sample*/
+    aquarium_ui_set_dimmed(true);
+    aquarium_ui_init();
+    if(hook_static_objs(lv_scr_act()) != 2) {
+        fprintf(stderr, "Nemo and CELSIUS not found on the screen\n");
+        return 2;
+    }
+    run_for(SAMPLE_PERIOD_MS, &res[0]);
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    res[0].mem_peak = mon.max_used;
+
+    uint32_t p;
+    for(p = 0; p < PASSES; p++) {
+        uint32_t i;
+        for(i = 0; i < SCENARIO_CNT; i++) {
+            bench_result_t r;
+            run_scenario(&scenarios[i], &r);
+            bench_result_t * best = &res[i + 1];
+            uint64_t best_ns = p == 0 || r.render_ns < best->render_ns ? r.render_ns : best->render_ns;
+            *best = r;
+            best->render_ns = best_ns;
+        }
+    }
+
+    printf("# aquarium_bench: %dx%d RGB565, %d-line stripes, flush filter %d px blocks, best of %d passes\n",
+           HOR_RES, VER_RES, BUF_LINES, FLUSH_FILTER_BLOCK_W, PASSES);
+    printf("# %-12s %7s %10s %8s %10s %9s %7s %9s %10s\n", "scenario", "frames", "render_us", "inv_px", "flushed_B",
+           "panel_B", "glyphs", "static_px", "mem_peak_B");
+    print_result("boot", &res[0]);
+    uint32_t i;
+    for(i = 0; i < SCENARIO_CNT; i++) print_result(scenarios[i].name, &res[i + 1]);
+
+    uint64_t static_px = 0;
+    for(i = 0; i < SCENARIO_CNT; i++) static_px += res[i + 1].static_px;
+    printf("# static layer: %u px of static objects redrawn after boot, a cached layer would take %u B\n",
+           (unsigned)static_px, (unsigned)(HOR_RES * VER_RES * sizeof(lv_color_t)));
+
+    return baseline ? check_baseline(baseline, res, SCENARIO_CNT + 1) : 0;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static void flush_cb(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * color_p)
+{
+    lv_area_t window;
+    cur->flushed_bytes += lv_area_get_size(area) * sizeof(lv_color_t);
+    if(Flush_Filter_Apply(&filter, area, color_p, &window)) {
+        cur->panel_bytes += lv_area_get_size(&window) * sizeof(lv_color_t);
+    }
+    lv_disp_flush_ready(drv);
+}
+
+static void rounder_cb(lv_disp_drv_t * drv, lv_area_t * area)
+{
+    LV_UNUSED(drv);
+    Flush_Filter_Round(&filter, area);
+}
+
+static void monitor_cb(lv_disp_drv_t * drv, uint32_t time, uint32_t px)
+{
+    LV_UNUSED(drv);
+    LV_UNUSED(time);
+    cur->frames++;
+    cur->inv_px += px;
+    refreshed = true;
+}
+
+static void draw_letter_count(lv_draw_ctx_t * draw_ctx, const lv_draw_label_dsc_t * dsc, const lv_point_t * pos_p,
+                              uint32_t letter)
+{
+    cur->glyphs++;
+    draw_letter_orig(draw_ctx, dsc, pos_p, letter);
+}
+
+static void static_draw_cb(lv_event_t * e)
+{
+    lv_obj_t * obj = lv_event_get_target(e);
+    lv_area_t drawn;
+    if(_lv_area_intersect(&drawn, lv_event_get_draw_ctx(e)->clip_area, &obj->coords)) {
+        cur->static_px += lv_area_get_size(&drawn);
+    }
+}
+
+/*aquarium_ui.c keeps its objects to itself: Nemo is the image, CELSIUS the
+ *label that says so*/
+static uint32_t hook_static_objs(lv_obj_t * scr)
+{
+    uint32_t found = 0;
+    uint32_t i;
+    for(i = 0; i < lv_obj_get_child_cnt(scr); i++) {
+        lv_obj_t * obj = lv_obj_get_child(scr, (int32_t)i);
+        if(lv_obj_check_type(obj, &lv_img_class) ||
+           (lv_obj_check_type(obj, &lv_label_class) && strcmp(lv_label_get_text(obj), "CELSIUS") == 0)) {
+            lv_obj_add_event_cb(obj, static_draw_cb, LV_EVENT_DRAW_MAIN, NULL);
+            found++;
+        }
+    }
+    return found;
+}
+
+static uint64_t time_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/*Step the clock like the LVGL task would; only passes that refresh count as render time*/
+static void run_for(uint32_t ms, bench_result_t * res)
+{
+    cur = res;
+    uint32_t t;
+    for(t = 0; t < ms; t += TICK_MS) {
+        refreshed = false;
+        uint64_t start = time_ns();
+        lv_timer_handler();
+        uint64_t elapsed = time_ns() - start;
+        if(refreshed) res->render_ns += elapsed;
+        lv_tick_inc(TICK_MS);
+    }
+}
+
+static void run_scenario(const bench_scenario_t * sc, bench_result_t * res)
+{
+    lv_memset_00(res, sizeof(*res));
+    if(sc->pulse) aquarium_ui_set_dimmed(false);
+    const bench_sample_t * s;
+    for(s = sc->samples; s->temp_centi != 0; s++) {
+        sample.temp_centi = s->temp_centi;
+        sample.valid = s->valid;
+        sample.eta_s = -1;
+        sample.seq = ++sample_seq;
+        aquarium_ui_notify_sample();
+        run_for(SAMPLE_PERIOD_MS, res);
+    }
+    if(sc->pulse) {
+        /*The dot back at full opacity is part of it, not of the next scenario*/
+        aquarium_ui_set_dimmed(true);
+        run_for(SAMPLE_PERIOD_MS, res);
+    }
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    res->mem_peak = mon.max_used;
+}
+
+static void print_result(const char * name, const bench_result_t * res)
+{
+    uint64_t render_us = res->frames ? res->render_ns / res->frames / 1000 : 0;
+    printf("%-14s %7u %10u %8u %10u %9u %7u %9u %10u\n", name, (unsigned)res->frames, (unsigned)render_us,
+           (unsigned)res->inv_px, (unsigned)res->flushed_bytes, (unsigned)res->panel_bytes, (unsigned)res->glyphs,
+           (unsigned)res->static_px, (unsigned)res->mem_peak);
+}
+
+static int check_one(const char * scenario, const char * what, uint64_t now, unsigned long base)
+{
+    if(now > base) {
+        printf("REGRESSION %s %s: %u (baseline %lu)\n", scenario, what, (unsigned)now, base);
+        return 1;
+    }
+    if(now < base) printf("improved   %s %s: %u (baseline %lu), update the baseline\n", scenario, what, (unsigned)now,
+                              base);
+    return 0;
+}
+
+static int check_baseline(const char * path, const bench_result_t * res, uint32_t cnt)
+{
+    FILE * f = fopen(path, "r");
+    if(f == NULL) {
+        printf("Cannot open baseline %s\n", path);
+        return 1;
+    }
+
+    int failed = 0;
+    uint32_t found = 0;
+    char line[256];
+    while(fgets(line, sizeof(line), f)) {
+        char name[32];
+        unsigned long frames, render_us, inv_px, flushed, panel, glyphs, static_px, mem_peak;
+        if(line[0] == '#') continue;
+        if(sscanf(line, "%31s %lu %lu %lu %lu %lu %lu %lu %lu", name, &frames, &render_us, &inv_px, &flushed, &panel,
+                  &glyphs, &static_px, &mem_peak) != 9) continue;
+
+        uint32_t i;
+        for(i = 0; i < cnt; i++) {
+            const char * sc_name = i == 0 ? "boot" : scenarios[i - 1].name;
+            if(strcmp(name, sc_name) != 0) continue;
+            const bench_result_t * r = &res[i];
+            found++;
+            failed += check_one(name, "frames", r->frames, frames);
+            failed += check_one(name, "inv_px", r->inv_px, inv_px);
+            failed += check_one(name, "flushed_B", r->flushed_bytes, flushed);
+            failed += check_one(name, "panel_B", r->panel_bytes, panel);
+            failed += check_one(name, "glyphs", r->glyphs, glyphs);
+            failed += check_one(name, "static_px", r->static_px, static_px);
+            failed += check_one(name, "mem_peak_B", r->mem_peak, mem_peak);
+            uint64_t us = r->frames ? r->render_ns / r->frames / 1000 : 0;
+            if(render_us) printf("render     %s: %u us/frame (baseline %lu, %+d%%)\n", name, (unsigned)us, render_us,
+                                     (int)(((int64_t)us - (int64_t)render_us) * 100 / (int64_t)render_us));
+        }
+    }
+    fclose(f);
+
+    if(found != cnt) {
+        printf("Baseline %s lists %u of %u scenarios\n", path, (unsigned)found, (unsigned)cnt);
+        failed++;
+    }
+    printf("%s\n", failed ? "FAILED: counters above the baseline" : "OK: no counter above the baseline");
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,85 @@
+/**
+ * @file aquarium_controller_harness.c
+ * main/aquarium_controller.c plus a driver that runs it like its task does,
+ * on the fake clock of aquarium_host.c: each wake-up fires the armed
+ * esp_timer (plus a wake-up latency) and runs one aquarium_task_wake().
+ *
+ * Not compiled on its own: a controller test includes it first and so
+ * reaches the controller's statics (one controller per test executable).
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "aquarium_controller.c"
+#include "aquarium_host.h"
+#include "onewire_sim.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define HARNESS_T0_US       1000000LL   /*First slot*/
+#define HARNESS_MAX_WAKES   64          /*Per sample: conversion + retries*/
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+/**
+ * Fresh controller on `bus` (a simulated bus with its probes), reader at the
+ * first slot HARNESS_T0_US. Mirrors aquarium_controller_init() +
+ * aquarium_start() + the start of aquarium_task().
+ */
+static inline void harness_start(onewire_bus_t * bus, ds_reader_t * reader)
+{
+    aquarium_host_reset(HARNESS_T0_US);
+    memset(g_sensors, 0, sizeof(g_sensors));
+    memset(g_filters, 0, sizeof(g_filters));
+    memset(g_samples, 0, sizeof(g_samples));
+    g_sensor_count = 0;
+    atomic_store(&g_published_count, 0);
+    memset(&g_conv_stats, 0, sizeof(g_conv_stats));
+    memset(&g_sched_stats, 0, sizeof(g_sched_stats));
+
+    s_bus = bus;
+    led_gradient_init();
+    aquarium_start();
+    ds_reader_init(reader, esp_timer_get_time());
+    g_sched_stats.interval_ms = reader->interval_ms;
+    stats_publish();
+}
+
+/**
+ * The wake timer fires, the task runs `latency_us` later. The first call
+ * after harness_start() runs at once (nothing is armed yet).
+ */
+static inline ds_result_t harness_wake(ds_reader_t * reader, int64_t latency_us)
+{
+    aquarium_host_fire_timer(latency_us);
+    return aquarium_task_wake(reader);
+}
+
+/**
+ * Wake until the current sample is done (OK, FAILED or QUIET)
+ */
+static inline ds_result_t harness_sample(ds_reader_t * reader, int64_t latency_us)
+{
+    for(int i = 0; i < HARNESS_MAX_WAKES; i++) {
+        ds_result_t res = harness_wake(reader, latency_us);
+        if(res != DS_RESULT_NONE) return res;
+    }
+    return DS_RESULT_NONE;
+}
+
+/**
+ * Index in g_sensors of simulated device `dev`, -1 if not enumerated
+ */
+static inline int harness_sensor_of(onewire_bus_t * bus, int dev)
+{
+    uint8_t rom[8];
+    onewire_sim_get_rom(bus, dev, rom);
+    for(int i = 0; i < g_sensor_count; i++) {
+        if(memcmp(g_sensors[i].rom, rom, sizeof(rom)) == 0) return i;
+    }
+    return -1;
+}
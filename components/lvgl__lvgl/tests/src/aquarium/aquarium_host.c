@@ -0,0 +1,128 @@
+/**
+ * @file aquarium_host.c
+ * Fake clock, fake esp_timer and hook recorders for the controller tests.
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "aquarium_host.h"
+#include "esp_timer.h"
+#include "onewire_bus.h"
+#include "RGB.h"
+#include "Matter/aquarium_matter.h"
+#include <string.h>
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static int64_t now;
+static int64_t timer_deadline = -1;
+static aquarium_host_calls_t calls;
+
+/*The single timer the controller creates*/
+static struct esp_timer {
+    esp_timer_create_args_t args;
+} timer;
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+void aquarium_host_reset(int64_t now_us)
+{
+    now = now_us;
+    timer_deadline = -1;
+    memset(&calls, 0, sizeof(calls));
+}
+
+void aquarium_host_set_time(int64_t now_us)
+{
+    if(now_us > now) now = now_us;
+}
+
+int64_t aquarium_host_timer_deadline(void)
+{
+    return timer_deadline;
+}
+
+int64_t aquarium_host_fire_timer(int64_t latency_us)
+{
+    if(timer_deadline >= 0) aquarium_host_set_time(timer_deadline + latency_us);
+    timer_deadline = -1;
+    return now;
+}
+
+const aquarium_host_calls_t * aquarium_host_get_calls(void)
+{
+    return &calls;
+}
+
+void aquarium_host_count_ui_notify(void)
+{
+    calls.ui_notifies++;
+}
+
+/*esp_timer*/
+int64_t esp_timer_get_time(void)
+{
+    return now;
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t * args, esp_timer_handle_t * out_handle)
+{
+    timer.args = *args;
+    *out_handle = &timer;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t t, uint64_t timeout_us)
+{
+    (void)t;
+    timer_deadline = now + (int64_t)timeout_us;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t t)
+{
+    (void)t;
+    timer_deadline = -1;
+    return ESP_OK;
+}
+
+/*Board*/
+void Set_RGB(uint8_t red_val, uint8_t green_val, uint8_t blue_val)
+{
+    calls.led_sets++;
+    calls.led[0] = red_val;
+    calls.led[1] = green_val;
+    calls.led[2] = blue_val;
+}
+
+void aquarium_matter_update_temperature(int16_t temp_centi)
+{
+    calls.matter_temps++;
+    calls.matter_temp = temp_centi;
+}
+
+void aquarium_matter_update_trend(int16_t slope_centi_h, int32_t eta_s)
+{
+    (void)slope_centi_h;
+    (void)eta_s;
+    calls.matter_trends++;
+}
+
+/*The probe transports need pins: the host only has the simulated bus*/
+esp_err_t onewire_new_rmt_bus(int pin, onewire_bus_t ** ret_bus)
+{
+    (void)pin;
+    (void)ret_bus;
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t onewire_new_gpio_bus(int pin, onewire_bus_t ** ret_bus)
+{
+    (void)pin;
+    (void)ret_bus;
+    return ESP_ERR_NOT_SUPPORTED;
+}
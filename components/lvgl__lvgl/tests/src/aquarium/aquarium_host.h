@@ -0,0 +1,71 @@
+/**
+ * @file aquarium_host.h
+ * The services main/aquarium_controller.c uses, on the host: a fake clock
+ * behind esp_timer_get_time() and the one-shot esp_timer, and recorders for
+ * the LED, Matter and UI hooks. Tests move the clock; nothing runs by itself.
+ */
+
+#ifndef AQUARIUM_HOST_H
+#define AQUARIUM_HOST_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdint.h>
+#include <stdbool.h>
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+/*What the controller told the outside world*/
+typedef struct {
+    uint32_t led_sets;
+    uint8_t led[3];                 /*Last Set_RGB(): red, green, blue*/
+    uint32_t matter_temps;
+    int16_t matter_temp;            /*Last temperature sent to Matter*/
+    uint32_t matter_trends;
+    uint32_t ui_notifies;
+} aquarium_host_calls_t;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Reset the clock to `now_us`, disarm the timers and clear the recorders
+ */
+void aquarium_host_reset(int64_t now_us);
+
+/**
+ * Set the time esp_timer_get_time() returns (never moves backwards)
+ */
+void aquarium_host_set_time(int64_t now_us);
+
+/**
+ * When the last armed one-shot timer fires, -1 if none is armed
+ */
+int64_t aquarium_host_timer_deadline(void);
+
+/**
+ * Move the clock to the timer deadline plus `latency_us` (the wake-up
+ * latency of the task) and disarm the timer. Returns the new time.
+ */
+int64_t aquarium_host_fire_timer(int64_t latency_us);
+
+/**
+ * The recorded hook calls
+ */
+const aquarium_host_calls_t * aquarium_host_get_calls(void);
+
+/*Only for aquarium_host_ui.c*/
+void aquarium_host_count_ui_notify(void);
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*AQUARIUM_HOST_H*/
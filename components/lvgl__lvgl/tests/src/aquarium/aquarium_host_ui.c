@@ -0,0 +1,20 @@
+/**
+ * @file aquarium_host_ui.c
+ * aquarium_ui_notify_sample() for the tests without the screen. A separate
+ * object, so a test linking aquarium_ui gets the real one.
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "aquarium_host.h"
+#include "aquarium_ui.h"
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+void aquarium_ui_notify_sample(void)
+{
+    aquarium_host_count_ui_notify();
+}
@@ -0,0 +1,205 @@
+/**
+ * @file blend565_bench.c
+ * Micro-benchmark of the RGB565 normal blends: the scalar loops (blend565_ref.c) against
+ * lv_draw_sw_blend_basic() with the kernels this build selected (SWAR for LV_COLOR_DEPTH 16).
+ *
+ * The blends run on one draw buffer stripe of the device (172 x 20 px), aligned and one
+ * pixel off, the way the aquarium screen uses them: background fills, a translucent fill,
+ * glyph-like masks and image copies. Host timings only show the trend, the C6 is an
+ * in-order RV32 core without SIMD.
+ *
+ * blend565_bench [ITERATIONS]
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "lvgl.h"
+#include "blend565_ref.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*********************
+ *      DEFINES
+ *********************/
+#define HOR_RES         172
+#define BUF_LINES       20      /*LVGL_BUF_MIN_LINES*/
+#define ITERATIONS      2000
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef enum {
+    KIND_FILL,
+    KIND_FILL_OPA,
+    KIND_FILL_MASK,
+    KIND_FILL_MASK_EDGE,
+    KIND_FILL_MASK_OPA,
+    KIND_COPY,
+} bench_kind_t;
+
+typedef struct {
+    const char * name;
+    bench_kind_t kind;
+    int32_t ofs;        /*Destination (and source) offset in pixels*/
+    int32_t w;
+    lv_coord_t stride;
+    bool flat_bg;       /*A flat background or noise (the result caches only help on flat ones)*/
+} bench_case_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void prepare(const bench_case_t * c);
+static void run(const bench_case_t * c, bool scalar);
+static uint64_t time_ns(void);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static const bench_case_t cases[] = {
+    {"fill, full stripe", KIND_FILL, 0, HOR_RES, HOR_RES, true},
+    {"fill, inset odd", KIND_FILL, 1, HOR_RES - 3, HOR_RES, true},
+    {"fill opa 50%, flat", KIND_FILL_OPA, 0, HOR_RES, HOR_RES, true},
+    {"fill opa 50%, noise", KIND_FILL_OPA, 1, HOR_RES - 3, HOR_RES, false},
+    {"mask fill (glyphs)", KIND_FILL_MASK, 0, HOR_RES, HOR_RES, false},
+    {"mask fill, AA rows", KIND_FILL_MASK_EDGE, 1, HOR_RES - 3, HOR_RES, false},
+    {"mask fill, opa 60%", KIND_FILL_MASK_OPA, 1, HOR_RES - 3, HOR_RES, false},
+    {"copy, aligned", KIND_COPY, 0, HOR_RES, HOR_RES, false},
+    {"copy, 1 px off", KIND_COPY, 1, HOR_RES - 3, HOR_RES, false},
+};
+
+/*uint32_t: word aligned*/
+static uint32_t dest32[(HOR_RES * BUF_LINES) / 2 + 2];
+static uint32_t bg32[(HOR_RES * BUF_LINES) / 2 + 2];
+static uint32_t src32[(HOR_RES * BUF_LINES) / 2 + 2];
+static lv_opa_t mask[HOR_RES * BUF_LINES];
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+void lv_test_assert_fail(void)
+{
+    fprintf(stderr, "LVGL assert failed\n");
+    abort();
+}
+
+int main(int argc, char ** argv)
+{
+    uint32_t iterations = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 10) : ITERATIONS;
+    if(iterations == 0) {
+        fprintf(stderr, "usage: %s [ITERATIONS]\n", argv[0]);
+        return 2;
+    }
+
+    /*A display for lv_draw_sw_blend_basic(): its draw_ctx and "refreshing" display*/
+    lv_init();
+    static lv_color_t buf[HOR_RES * BUF_LINES];
+    static lv_disp_draw_buf_t draw_buf;
+    lv_disp_draw_buf_init(&draw_buf, buf, NULL, HOR_RES * BUF_LINES);
+    static lv_disp_drv_t disp_drv;
+    lv_disp_drv_init(&disp_drv);
+    disp_drv.hor_res = HOR_RES;
+    disp_drv.ver_res = BUF_LINES;
+    disp_drv.draw_buf = &draw_buf;
+    lv_disp_drv_register(&disp_drv);
+
+    printf("# blend565_bench: %dx%d px stripes, %u iterations, ns per pixel\n", HOR_RES, BUF_LINES,
+           (unsigned)iterations);
+    printf("# %-22s %8s %8s %8s\n", "case", "scalar", "build", "speedup");
+
+    uint32_t i;
+    for(i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        const bench_case_t * c = &cases[i];
+        prepare(c);
+
+        uint64_t ns[2];
+        uint32_t s;
+        for(s = 0; s < 2; s++) {
+            ns[s] = 0;
+            uint32_t it;
+            for(it = 0; it < iterations; it++) {
+                lv_memcpy(dest32, bg32, sizeof(dest32));    /*Every pass on the same background*/
+                uint64_t start = time_ns();
+                run(c, s == 0);
+                ns[s] += time_ns() - start;
+            }
+        }
+
+        double px = (double)c->w * BUF_LINES * iterations;
+        printf("%-24s %8.3f %8.3f %7.2fx\n", c->name, ns[0] / px, ns[1] / px, (double)ns[0] / (double)ns[1]);
+    }
+
+    return 0;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static void prepare(const bench_case_t * c)
+{
+    lv_color_t * bg = (lv_color_t *)bg32;
+    lv_color_t * src = (lv_color_t *)src32;
+    uint32_t seed = 1;
+    uint32_t i;
+    for(i = 0; i < sizeof(bg32) / sizeof(lv_color_t); i++) {
+        seed = seed * 1103515245u + 12345u;
+        bg[i] = c->flat_bg ? lv_color_hex(0x0a0a0a) : lv_color_hex(seed >> 8);
+        src[i] = lv_color_hex(seed >> 4);
+    }
+
+    for(i = 0; i < sizeof(mask); i++) {
+        uint32_t x = i % HOR_RES;
+        uint32_t y = i / HOR_RES;
+        if(c->kind == KIND_FILL_MASK_EDGE) {
+            /*The horizontal anti-aliased edges of a rounded rectangle: a partial value per row*/
+            mask[i] = (lv_opa_t)(y * 13 + 1);
+        }
+        else {
+            /*Glyph-like: transparent and covering runs, anti-aliased edges between them*/
+            uint32_t phase = (x + y) % 12;
+            mask[i] = phase < 5 ? LV_OPA_TRANSP : phase < 9 ? LV_OPA_COVER : (lv_opa_t)(phase * 21);
+        }
+    }
+}
+
+static void run(const bench_case_t * c, bool scalar)
+{
+    lv_color_t * dest = (lv_color_t *)dest32 + c->ofs;
+    const lv_color_t * src = (const lv_color_t *)src32 + c->ofs;
+    lv_color_t color = lv_color_hex(0x00e5ff);
+
+    switch(c->kind) {
+        case KIND_FILL:
+            if(scalar) blend565_ref_fill(dest, c->w, BUF_LINES, c->stride, color, LV_OPA_COVER, NULL, 0);
+            else blend565_sw_fill(dest, c->w, BUF_LINES, c->stride, color, LV_OPA_COVER, NULL);
+            break;
+        case KIND_FILL_OPA:
+            if(scalar) blend565_ref_fill(dest, c->w, BUF_LINES, c->stride, color, LV_OPA_50, NULL, 0);
+            else blend565_sw_fill(dest, c->w, BUF_LINES, c->stride, color, LV_OPA_50, NULL);
+            break;
+        case KIND_FILL_MASK:
+        case KIND_FILL_MASK_EDGE:
+            if(scalar) blend565_ref_fill(dest, c->w, BUF_LINES, c->stride, color, LV_OPA_COVER, mask, c->w);
+            else blend565_sw_fill(dest, c->w, BUF_LINES, c->stride, color, LV_OPA_COVER, mask);
+            break;
+        case KIND_FILL_MASK_OPA:
+            if(scalar) blend565_ref_fill(dest, c->w, BUF_LINES, c->stride, color, LV_OPA_60, mask, c->w);
+            else blend565_sw_fill(dest, c->w, BUF_LINES, c->stride, color, LV_OPA_60, mask);
+            break;
+        case KIND_COPY:
+            if(scalar) blend565_ref_copy(dest, c->w, BUF_LINES, c->stride, src, c->w);
+            else blend565_sw_copy(dest, c->w, BUF_LINES, c->stride, src);
+            break;
+    }
+}
+
+static uint64_t time_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
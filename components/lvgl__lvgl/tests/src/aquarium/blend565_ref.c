@@ -0,0 +1,206 @@
+/**
+ * @file blend565_ref.c
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "blend565_ref.h"
+#include "src/draw/sw/lv_draw_sw.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define FILL_MASK_PX(color)                                                 \
+    if(*mask == LV_OPA_COVER) *dest_buf = color;                            \
+    else *dest_buf = lv_color_mix(color, *dest_buf, *mask);                 \
+    mask++;                                                                 \
+    dest_buf++;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void sw_blend(lv_color_t * dest_buf, int32_t w, int32_t h, lv_coord_t dest_stride,
+                     lv_draw_sw_blend_dsc_t * dsc);
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+void blend565_ref_fill(lv_color_t * dest_buf, int32_t w, int32_t h, lv_coord_t dest_stride, lv_color_t color,
+                       lv_opa_t opa, const lv_opa_t * mask, lv_coord_t mask_stride)
+{
+    int32_t x;
+    int32_t y;
+
+    if(mask == NULL) {
+        if(opa >= LV_OPA_MAX) {
+            for(y = 0; y < h; y++) {
+                lv_color_fill(dest_buf, color, w);
+                dest_buf += dest_stride;
+            }
+        }
+        else {
+            lv_color_t last_dest_color = lv_color_black();
+            lv_color_t last_res_color = lv_color_mix(color, last_dest_color, opa);
+
+#if LV_COLOR_MIX_ROUND_OFS == 0 && LV_COLOR_DEPTH == 16
+            opa = (uint32_t)((uint32_t)opa + 4) >> 3;
+            opa = opa << 3;
+#endif
+
+            uint16_t color_premult[3];
+            lv_color_premult(color, opa, color_premult);
+            lv_opa_t opa_inv = 255 - opa;
+
+            for(y = 0; y < h; y++) {
+                for(x = 0; x < w; x++) {
+                    if(last_dest_color.full != dest_buf[x].full) {
+                        last_dest_color = dest_buf[x];
+                        last_res_color = lv_color_mix_premult(color_premult, dest_buf[x], opa_inv);
+                    }
+                    dest_buf[x] = last_res_color;
+                }
+                dest_buf += dest_stride;
+            }
+        }
+    }
+    else if(opa >= LV_OPA_MAX) {
+        /*Aligned 4 mask bytes at once, fully covering quads written as 2 words*/
+        uint32_t c32 = color.full + ((uint32_t)color.full << 16);
+        int32_t x_end4 = w - 4;
+        for(y = 0; y < h; y++) {
+            for(x = 0; x < w && ((lv_uintptr_t)(mask) & 0x3); x++) {
+                FILL_MASK_PX(color)
+            }
+
+            for(; x <= x_end4; x += 4) {
+                uint32_t mask32 = *((uint32_t *)mask);
+                if(mask32 == 0xFFFFFFFF) {
+                    if((lv_uintptr_t)dest_buf & 0x3) {
+                        *(dest_buf + 0) = color;
+                        uint32_t * d = (uint32_t *)(dest_buf + 1);
+                        *d = c32;
+                        *(dest_buf + 3) = color;
+                    }
+                    else {
+                        uint32_t * d = (uint32_t *)dest_buf;
+                        *d = c32;
+                        *(d + 1) = c32;
+                    }
+                    dest_buf += 4;
+                    mask += 4;
+                }
+                else if(mask32) {
+                    FILL_MASK_PX(color)
+                    FILL_MASK_PX(color)
+                    FILL_MASK_PX(color)
+                    FILL_MASK_PX(color)
+                }
+                else {
+                    mask += 4;
+                    dest_buf += 4;
+                }
+            }
+
+            for(; x < w ; x++) {
+                FILL_MASK_PX(color)
+            }
+            dest_buf += (dest_stride - w);
+            mask += (mask_stride - w);
+        }
+    }
+    else {
+        lv_color_t last_dest_color;
+        lv_color_t last_res_color;
+        lv_opa_t last_mask = LV_OPA_TRANSP;
+        last_dest_color.full = dest_buf[0].full;
+        last_res_color.full = dest_buf[0].full;
+        lv_opa_t opa_tmp = LV_OPA_TRANSP;
+
+        for(y = 0; y < h; y++) {
+            for(x = 0; x < w; x++) {
+                if(mask[x]) {
+                    if(mask[x] != last_mask) opa_tmp = mask[x] == LV_OPA_COVER ? opa :
+                                                           (uint32_t)((uint32_t)(mask[x]) * opa) >> 8;
+                    if(mask[x] != last_mask || last_dest_color.full != dest_buf[x].full) {
+                        if(opa_tmp == LV_OPA_COVER) last_res_color = color;
+                        else last_res_color = lv_color_mix(color, dest_buf[x], opa_tmp);
+                        last_mask = mask[x];
+                        last_dest_color.full = dest_buf[x].full;
+                    }
+                    dest_buf[x] = last_res_color;
+                }
+            }
+            dest_buf += dest_stride;
+            mask += mask_stride;
+        }
+    }
+}
+
+void blend565_ref_copy(lv_color_t * dest_buf, int32_t w, int32_t h, lv_coord_t dest_stride,
+                       const lv_color_t * src_buf, lv_coord_t src_stride)
+{
+    int32_t y;
+    for(y = 0; y < h; y++) {
+        lv_memcpy(dest_buf, src_buf, w * sizeof(lv_color_t));
+        dest_buf += dest_stride;
+        src_buf += src_stride;
+    }
+}
+
+void blend565_sw_fill(lv_color_t * dest_buf, int32_t w, int32_t h, lv_coord_t dest_stride, lv_color_t color,
+                      lv_opa_t opa, lv_opa_t * mask)
+{
+    lv_draw_sw_blend_dsc_t dsc;
+    lv_memset_00(&dsc, sizeof(dsc));
+    dsc.color = color;
+    dsc.opa = opa;
+    dsc.mask_buf = mask;
+    dsc.mask_res = mask ? LV_DRAW_MASK_RES_CHANGED : LV_DRAW_MASK_RES_FULL_COVER;
+    sw_blend(dest_buf, w, h, dest_stride, &dsc);
+}
+
+void blend565_sw_copy(lv_color_t * dest_buf, int32_t w, int32_t h, lv_coord_t dest_stride,
+                      const lv_color_t * src_buf)
+{
+    lv_draw_sw_blend_dsc_t dsc;
+    lv_memset_00(&dsc, sizeof(dsc));
+    dsc.src_buf = src_buf;
+    dsc.opa = LV_OPA_COVER;
+    dsc.mask_res = LV_DRAW_MASK_RES_FULL_COVER;
+    sw_blend(dest_buf, w, h, dest_stride, &dsc);
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+/*`dest_buf` as the draw buffer (`dest_stride` wide), the blend area at its top left*/
+static void sw_blend(lv_color_t * dest_buf, int32_t w, int32_t h, lv_coord_t dest_stride,
+                     lv_draw_sw_blend_dsc_t * dsc)
+{
+    lv_disp_t * disp = lv_disp_get_default();
+    lv_draw_ctx_t * draw_ctx = disp->driver->draw_ctx;
+
+    void * buf_saved = draw_ctx->buf;
+    lv_area_t * buf_area_saved = draw_ctx->buf_area;
+    const lv_area_t * clip_area_saved = draw_ctx->clip_area;
+    lv_area_t buf_area = {0, 0, dest_stride - 1, h - 1};
+    lv_area_t blend_area = {0, 0, w - 1, h - 1};
+    draw_ctx->buf = dest_buf;
+    draw_ctx->buf_area = &buf_area;
+    draw_ctx->clip_area = &blend_area;
+    dsc->blend_area = &blend_area;
+    dsc->mask_area = &blend_area;
+    dsc->blend_mode = LV_BLEND_MODE_NORMAL;
+
+    _lv_refr_set_disp_refreshing(disp);
+    lv_draw_sw_blend_basic(draw_ctx, dsc);
+    _lv_refr_set_disp_refreshing(NULL);
+
+    draw_ctx->buf = buf_saved;
+    draw_ctx->buf_area = buf_area_saved;
+    draw_ctx->clip_area = clip_area_saved;
+}
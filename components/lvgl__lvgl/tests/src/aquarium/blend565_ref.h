@@ -0,0 +1,28 @@
+/**
+ * @file blend565_ref.h
+ * The scalar (one lv_color_t at a time) normal blends of lv_draw_sw_blend.c, as they were
+ * before the SWAR RGB565 kernels: the reference of test_blend565.c and blend565_bench.c.
+ * Same arguments as fill_normal() / map_normal().
+ *
+ * blend565_sw_*() do the same through lv_draw_sw_blend_basic(), i.e. with the kernels the
+ * build selected, on the default display's draw_ctx. Their mask and source are `w` wide.
+ */
+#ifndef BLEND565_REF_H
+#define BLEND565_REF_H
+
+#include "lvgl.h"
+
+void blend565_ref_fill(lv_color_t * dest_buf, int32_t w, int32_t h, lv_coord_t dest_stride, lv_color_t color,
+                       lv_opa_t opa, const lv_opa_t * mask, lv_coord_t mask_stride);
+
+/*Opaque, no mask*/
+void blend565_ref_copy(lv_color_t * dest_buf, int32_t w, int32_t h, lv_coord_t dest_stride,
+                       const lv_color_t * src_buf, lv_coord_t src_stride);
+
+void blend565_sw_fill(lv_color_t * dest_buf, int32_t w, int32_t h, lv_coord_t dest_stride, lv_color_t color,
+                      lv_opa_t opa, lv_opa_t * mask);
+
+void blend565_sw_copy(lv_color_t * dest_buf, int32_t w, int32_t h, lv_coord_t dest_stride,
+                      const lv_color_t * src_buf);
+
+#endif /*BLEND565_REF_H*/
@@ -0,0 +1,297 @@
+/**
+ * @file filter_replay.c
+ * Replays a temperature trace through the sample filter (main/aquarium_filter.c)
+ * and reports, per configuration, the false alarms it lets through against how
+ * late it reports a real excursion out of TEMP_MIN_NORMAL..TEMP_MAX_NORMAL.
+ *
+ * A trace is a CSV of "t_s,centi,truth_centi" lines ('#' lines are comments):
+ * the reading as the controller gets it, and what the water really did. A
+ * recorded trace without the truth column only gets the rejection counters.
+ * Readings outside the controller's sanity range are dropped before the
+ * filter, like ds_read_result() does. traces/gen_filter_trace.py writes the
+ * trace ctest runs.
+ *
+ * - false alarm: the output leaves the range while the water is in it (the
+ *   samples until it is back count)
+ * - latency: samples from the water leaving the range to the output doing so
+ * - missed: the water came back before the output left the range
+ *
+ * With --check, fails unless the shipped configuration (FILTER_* of
+ * aquarium_controller.h) has no false alarm and misses nothing, within
+ * FILTER_MAX_REJECTS + FILTER_MEDIAN_WINDOW / 2 samples, while the raw
+ * readings do raise false alarms (so the trace still has spikes).
+ *
+ * filter_replay TRACE.csv [--check]
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "aquarium_controller.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*********************
+ *      DEFINES
+ *********************/
+#define TEMP_SANE_MIN       500     /*aquarium_controller.c*/
+#define TEMP_SANE_MAX       5000
+#define NO_TRUTH            INT32_MIN
+#define TIMING_PASSES       50
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct {
+    int32_t t_s;
+    int16_t centi;
+    int32_t truth;
+} trace_sample_t;
+
+typedef struct {
+    const char * name;
+    bool filter;            /*false: publish the readings as they are*/
+    aquarium_filter_config_t cfg;
+} replay_config_t;
+
+typedef struct {
+    uint32_t false_samples;
+    uint32_t false_episodes;
+    uint32_t events;
+    uint32_t detected;
+    uint32_t latency_total;
+    uint32_t latency_max;
+    aquarium_filter_stats_t stats;
+    double ns_per_sample;
+} replay_result_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static int load(const char * path);
+static void replay(const replay_config_t * c, replay_result_t * res);
+static uint32_t run(const replay_config_t * c, int16_t * out, aquarium_filter_stats_t * stats);
+static bool out_of_range(int32_t centi);
+static uint64_t time_ns(void);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+#define SHIPPED {FILTER_MEDIAN_WINDOW, FILTER_PROCESS_NOISE, FILTER_MEAS_NOISE, FILTER_GATE_SIGMA, FILTER_MAX_REJECTS}
+
+static const replay_config_t configs[] = {
+    {"raw", false, SHIPPED},
+    {"median 3 only", true, {3, FILTER_PROCESS_NOISE, FILTER_MEAS_NOISE, 0, FILTER_MAX_REJECTS}},
+    {"kalman only, 4 sigma", true, {1, FILTER_PROCESS_NOISE, FILTER_MEAS_NOISE, 4, FILTER_MAX_REJECTS}},
+    {"median 3, 3 sigma", true, {3, FILTER_PROCESS_NOISE, FILTER_MEAS_NOISE, 3, FILTER_MAX_REJECTS}},
+    {"shipped", true, SHIPPED},
+    {"median 3, 6 sigma", true, {3, FILTER_PROCESS_NOISE, FILTER_MEAS_NOISE, 6, FILTER_MAX_REJECTS}},
+    {"median 5, 4 sigma", true, {5, FILTER_PROCESS_NOISE, FILTER_MEAS_NOISE, 4, FILTER_MAX_REJECTS}},
+    {"shipped, 5 rejects", true, {FILTER_MEDIAN_WINDOW, FILTER_PROCESS_NOISE, FILTER_MEAS_NOISE, FILTER_GATE_SIGMA, 5}},
+};
+
+static trace_sample_t * trace;
+static int trace_len;
+static bool has_truth;
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+int main(int argc, char ** argv)
+{
+    bool check = argc > 2 && strcmp(argv[2], "--check") == 0;
+    if(argc < 2 || (argc > 2 && !check)) {
+        fprintf(stderr, "usage: %s TRACE.csv [--check]\n", argv[0]);
+        return 2;
+    }
+    if(load(argv[1]) <= 0) {
+        fprintf(stderr, "%s: no samples\n", argv[1]);
+        return 2;
+    }
+
+    printf("# filter_replay: %s, %d samples, limits %d..%d centi-degC\n", argv[1], trace_len,
+           TEMP_MIN_NORMAL, TEMP_MAX_NORMAL);
+    printf("# %-22s %7s %7s %7s %7s %7s %7s %7s %7s\n", "config", "false", "false", "events", "missed",
+           "latency", "latency", "reject", "ns/");
+    printf("# %-22s %7s %7s %7s %7s %7s %7s %7s %7s\n", "", "samples", "runs", "", "", "avg", "max",
+           "restart", "sample");
+
+    replay_result_t raw = {0};
+    replay_result_t shipped = {0};
+    for(size_t i = 0; i < sizeof(configs) / sizeof(configs[0]); i++) {
+        const replay_config_t * c = &configs[i];
+        replay_result_t res;
+        replay(c, &res);
+        if(i == 0) raw = res;
+        if(strcmp(c->name, "shipped") == 0) shipped = res;
+
+        char rejects[24] = "-";
+        if(c->filter) snprintf(rejects, sizeof(rejects), "%lu/%lu", (unsigned long)res.stats.rejected,
+                                   (unsigned long)res.stats.restarts);
+        if(has_truth) {
+            printf("%-24s %7lu %7lu %7lu %7lu %7.1f %7lu %7s %7.1f\n", c->name, (unsigned long)res.false_samples,
+                   (unsigned long)res.false_episodes, (unsigned long)res.events,
+                   (unsigned long)(res.events - res.detected),
+                   res.detected ? (double)res.latency_total / res.detected : 0.0, (unsigned long)res.latency_max,
+                   rejects, res.ns_per_sample);
+        }
+        else {
+            printf("%-24s %7s %7s %7s %7s %7s %7s %7s %7.1f\n", c->name, "-", "-", "-", "-", "-", "-", rejects,
+                   res.ns_per_sample);
+        }
+    }
+
+    if(!check) return 0;
+    if(!has_truth) {
+        fprintf(stderr, "--check needs the truth column\n");
+        return 1;
+    }
+    const uint32_t max_latency = FILTER_MAX_REJECTS + FILTER_MEDIAN_WINDOW / 2;
+    int fail = 0;
+    if(raw.false_samples == 0) {
+        fprintf(stderr, "check: the raw readings raise no false alarm, the trace lost its spikes\n");
+        fail = 1;
+    }
+    if(shipped.events == 0) {
+        fprintf(stderr, "check: the trace has no excursion\n");
+        fail = 1;
+    }
+    if(shipped.false_samples > 0) {
+        fprintf(stderr, "check: %lu false alarm samples\n", (unsigned long)shipped.false_samples);
+        fail = 1;
+    }
+    if(shipped.detected != shipped.events) {
+        fprintf(stderr, "check: %lu excursions missed\n", (unsigned long)(shipped.events - shipped.detected));
+        fail = 1;
+    }
+    if(shipped.latency_max > max_latency) {
+        fprintf(stderr, "check: reported %lu samples late, budget %lu\n", (unsigned long)shipped.latency_max,
+                (unsigned long)max_latency);
+        fail = 1;
+    }
+    return fail;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static int load(const char * path)
+{
+    FILE * f = fopen(path, "r");
+    if(f == NULL) return -1;
+
+    int cap = 0;
+    char line[128];
+    has_truth = true;
+    while(fgets(line, sizeof(line), f)) {
+        if(line[0] == '#' || line[0] == '\n') continue;
+        long t, centi, truth;
+        int fields = sscanf(line, "%ld,%ld,%ld", &t, &centi, &truth);
+        if(fields < 2) continue;
+        if(trace_len == cap) {
+            cap = cap ? cap * 2 : 1024;
+            trace = realloc(trace, (size_t)cap * sizeof(trace[0]));
+            if(trace == NULL) {
+                fclose(f);
+                return -1;
+            }
+        }
+        trace[trace_len].t_s = (int32_t)t;
+        trace[trace_len].centi = (int16_t)centi;
+        trace[trace_len].truth = fields == 3 ? (int32_t)truth : NO_TRUTH;
+        if(fields < 3) has_truth = false;
+        trace_len++;
+    }
+    fclose(f);
+    return trace_len;
+}
+
+static void replay(const replay_config_t * c, replay_result_t * res)
+{
+    memset(res, 0, sizeof(*res));
+    int16_t * out = malloc((size_t)trace_len * sizeof(int16_t));
+    uint32_t fed = run(c, out, &res->stats);
+
+    uint64_t start = time_ns();
+    for(int pass = 0; pass < TIMING_PASSES; pass++) {
+        aquarium_filter_stats_t stats;
+        run(c, out, &stats);
+    }
+    res->ns_per_sample = (double)(time_ns() - start) / ((double)fed * TIMING_PASSES);
+
+    if(has_truth) {
+        bool was_out = false;
+        bool false_run = false;
+        bool in_event = false;
+        bool reported = false;
+        uint32_t since = 0;
+        for(int i = 0; i < trace_len; i++) {
+            bool truth_out = out_of_range(trace[i].truth);
+            bool output_out = out_of_range(out[i]);
+
+            /*An alarm that starts while the water is in range; the tail of a
+             *real one (the output coming back late) is not false*/
+            if(output_out && !was_out) {
+                false_run = !truth_out;
+                if(false_run) res->false_episodes++;
+            }
+            if(output_out && false_run) res->false_samples++;
+            was_out = output_out;
+
+            if(truth_out && !in_event) {
+                res->events++;
+                in_event = true;
+                reported = false;
+                since = 0;
+            }
+            if(!truth_out) in_event = false;
+            if(in_event && !reported) {
+                if(output_out) {
+                    reported = true;
+                    res->detected++;
+                    res->latency_total += since;
+                    if(since > res->latency_max) res->latency_max = since;
+                }
+                since++;
+            }
+        }
+    }
+    free(out);
+}
+
+/*The filter over the whole trace; out[i] is what is published after sample i.
+ *Returns the number of readings fed.*/
+static uint32_t run(const replay_config_t * c, int16_t * out, aquarium_filter_stats_t * stats)
+{
+    aquarium_filter_t f;
+    aquarium_filter_init(&f, &c->cfg);
+    int16_t last = trace[0].centi;
+    uint32_t fed = 0;
+    for(int i = 0; i < trace_len; i++) {
+        int16_t z = trace[i].centi;
+        if(z >= TEMP_SANE_MIN && z <= TEMP_SANE_MAX) {
+            fed++;
+            if(c->filter) aquarium_filter_update(&f, z, &last);
+            else last = z;
+        }
+        out[i] = last;
+    }
+    *stats = f.stats;
+    return fed;
+}
+
+static bool out_of_range(int32_t centi)
+{
+    return centi < TEMP_MIN_NORMAL || centi > TEMP_MAX_NORMAL;
+}
+
+static uint64_t time_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
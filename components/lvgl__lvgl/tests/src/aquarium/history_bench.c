@@ -0,0 +1,144 @@
+/**
+ * @file history_bench.c
+ * Micro-benchmark of the delta-encoded history (main/aquarium_history.c):
+ * host CPU time per append and per query on a full 64 KB ring, and the
+ * bytes per sample each kind of water costs (so the days it covers).
+ *
+ * Flat water is mostly zero-delta runs; a noisy one changes every sample
+ * by a few 12-bit steps. Queries run at the newest end, where the UI and
+ * Matter ask, and over the whole ring (the worst case under the lock).
+ * Host timings only show the trend.
+ *
+ * history_bench [ROUNDS]
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "aquarium_history.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*********************
+ *      DEFINES
+ *********************/
+#define ROUNDS          10
+#define SLOT_US         5000000LL
+#define APPENDS         200000  /*Enough to wrap the ring with either kind*/
+#define QUERIES         200
+#define HOUR_US         (3600LL * 1000000)
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct {
+    const char * name;
+    int noise;          /*Step in centi-degC: 0 = flat with the odd LSB*/
+} bench_case_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static int64_t fill(const bench_case_t * c);
+static uint64_t time_ns(void);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static const bench_case_t cases[] = {
+    {"flat", 0},
+    {"noisy (+-3 LSB)", 3},
+};
+
+static aquarium_history_t hist;
+static aquarium_history_point_t out[4096];
+static volatile int32_t sink;
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+int main(int argc, char ** argv)
+{
+    uint32_t rounds = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 10) : ROUNDS;
+    if(rounds == 0) {
+        fprintf(stderr, "usage: %s [ROUNDS]\n", argv[0]);
+        return 2;
+    }
+
+    printf("# history_bench: %d x %d byte blocks, %u rounds\n", HISTORY_BLOCK_COUNT,
+           (int)sizeof(history_block_t), (unsigned)rounds);
+    printf("# %-18s %8s %8s %8s %10s %10s %10s %10s\n", "case", "B/sample", "days", "append",
+           "last 100", "range 1h", "window 1h", "window all");
+    printf("# %-18s %8s %8s %8s %10s %10s %10s %10s\n", "", "", "", "ns", "us", "us", "us", "us");
+
+    for(size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        const bench_case_t * c = &cases[i];
+        uint64_t append_ns = 0;
+        uint64_t query_ns[4] = {0};
+        int64_t now = 0;
+        for(uint32_t r = 0; r < rounds; r++) {
+            uint64_t start = time_ns();
+            now = fill(c);
+            append_ns += time_ns() - start;
+
+            aquarium_history_window_t win;
+            start = time_ns();
+            for(int q = 0; q < QUERIES; q++) sink += aquarium_history_last(&hist, 100, out);
+            query_ns[0] += time_ns() - start;
+            start = time_ns();
+            for(int q = 0; q < QUERIES; q++) {
+                sink += aquarium_history_range(&hist, now - HOUR_US, now, out, sizeof(out) / sizeof(out[0]));
+            }
+            query_ns[1] += time_ns() - start;
+            start = time_ns();
+            for(int q = 0; q < QUERIES; q++) sink += aquarium_history_window(&hist, now - HOUR_US, now, &win);
+            query_ns[2] += time_ns() - start;
+            start = time_ns();
+            for(int q = 0; q < QUERIES; q++) sink += aquarium_history_window(&hist, INT64_MIN, INT64_MAX, &win);
+            query_ns[3] += time_ns() - start;
+        }
+
+        aquarium_history_info_t info;
+        aquarium_history_get_info(&hist, &info);
+        double queries = (double)QUERIES * rounds * 1000;
+        printf("%-20s %8.2f %8.1f %8.1f %10.2f %10.2f %10.2f %10.2f\n", c->name,
+               (double)info.bytes / info.samples,
+               (double)(info.newest_us - info.oldest_us) / (24 * HOUR_US),
+               (double)append_ns / ((double)APPENDS * rounds),
+               query_ns[0] / queries, query_ns[1] / queries, query_ns[2] / queries, query_ns[3] / queries);
+    }
+
+    return 0;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+/*A fresh ring filled at the controller's 5 s slots, with wake-up jitter.
+ *Returns the time of the last sample.*/
+static int64_t fill(const bench_case_t * c)
+{
+    aquarium_history_init(&hist);
+    uint32_t seed = 1;
+    int64_t t = 0;
+    int16_t v = 2500;
+    for(int i = 0; i < APPENDS; i++) {
+        seed = seed * 1103515245u + 12345u;
+        uint32_t r = seed >> 8;
+        if(c->noise) v = (int16_t)(2500 + ((int)(r % (2 * c->noise + 1)) - c->noise) * 6);
+        else if(r % 97 == 0) v += (r & 256) ? 6 : -6;
+        t = (int64_t)i * SLOT_US;
+        aquarium_history_append(&hist, t + (int64_t)(r % 20000), v);
+    }
+    return t;
+}
+
+static uint64_t time_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
@@ -0,0 +1,15 @@
+/**
+ * @file LVGL_Driver.h
+ * Host stand-in for main/LVGL_Driver/LVGL_Driver.h: the bench runs LVGL in one thread.
+ */
+
+#ifndef LVGL_DRIVER_H
+#define LVGL_DRIVER_H
+
+#include <stdbool.h>
+
+bool LVGL_Lock(int timeout_ms);
+void LVGL_Unlock(void);
+void LVGL_Wake(void);
+
+#endif /*LVGL_DRIVER_H*/
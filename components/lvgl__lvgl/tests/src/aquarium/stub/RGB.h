@@ -0,0 +1,13 @@
+/**
+ * @file RGB.h
+ * Host stand-in for main/RGB/RGB.h: Set_RGB() is recorded by aquarium_host.c.
+ */
+
+#ifndef __RGB_H
+#define __RGB_H
+
+#include <stdint.h>
+
+void Set_RGB(uint8_t red_val, uint8_t green_val, uint8_t blue_val);
+
+#endif
@@ -0,0 +1,22 @@
+/**
+ * @file gpio.h
+ * Host stand-in for driver/gpio.h: pin numbers only, there are no pins.
+ */
+
+#ifndef DRIVER_GPIO_H
+#define DRIVER_GPIO_H
+
+typedef enum {
+    GPIO_NUM_NC = -1,
+    GPIO_NUM_0 = 0,
+    GPIO_NUM_1,
+    GPIO_NUM_2,
+    GPIO_NUM_3,
+    GPIO_NUM_4,
+    GPIO_NUM_5,
+    GPIO_NUM_6,
+    GPIO_NUM_7,
+    GPIO_NUM_8,
+} gpio_num_t;
+
+#endif /*DRIVER_GPIO_H*/
@@ -0,0 +1,21 @@
+/**
+ * @file esp_log.h
+ * Host stand-in for the ESP-IDF logger: messages are dropped (the arguments
+ * are still evaluated, so nothing is left unused).
+ */
+
+#ifndef ESP_LOG_H
+#define ESP_LOG_H
+
+static inline void esp_log_drop(const char * tag, const char * format, ...)
+{
+    (void)tag;
+    (void)format;
+}
+
+#define ESP_LOGE(tag, ...) esp_log_drop(tag, __VA_ARGS__)
+#define ESP_LOGW(tag, ...) esp_log_drop(tag, __VA_ARGS__)
+#define ESP_LOGI(tag, ...) esp_log_drop(tag, __VA_ARGS__)
+#define ESP_LOGD(tag, ...) esp_log_drop(tag, __VA_ARGS__)
+
+#endif /*ESP_LOG_H*/
@@ -0,0 +1,27 @@
+/**
+ * @file esp_timer.h
+ * Host stand-in for esp_timer: the clock and the one-shot timers are the
+ * fake ones of aquarium_host.c, moved by the test.
+ */
+
+#ifndef ESP_TIMER_H
+#define ESP_TIMER_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef struct esp_timer * esp_timer_handle_t;
+typedef void (*esp_timer_cb_t)(void * arg);
+
+typedef struct {
+    esp_timer_cb_t callback;
+    void * arg;
+    const char * name;
+} esp_timer_create_args_t;
+
+int64_t esp_timer_get_time(void);
+esp_err_t esp_timer_create(const esp_timer_create_args_t * args, esp_timer_handle_t * out_handle);
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us);
+esp_err_t esp_timer_stop(esp_timer_handle_t timer);
+
+#endif /*ESP_TIMER_H*/
@@ -0,0 +1,39 @@
+/**
+ * @file FreeRTOS.h
+ * Host stand-in for FreeRTOS: types, and critical sections as a spin lock
+ * (host tests may run the code from several threads).
+ */
+
+#ifndef INC_FREERTOS_H
+#define INC_FREERTOS_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE         0
+#define pdTRUE          1
+#define pdPASS          pdTRUE
+#define portMAX_DELAY   ((TickType_t)0xFFFFFFFFu)
+
+typedef atomic_int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED 0
+
+static inline void vPortEnterCritical(portMUX_TYPE * mux)
+{
+    int expected = 0;
+    while(!atomic_compare_exchange_weak(mux, &expected, 1)) expected = 0;
+}
+
+static inline void vPortExitCritical(portMUX_TYPE * mux)
+{
+    atomic_store(mux, 0);
+}
+
+#define taskENTER_CRITICAL(mux) vPortEnterCritical(mux)
+#define taskEXIT_CRITICAL(mux)  vPortExitCritical(mux)
+
+#endif /*INC_FREERTOS_H*/
@@ -0,0 +1,42 @@
+/**
+ * @file task.h
+ * Host stand-in for FreeRTOS tasks: nothing is scheduled, a test calls the
+ * task's work directly on its own clock.
+ */
+
+#ifndef INC_TASK_H
+#define INC_TASK_H
+
+#include <stddef.h>
+#include "FreeRTOS.h"
+
+typedef void * TaskHandle_t;
+typedef void (*TaskFunction_t)(void * arg);
+
+static inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char * name, uint32_t stack, void * arg,
+                                                 UBaseType_t prio, TaskHandle_t * handle, BaseType_t core)
+{
+    (void)fn;
+    (void)name;
+    (void)stack;
+    (void)arg;
+    (void)prio;
+    (void)core;
+    *handle = NULL;
+    return pdPASS;
+}
+
+static inline BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    (void)task;
+    return pdPASS;
+}
+
+static inline uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t wait)
+{
+    (void)clear;
+    (void)wait;
+    return 1;
+}
+
+#endif /*INC_TASK_H*/
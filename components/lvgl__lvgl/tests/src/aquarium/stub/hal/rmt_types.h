@@ -0,0 +1,21 @@
+/**
+ * @file rmt_types.h
+ * Host stand-in for hal/rmt_types.h: the RMT symbol word (same layout).
+ */
+
+#ifndef HAL_RMT_TYPES_H
+#define HAL_RMT_TYPES_H
+
+#include <stdint.h>
+
+typedef union {
+    struct {
+        unsigned int duration0 : 15;
+        unsigned int level0 : 1;
+        unsigned int duration1 : 15;
+        unsigned int level1 : 1;
+    };
+    uint32_t val;
+} rmt_symbol_word_t;
+
+#endif /*HAL_RMT_TYPES_H*/
@@ -0,0 +1,13 @@
+/**
+ * @file sdkconfig.h
+ * Host stand-in for the generated sdkconfig.h: the options main/ reads.
+ */
+
+#ifndef SDKCONFIG_H
+#define SDKCONFIG_H
+
+#define CONFIG_PM_ENABLE                    0
+#define CONFIG_FREERTOS_USE_TICKLESS_IDLE   0
+#define CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ     160
+
+#endif /*SDKCONFIG_H*/
@@ -0,0 +1,254 @@
+/**
+ * @file test_aquarium_alarm.c
+ * Alarm mode of main/aquarium_controller.c (built with AQUARIUM_ALARM_MODE=1)
+ * with two probes on the simulated bus, which keeps TH/TL, the EEPROM and
+ * the alarm flag like a DS18B20:
+ * - no quiet slot and no alarm before the first valid read,
+ * - quiet slots (Convert T + Alarm Search, nothing read or published) until
+ *   the heartbeat,
+ * - an alarm is read every slot while it lasts and clears one full read
+ *   later, at the whole-degree limits TH/TL hold,
+ * - a bus that drops fails the sample (never a quiet one) and recovers by a
+ *   new search,
+ * - a power-cycled probe gets its limits back instead of alarming on the
+ *   EEPROM's.
+ */
+#if LV_BUILD_TEST
+#include "aquarium_controller_harness.c"
+
+#include "unity/unity.h"
+
+#if !AQUARIUM_ALARM_MODE
+#error "build with AQUARIUM_ALARM_MODE=1"
+#endif
+
+/*********************
+ *      DEFINES
+ *********************/
+#define SLOT_US             ((int64_t)TEMP_UPDATE_INTERVAL_MS * 1000)
+#define HEARTBEAT_SLOTS     (ALARM_HEARTBEAT_MS / TEMP_UPDATE_INTERVAL_MS)
+#define SCRATCHPAD_BITS     (DS18B20_SCRATCHPAD_LEN * 8)
+
+/*1/16 degC. TL = 22, TH = 28 (whole degrees): 23.25 is inside and near
+ *enough a limit to keep the 5 s interval and 12 bits*/
+#define RAW_NEAR_LIMIT      (23 * 16 + 4)
+#define RAW_TH              (28 * 16)       /*28.0: alarm*/
+#define RAW_BELOW_TH        (28 * 16 - 1)   /*27.9375: none*/
+#define RAW_ABOVE_TL        (23 * 16)       /*23.0: none*/
+#define RAW_TL              (23 * 16 - 1)   /*22.9375: alarm*/
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void set_probes(int16_t raw);
+static void set_present(bool present);
+static void first_sample(void);
+static int slots_until_quiet(int max);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static onewire_bus_t * bus;
+static ds_reader_t reader;
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+void setUp(void)
+{
+    TEST_ASSERT_EQUAL(ESP_OK, onewire_new_sim_bus(&bus));
+    onewire_sim_add_ds18b20(bus, 0x300001);
+    onewire_sim_add_ds18b20(bus, 0x300002);
+    set_probes(RAW_NEAR_LIMIT);
+    harness_start(bus, &reader);
+}
+
+void tearDown(void)
+{
+    onewire_del_bus(bus);
+}
+
+void test_no_alarm_before_the_first_valid_read(void)
+{
+    /*Nobody on the bus: failed samples, never quiet ones*/
+    set_present(false);
+    set_probes(RAW_TH + 16);
+    for(int i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL(DS_RESULT_FAILED, harness_sample(&reader, 0));
+        TEST_ASSERT_TRUE(reader.rescan);
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, g_sched_stats.quiet_slots);
+    TEST_ASSERT_EQUAL_UINT32(0, g_sched_stats.alarm_slots);
+    TEST_ASSERT_EQUAL_UINT32(0, aquarium_host_get_calls()->matter_temps);
+    TEST_ASSERT_EQUAL_UINT32(0, aquarium_host_get_calls()->ui_notifies);
+    TEST_ASSERT_FALSE(aquarium_get_sample(AQUARIUM_PRIMARY_SENSOR, &(aquarium_sample_t) {0}));
+
+    /*Probes out of range from the start: the first sample is a plain full
+     *read (the alarm flags are not even set yet), the alarm comes after*/
+    set_present(true);
+    TEST_ASSERT_FALSE(onewire_sim_get_alarm(bus, 0));
+    TEST_ASSERT_EQUAL(DS_RESULT_OK, harness_sample(&reader, 0));
+    TEST_ASSERT_EQUAL_UINT32(3, reader.read_mask);
+    TEST_ASSERT_EQUAL_UINT32(0, g_sched_stats.alarm_slots);
+    TEST_ASSERT_EQUAL_UINT32(1, g_sched_stats.full_reads);
+    TEST_ASSERT_EQUAL_UINT32(1, aquarium_host_get_calls()->matter_temps);
+    TEST_ASSERT_EQUAL_UINT32(1, aquarium_host_get_calls()->ui_notifies);
+
+    TEST_ASSERT_EQUAL(DS_RESULT_OK, harness_sample(&reader, 0));
+    TEST_ASSERT_EQUAL_UINT32(1, g_sched_stats.alarm_slots);
+    TEST_ASSERT_EQUAL_UINT32(0, g_sched_stats.quiet_slots);
+}
+
+void test_quiet_slots_until_the_heartbeat(void)
+{
+    first_sample();
+    uint32_t notifies = aquarium_host_get_calls()->ui_notifies;
+    uint32_t matter = aquarium_host_get_calls()->matter_temps;
+
+    for(int k = 1; k < HEARTBEAT_SLOTS; k++) {
+        onewire_sim_reset_stats(bus);
+        TEST_ASSERT_EQUAL(DS_RESULT_QUIET, harness_sample(&reader, 0));
+        TEST_ASSERT_EQUAL_INT64(HARNESS_T0_US + k * SLOT_US, reader.slot_us);
+        /*Convert T and a search that ends at its first step: no scratchpad*/
+        TEST_ASSERT_LESS_THAN_UINT32(SCRATCHPAD_BITS, onewire_sim_get_stats(bus)->bits_read);
+        TEST_ASSERT_EQUAL_UINT32(1, onewire_sim_get_stats(bus)->conversions / 2);
+    }
+    TEST_ASSERT_EQUAL_UINT32(notifies, aquarium_host_get_calls()->ui_notifies);
+    TEST_ASSERT_EQUAL_UINT32(matter, aquarium_host_get_calls()->matter_temps);
+    TEST_ASSERT_EQUAL_UINT32(HEARTBEAT_SLOTS - 1, g_sched_stats.quiet_slots);
+
+    /*Heartbeat: a full read and a publication*/
+    TEST_ASSERT_EQUAL(DS_RESULT_OK, harness_sample(&reader, 0));
+    TEST_ASSERT_EQUAL_INT64(HARNESS_T0_US + HEARTBEAT_SLOTS * SLOT_US, reader.slot_us);
+    TEST_ASSERT_EQUAL_UINT32(3, reader.read_mask);
+    TEST_ASSERT_EQUAL_UINT32(notifies + 1, aquarium_host_get_calls()->ui_notifies);
+    TEST_ASSERT_EQUAL_UINT32(2, g_sched_stats.full_reads);
+    TEST_ASSERT_EQUAL(DS_RESULT_QUIET, harness_sample(&reader, 0));
+}
+
+void test_alarm_is_read_every_slot_until_it_clears(void)
+{
+    first_sample();
+    TEST_ASSERT_EQUAL(DS_RESULT_QUIET, harness_sample(&reader, 0));
+
+    /*One probe reaches TH: every slot reads, alternating Alarm Search slots
+     *and the full read that follows each*/
+    onewire_sim_set_temperature(bus, 1, RAW_TH);
+    for(int k = 0; k < 6; k++) {
+        TEST_ASSERT_EQUAL(DS_RESULT_OK, harness_sample(&reader, 0));
+        TEST_ASSERT_EQUAL_UINT32(3, reader.read_mask);
+    }
+    TEST_ASSERT_EQUAL_UINT32(3, g_sched_stats.alarm_slots);
+
+    /*Back under TH (the integer part is compared): one more full read at
+     *most, then quiet again*/
+    onewire_sim_set_temperature(bus, 1, RAW_BELOW_TH);
+    TEST_ASSERT_LESS_OR_EQUAL(2, slots_until_quiet(4));
+    uint32_t alarms = g_sched_stats.alarm_slots;
+
+    /*The low side: 23.0 is inside, 22.9375 is out*/
+    onewire_sim_set_temperature(bus, 0, RAW_ABOVE_TL);
+    TEST_ASSERT_EQUAL(DS_RESULT_QUIET, harness_sample(&reader, 0));
+    onewire_sim_set_temperature(bus, 0, RAW_TL);
+    TEST_ASSERT_EQUAL(DS_RESULT_OK, harness_sample(&reader, 0));
+    TEST_ASSERT_EQUAL_UINT32(alarms + 1, g_sched_stats.alarm_slots);
+    onewire_sim_set_temperature(bus, 0, RAW_NEAR_LIMIT);
+    TEST_ASSERT_LESS_OR_EQUAL(2, slots_until_quiet(4));
+}
+
+void test_bus_loss_fails_the_sample_and_recovers(void)
+{
+    first_sample();
+    TEST_ASSERT_EQUAL(DS_RESULT_QUIET, harness_sample(&reader, 0));
+
+    /*No presence for Convert T: retried, then failed, never quiet*/
+    uint32_t quiet = g_sched_stats.quiet_slots;
+    set_present(false);
+    TEST_ASSERT_EQUAL(DS_RESULT_FAILED, harness_sample(&reader, 0));
+    TEST_ASSERT_TRUE(reader.rescan);
+    TEST_ASSERT_EQUAL_UINT32(quiet, g_sched_stats.quiet_slots);
+
+    /*Back: a new search and a full read, then quiet slots again*/
+    set_present(true);
+    uint32_t full = g_sched_stats.full_reads;
+    TEST_ASSERT_EQUAL(DS_RESULT_OK, harness_sample(&reader, 0));
+    TEST_ASSERT_EQUAL_UINT32(3, reader.read_mask);
+    TEST_ASSERT_FALSE(reader.rescan);
+    TEST_ASSERT_EQUAL_UINT32(full + 1, g_sched_stats.full_reads);
+    TEST_ASSERT_EQUAL(DS_RESULT_QUIET, harness_sample(&reader, 0));
+}
+
+void test_lost_probe_is_noticed_at_the_heartbeat(void)
+{
+    first_sample();
+    int gone = harness_sensor_of(bus, 1);
+    onewire_sim_set_present(bus, 1, false);
+
+    /*A silent probe cannot flag an alarm: the others keep the slots quiet*/
+    for(int k = 1; k < HEARTBEAT_SLOTS; k++) {
+        TEST_ASSERT_EQUAL(DS_RESULT_QUIET, harness_sample(&reader, 0));
+    }
+    /*The heartbeat reads what it can*/
+    TEST_ASSERT_EQUAL(DS_RESULT_OK, harness_sample(&reader, 0));
+    TEST_ASSERT_EQUAL_UINT32(3u & ~(1u << gone), reader.read_mask);
+}
+
+void test_power_cycled_probe_gets_its_limits_back(void)
+{
+    first_sample();
+    TEST_ASSERT_EQUAL(DS_RESULT_QUIET, harness_sample(&reader, 0));
+
+    /*Brown-out: TH/TL are the EEPROM's again (75/70 degC), 23.25 alarms.
+     *The resolution is the same 12 bits, so only TH/TL tell.*/
+    onewire_sim_power_cycle(bus, 0);
+    TEST_ASSERT_EQUAL(DS_RESULT_OK, harness_sample(&reader, 0));
+    TEST_ASSERT_EQUAL_UINT32(3, reader.read_mask);
+    TEST_ASSERT_EQUAL_UINT32(1, g_sched_stats.alarm_slots);
+    TEST_ASSERT_GREATER_THAN(0, reader.attempt);   /*Rewritten, converted again*/
+
+    /*The pending full read, then quiet for good*/
+    TEST_ASSERT_LESS_OR_EQUAL(2, slots_until_quiet(4));
+    TEST_ASSERT_FALSE(onewire_sim_get_alarm(bus, 0));
+    for(int k = 0; k < 6; k++) {
+        TEST_ASSERT_EQUAL(DS_RESULT_QUIET, harness_sample(&reader, 0));
+    }
+    TEST_ASSERT_EQUAL_UINT32(1, g_sched_stats.alarm_slots);
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static void set_probes(int16_t raw)
+{
+    onewire_sim_set_temperature(bus, 0, raw);
+    onewire_sim_set_temperature(bus, 1, raw);
+}
+
+static void set_present(bool present)
+{
+    onewire_sim_set_present(bus, 0, present);
+    onewire_sim_set_present(bus, 1, present);
+}
+
+/*Search, write the resolution and the limits, read both*/
+static void first_sample(void)
+{
+    TEST_ASSERT_EQUAL(DS_RESULT_OK, harness_sample(&reader, 0));
+    TEST_ASSERT_EQUAL_UINT32(3, reader.read_mask);
+    TEST_ASSERT_EQUAL(DS18B20_RESOLUTION_MAX, reader.resolution);
+}
+
+/*Samples up to the first quiet one (included), -1 if none within max*/
+static int slots_until_quiet(int max)
+{
+    for(int k = 1; k <= max; k++) {
+        ds_result_t res = harness_sample(&reader, 0);
+        TEST_ASSERT_NOT_EQUAL(DS_RESULT_FAILED, res);
+        if(res == DS_RESULT_QUIET) return k;
+    }
+    return -1;
+}
+
+#endif
@@ -0,0 +1,242 @@
+/**
+ * @file test_aquarium_concurrency.c
+ * What other tasks read while the aquarium task writes, with real threads
+ * (the critical sections of stub/freertos/FreeRTOS.h are a spin lock):
+ * - the sample seqlock (main/aquarium_sample.c) never hands out a record
+ *   mixing two publications,
+ * - the statistics getters of main/aquarium_controller.c never return a
+ *   set caught half way through a wake-up.
+ * Readers count what they saw wrong; the test thread asserts after join.
+ */
+#if LV_BUILD_TEST
+#include "aquarium_controller_harness.c"
+#include <pthread.h>
+
+#include "unity/unity.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define READERS             3
+#define PUBLICATIONS        200000
+#define STATS_SAMPLES       10000
+#define LATENCY_US          1000    /*Every timer wake-up, so every slot's jitter but the first*/
+
+/*1/16 degC, see test_aquarium_controller.c: fixed 5 s interval*/
+#define RAW_NEAR_LIMIT      (23 * 16 + 4)
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct {
+    uint32_t reads;
+    uint32_t torn;          /*Fields from different publications*/
+    uint32_t backwards;     /*Older than a record read before*/
+} reader_result_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void * sample_writer(void * arg);
+static void * sample_reader(void * arg);
+static void * stats_reader(void * arg);
+static void run_readers(void * (*reader)(void *), reader_result_t * results);
+static void make_record(uint32_t n, aquarium_sample_t * s);
+static bool same_record(const aquarium_sample_t * s, uint32_t n);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static aquarium_sample_slot_t slot;
+static atomic_bool writer_done;
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+void setUp(void)
+{
+    memset(&slot, 0, sizeof(slot));
+    atomic_store(&writer_done, false);
+}
+
+void tearDown(void)
+{
+}
+
+void test_sample_reader_never_sees_a_mixed_record(void)
+{
+    pthread_t writer;
+    reader_result_t results[READERS];
+    TEST_ASSERT_EQUAL(0, pthread_create(&writer, NULL, sample_writer, NULL));
+    run_readers(sample_reader, results);
+    pthread_join(writer, NULL);
+
+    uint32_t reads = 0;
+    for(int i = 0; i < READERS; i++) {
+        TEST_ASSERT_EQUAL_UINT32(0, results[i].torn);
+        TEST_ASSERT_EQUAL_UINT32(0, results[i].backwards);
+        reads += results[i].reads;
+    }
+    TEST_ASSERT_GREATER_THAN_UINT32(0, reads);
+
+    aquarium_sample_t last;
+    TEST_ASSERT_EQUAL_UINT32(PUBLICATIONS, aquarium_sample_read(&slot, &last));
+    TEST_ASSERT_EQUAL_UINT32(PUBLICATIONS, last.seq);
+}
+
+void test_stats_getters_never_see_a_partial_update(void)
+{
+    onewire_bus_t * bus;
+    ds_reader_t reader;
+    TEST_ASSERT_EQUAL(ESP_OK, onewire_new_sim_bus(&bus));
+    onewire_sim_set_temperature(bus, onewire_sim_add_ds18b20(bus, 0x200001), RAW_NEAR_LIMIT);
+    onewire_sim_set_temperature(bus, onewire_sim_add_ds18b20(bus, 0x200002), RAW_NEAR_LIMIT);
+    harness_start(bus, &reader);
+
+    /*This thread is the aquarium task: the fake clock is only touched here*/
+    pthread_t threads[READERS];
+    reader_result_t results[READERS];
+    memset(results, 0, sizeof(results));
+    for(int i = 0; i < READERS; i++) {
+        TEST_ASSERT_EQUAL(0, pthread_create(&threads[i], NULL, stats_reader, &results[i]));
+    }
+    int ok = 0;
+    for(int i = 0; i < STATS_SAMPLES; i++) {
+        if(harness_sample(&reader, LATENCY_US) == DS_RESULT_OK) ok++;
+    }
+    atomic_store(&writer_done, true);
+    for(int i = 0; i < READERS; i++) pthread_join(threads[i], NULL);
+    onewire_del_bus(bus);
+
+    TEST_ASSERT_EQUAL(STATS_SAMPLES, ok);
+    for(int i = 0; i < READERS; i++) {
+        TEST_ASSERT_EQUAL_UINT32(0, results[i].torn);
+        TEST_ASSERT_EQUAL_UINT32(0, results[i].backwards);
+        TEST_ASSERT_GREATER_THAN_UINT32(0, results[i].reads);
+    }
+
+    /*The last wake-up's copy is the task's own view*/
+    aquarium_sched_stats_t sched;
+    aquarium_conversion_stats_t conv;
+    aquarium_get_sched_stats(&sched);
+    aquarium_get_conversion_stats(&conv);
+    TEST_ASSERT_EQUAL_UINT32(STATS_SAMPLES, sched.slots);
+    TEST_ASSERT_EQUAL_UINT32(g_sched_stats.full_reads, sched.full_reads);
+    TEST_ASSERT_EQUAL_UINT64(g_sched_stats.jitter_total_us, sched.jitter_total_us);
+    TEST_ASSERT_EQUAL_UINT32(STATS_SAMPLES, conv.samples);
+    TEST_ASSERT_EQUAL_UINT64(g_conv_stats.conversion_ms_total, conv.conversion_ms_total);
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static void * sample_writer(void * arg)
+{
+    (void)arg;
+    aquarium_sample_t s;
+    for(uint32_t n = 1; n <= PUBLICATIONS; n++) {
+        make_record(n, &s);
+        aquarium_sample_publish(&slot, &s);
+    }
+    atomic_store(&writer_done, true);
+    return NULL;
+}
+
+static void * sample_reader(void * arg)
+{
+    reader_result_t * res = arg;
+    uint32_t last = 0;
+    bool done;
+    do {
+        done = atomic_load(&writer_done);
+        aquarium_sample_t s;
+        uint32_t seq = aquarium_sample_read(&slot, &s);
+        res->reads++;
+        if(seq == 0) continue;
+
+        /*Every field is derived from the publication number*/
+        if(!same_record(&s, seq)) res->torn++;
+        if(seq < last) res->backwards++;
+        last = seq;
+    } while(!done);
+    return NULL;
+}
+
+/*Invariants that hold after every wake-up, not in the middle of one*/
+static void * stats_reader(void * arg)
+{
+    reader_result_t * res = arg;
+    const uint32_t conv_12bit_ms = ds18b20_conversion_time_ms(DS18B20_RESOLUTION_MAX);
+    uint32_t last_slots = 0;
+    bool done;
+    do {
+        done = atomic_load(&writer_done);
+        aquarium_sched_stats_t sched;
+        aquarium_conversion_stats_t conv;
+        aquarium_filter_stats_t filter;
+        aquarium_get_sched_stats(&sched);
+        aquarium_get_conversion_stats(&conv);
+        res->reads++;
+
+        /*The first slot starts at once, without the timer*/
+        if(sched.slots && sched.jitter_total_us != (uint64_t)(sched.slots - 1) * LATENCY_US) res->torn++;
+        if(sched.slots > 1 && (sched.jitter_last_us != LATENCY_US || sched.jitter_max_us != LATENCY_US)) res->torn++;
+        if(sched.full_reads > sched.slots) res->torn++;
+        if(sched.slots < last_slots) res->backwards++;
+        last_slots = sched.slots;
+
+        uint32_t at_bits = 0;
+        for(int b = 0; b < 4; b++) at_bits += conv.samples_at_bits[b];
+        if(at_bits != conv.samples) res->torn++;
+        if(conv.conversion_ms_total + conv.conversion_ms_saved != (uint64_t)conv.samples * conv_12bit_ms) res->torn++;
+
+        /*Counted when the scratchpad reads start and when they end, in the
+         *same wake-up: every full read of a copy is also a sample of any
+         *later copy (sched is read first)*/
+        if(sched.full_reads > conv.samples) res->torn++;
+
+        for(int i = 0; i < aquarium_get_sensor_count(); i++) {
+            if(aquarium_get_filter_stats(i, &filter) && filter.rejected + filter.restarts > filter.samples) {
+                res->torn++;
+            }
+        }
+    } while(!done);
+    return NULL;
+}
+
+static void run_readers(void * (*reader)(void *), reader_result_t * results)
+{
+    pthread_t threads[READERS];
+    memset(results, 0, sizeof(reader_result_t) * READERS);
+    for(int i = 0; i < READERS; i++) {
+        TEST_ASSERT_EQUAL(0, pthread_create(&threads[i], NULL, reader, &results[i]));
+    }
+    for(int i = 0; i < READERS; i++) pthread_join(threads[i], NULL);
+}
+
+static void make_record(uint32_t n, aquarium_sample_t * s)
+{
+    memset(s, 0, sizeof(*s));
+    s->timestamp_us = n;
+    s->temp_centi = (temp_centi_t)n;
+    s->trend_centi_h = (int16_t)(n * 3);
+    s->eta_s = (int32_t)(n ^ 0x5A5A5A5A);
+    s->read_latency_us = ~n;
+    for(int i = 0; i < 8; i++) s->rom[i] = (uint8_t)(n >> i);
+    s->valid = n & 1;
+}
+
+/*Field by field: the padding is not part of a publication*/
+static bool same_record(const aquarium_sample_t * s, uint32_t n)
+{
+    aquarium_sample_t e;
+    make_record(n, &e);
+    return s->seq == n && s->timestamp_us == e.timestamp_us && s->temp_centi == e.temp_centi &&
+           s->trend_centi_h == e.trend_centi_h && s->eta_s == e.eta_s &&
+           s->read_latency_us == e.read_latency_us && memcmp(s->rom, e.rom, sizeof(e.rom)) == 0 &&
+           s->valid == e.valid;
+}
+
+#endif
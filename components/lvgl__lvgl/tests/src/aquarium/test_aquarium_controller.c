@@ -0,0 +1,265 @@
+/**
+ * @file test_aquarium_controller.c
+ * The read schedule of main/aquarium_controller.c (IDLE -> CONVERTING ->
+ * RETRY_WAIT) on the fake clock, with two probes on the simulated bus:
+ * - slots stay on the grid whatever the wake-up latency and the interval,
+ * - a failed attempt is retried DS_RETRY_DELAY_MS later, MAX_READ_RETRIES
+ *   times, then the sample fails and the next slot is still on the grid,
+ * - the bus recovers (same slot or by a new search), a retry only reads the
+ *   probes still pending, an overrun skips the slots it missed,
+ * - the read time comes from the caller's clock, like the schedule.
+ */
+#if LV_BUILD_TEST
+#include "aquarium_controller_harness.c"
+
+#include "unity/unity.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define SLOT_US             ((int64_t)TEMP_UPDATE_INTERVAL_MS * 1000)
+#define RETRY_US            ((int64_t)DS_RETRY_DELAY_MS * 1000)
+#define CONV_12BIT_US       ((int64_t)ds18b20_conversion_time_ms(12) * 1000)
+#define SCRATCHPAD_BITS     (DS18B20_SCRATCHPAD_LEN * 8)
+
+/*1/16 degC: 23.25 is within ADAPT_NEAR_LIMIT of TEMP_MIN_NORMAL, so the
+ *interval stays at TEMP_UPDATE_INTERVAL_MS and the resolution at 12 bits*/
+#define RAW_NEAR_LIMIT      (23 * 16 + 4)
+#define RAW_FLAT            (25 * 16)
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void set_probes(int16_t raw);
+static void set_present(bool present);
+static void good_sample(void);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static onewire_bus_t * bus;
+static ds_reader_t reader;
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+void setUp(void)
+{
+    TEST_ASSERT_EQUAL(ESP_OK, onewire_new_sim_bus(&bus));
+    onewire_sim_add_ds18b20(bus, 0x100001);
+    onewire_sim_add_ds18b20(bus, 0x100002);
+    set_probes(RAW_NEAR_LIMIT);
+    harness_start(bus, &reader);
+}
+
+void tearDown(void)
+{
+    onewire_del_bus(bus);
+}
+
+void test_slots_stay_on_grid_whatever_the_latency(void)
+{
+    uint64_t jitter_total = 0;
+    for(int k = 0; k < 20; k++) {
+        int64_t latency = (k * 7 % 5) * 1000;
+        if(k == 0) latency = 0;     /*The first slot runs at once*/
+
+        TEST_ASSERT_EQUAL(DS_RESULT_NONE, harness_wake(&reader, latency));
+        TEST_ASSERT_EQUAL(DS_STATE_CONVERTING, reader.state);
+        TEST_ASSERT_EQUAL_INT64(HARNESS_T0_US + k * SLOT_US, reader.slot_us);
+        TEST_ASSERT_EQUAL_INT64(esp_timer_get_time() + CONV_12BIT_US, aquarium_host_timer_deadline());
+        jitter_total += (uint64_t)latency;
+
+        TEST_ASSERT_EQUAL(DS_RESULT_OK, harness_wake(&reader, latency));
+        TEST_ASSERT_EQUAL_UINT32(3, reader.read_mask);
+        TEST_ASSERT_EQUAL_INT64(HARNESS_T0_US + (k + 1) * SLOT_US, reader.deadline_us);
+        TEST_ASSERT_EQUAL_INT64(reader.deadline_us, aquarium_host_timer_deadline());
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(20, g_sched_stats.slots);
+    TEST_ASSERT_EQUAL_UINT32(4000, g_sched_stats.jitter_max_us);
+    TEST_ASSERT_EQUAL_UINT64(jitter_total, g_sched_stats.jitter_total_us);
+    TEST_ASSERT_EQUAL_UINT32(0, g_sched_stats.overruns);
+    TEST_ASSERT_EQUAL_UINT32(20, aquarium_host_get_calls()->matter_temps);
+    TEST_ASSERT_EQUAL_INT16(2325, aquarium_host_get_calls()->matter_temp);
+}
+
+void test_stretched_interval_keeps_the_grid(void)
+{
+    /*Flat water far from the limits: the interval doubles per sample*/
+    set_probes(RAW_FLAT);
+    static const uint32_t gaps_ms[] = {5000, 10000, 20000, 40000, 60000, 60000};
+    int64_t slot = HARNESS_T0_US;
+    for(uint32_t i = 0; i < sizeof(gaps_ms) / sizeof(gaps_ms[0]); i++) {
+        TEST_ASSERT_EQUAL(DS_RESULT_OK, harness_sample(&reader, 3000));
+        TEST_ASSERT_EQUAL_INT64(slot, reader.slot_us);
+        TEST_ASSERT_EQUAL_UINT32(gaps_ms[i], reader.interval_ms);
+        TEST_ASSERT_EQUAL_INT64(slot + (int64_t)gaps_ms[i] * 1000, reader.deadline_us);
+        slot = reader.deadline_us;
+    }
+    TEST_ASSERT_EQUAL_UINT32(60000, g_sched_stats.interval_ms);
+}
+
+void test_failed_attempts_back_off_then_fail_on_the_grid(void)
+{
+    good_sample();
+    int64_t slot = reader.deadline_us;
+    uint32_t matter = aquarium_host_get_calls()->matter_temps;
+    set_present(false);
+
+    /*Attempts at the slot, then DS_RETRY_DELAY_MS after each failure*/
+    int64_t t = slot;
+    for(int attempt = 1; attempt < MAX_READ_RETRIES; attempt++) {
+        TEST_ASSERT_EQUAL(DS_RESULT_NONE, harness_wake(&reader, 2000));
+        t += 2000;
+        TEST_ASSERT_EQUAL_INT64(t, esp_timer_get_time());
+        TEST_ASSERT_EQUAL(DS_STATE_RETRY_WAIT, reader.state);
+        TEST_ASSERT_EQUAL(attempt, reader.attempt);
+        TEST_ASSERT_EQUAL_INT64(t + RETRY_US, aquarium_host_timer_deadline());
+        t += RETRY_US;
+    }
+
+    TEST_ASSERT_EQUAL(DS_RESULT_FAILED, harness_wake(&reader, 2000));
+    TEST_ASSERT_EQUAL(DS_STATE_IDLE, reader.state);
+    TEST_ASSERT_TRUE(reader.rescan);
+    TEST_ASSERT_EQUAL_INT64(slot, reader.slot_us);
+    TEST_ASSERT_EQUAL_INT64(slot + SLOT_US, reader.deadline_us);
+    TEST_ASSERT_EQUAL_INT64(slot + SLOT_US, aquarium_host_timer_deadline());
+
+    /*Nothing published: the last good sample stays*/
+    TEST_ASSERT_EQUAL_UINT32(matter, aquarium_host_get_calls()->matter_temps);
+    aquarium_sample_t s;
+    TEST_ASSERT_TRUE(aquarium_get_sample(0, &s));
+    TEST_ASSERT_EQUAL_INT16(2325, s.temp_centi);
+}
+
+void test_failure_snaps_a_stretched_interval_back(void)
+{
+    set_probes(RAW_FLAT);
+    for(int i = 0; i < 4; i++) TEST_ASSERT_EQUAL(DS_RESULT_OK, harness_sample(&reader, 0));
+    TEST_ASSERT_EQUAL_UINT32(40000, reader.interval_ms);
+    int64_t slot = reader.deadline_us;
+
+    set_present(false);
+    TEST_ASSERT_EQUAL(DS_RESULT_FAILED, harness_sample(&reader, 0));
+    TEST_ASSERT_EQUAL_UINT32(TEMP_UPDATE_INTERVAL_MS, reader.interval_ms);
+    TEST_ASSERT_EQUAL_INT64(slot + SLOT_US, reader.deadline_us);
+}
+
+void test_bus_recovers_by_a_new_search(void)
+{
+    good_sample();
+    set_present(false);
+    TEST_ASSERT_EQUAL(DS_RESULT_FAILED, harness_sample(&reader, 0));
+    TEST_ASSERT_EQUAL(DS_RESULT_FAILED, harness_sample(&reader, 0));
+    int64_t slot = reader.deadline_us;
+    uint32_t matter = aquarium_host_get_calls()->matter_temps;
+
+    set_present(true);
+    TEST_ASSERT_EQUAL(DS_RESULT_OK, harness_sample(&reader, 0));
+    TEST_ASSERT_FALSE(reader.rescan);
+    TEST_ASSERT_EQUAL_INT(2, g_sensor_count);
+    TEST_ASSERT_EQUAL_UINT32(3, reader.read_mask);
+    TEST_ASSERT_EQUAL_INT64(slot, reader.slot_us);
+    TEST_ASSERT_EQUAL_INT64(slot + SLOT_US, reader.deadline_us);
+
+    TEST_ASSERT_EQUAL_UINT32(matter + 1, aquarium_host_get_calls()->matter_temps);
+    aquarium_sample_t s;
+    TEST_ASSERT_TRUE(aquarium_get_sample(1, &s));
+    TEST_ASSERT_TRUE(s.valid);
+    TEST_ASSERT_EQUAL_INT16(2325, s.temp_centi);
+}
+
+void test_bus_recovers_within_the_slot(void)
+{
+    good_sample();
+    int64_t slot = reader.deadline_us;
+    set_present(false);
+    TEST_ASSERT_EQUAL(DS_RESULT_NONE, harness_wake(&reader, 0));
+    TEST_ASSERT_EQUAL(DS_STATE_RETRY_WAIT, reader.state);
+
+    set_present(true);
+    TEST_ASSERT_EQUAL(DS_RESULT_NONE, harness_wake(&reader, 0));
+    TEST_ASSERT_EQUAL(DS_STATE_CONVERTING, reader.state);
+    TEST_ASSERT_EQUAL_INT64(slot + RETRY_US + CONV_12BIT_US, reader.deadline_us);
+    TEST_ASSERT_EQUAL(DS_RESULT_OK, harness_wake(&reader, 0));
+    TEST_ASSERT_EQUAL_UINT32(3, reader.read_mask);
+    TEST_ASSERT_EQUAL_INT64(slot + SLOT_US, reader.deadline_us);
+}
+
+void test_retry_only_reads_the_pending_probe(void)
+{
+    good_sample();
+    int bad = harness_sensor_of(bus, 1);
+    int good = harness_sensor_of(bus, 0);
+    onewire_sim_corrupt_next_read(bus, 1);
+
+    TEST_ASSERT_EQUAL(DS_RESULT_NONE, harness_wake(&reader, 0));
+    TEST_ASSERT_EQUAL(DS_RESULT_NONE, harness_wake(&reader, 0));
+    TEST_ASSERT_EQUAL(DS_STATE_RETRY_WAIT, reader.state);
+    TEST_ASSERT_EQUAL_UINT32(1u << bad, reader.pending_mask);
+    TEST_ASSERT_EQUAL_UINT32(1u << good, reader.read_mask);
+
+    TEST_ASSERT_EQUAL(DS_RESULT_NONE, harness_wake(&reader, 0));
+    onewire_sim_reset_stats(bus);
+    TEST_ASSERT_EQUAL(DS_RESULT_OK, harness_wake(&reader, 0));
+    TEST_ASSERT_EQUAL_UINT32(SCRATCHPAD_BITS, onewire_sim_get_stats(bus)->bits_read);
+    TEST_ASSERT_EQUAL_UINT32(3, reader.read_mask);
+    TEST_ASSERT_TRUE(reader.read_us[bad] > reader.read_us[good]);
+}
+
+void test_read_time_comes_from_the_caller(void)
+{
+    /*The machine alone, on a clock the fake esp_timer does not show: the
+     *scratchpads are stamped with the step that read them*/
+    int64_t t = reader.deadline_us + 777;
+    TEST_ASSERT_EQUAL(DS_RESULT_NONE, ds_reader_step(&reader, t));
+    TEST_ASSERT_EQUAL_INT64(t, reader.sample_start_us);
+    t = reader.deadline_us + 333;
+    TEST_ASSERT_EQUAL(DS_RESULT_OK, ds_reader_step(&reader, t));
+    TEST_ASSERT_NOT_EQUAL(t, esp_timer_get_time());
+    TEST_ASSERT_EQUAL_INT64(t, reader.read_us[0]);
+    TEST_ASSERT_EQUAL_INT64(t, reader.read_us[1]);
+}
+
+void test_overrun_skips_the_missed_slots(void)
+{
+    good_sample();
+    int64_t slot = reader.deadline_us;
+
+    /*The task runs 12 s late: the sample belongs to `slot`, the two slots
+     *that passed meanwhile are dropped*/
+    TEST_ASSERT_EQUAL(DS_RESULT_NONE, harness_wake(&reader, 12000000));
+    TEST_ASSERT_EQUAL(DS_RESULT_OK, harness_wake(&reader, 0));
+    TEST_ASSERT_EQUAL_INT64(slot, reader.slot_us);
+    TEST_ASSERT_EQUAL_UINT32(1, g_sched_stats.overruns);
+    TEST_ASSERT_EQUAL_UINT32(2, g_sched_stats.skipped_slots);
+    TEST_ASSERT_EQUAL_UINT32(12000000, g_sched_stats.jitter_max_us);
+    TEST_ASSERT_EQUAL_INT64(slot + 3 * SLOT_US, reader.deadline_us);
+    TEST_ASSERT_EQUAL_INT64(0, (reader.deadline_us - HARNESS_T0_US) % SLOT_US);
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static void set_probes(int16_t raw)
+{
+    onewire_sim_set_temperature(bus, 0, raw);
+    onewire_sim_set_temperature(bus, 1, raw);
+}
+
+static void set_present(bool present)
+{
+    onewire_sim_set_present(bus, 0, present);
+    onewire_sim_set_present(bus, 1, present);
+}
+
+static void good_sample(void)
+{
+    TEST_ASSERT_EQUAL(DS_RESULT_OK, harness_sample(&reader, 0));
+    TEST_ASSERT_EQUAL_UINT32(3, reader.read_mask);
+}
+
+#endif
@@ -0,0 +1,99 @@
+/**
+ * @file test_aquarium_conversions.c
+ * The integer temperature conversions against a double-precision reference,
+ * for every input code:
+ * - ds18b20_raw_to_centi(): scratchpad (1/16 degC) to centi-degC, every raw
+ *   value whose result fits temp_centi_t (the DS18B20's -55..+125 degC and
+ *   well beyond),
+ * - temp_centi_to_tenths(): centi-degC to the tenths the UI and logs show,
+ *   every int16 value,
+ * - both chained, as a reading reaches the screen: the same as rounding the
+ *   sensor's value to a tenth at once.
+ * Rounding is half away from zero (C's round()).
+ */
+#if LV_BUILD_TEST
+#include "ds18b20.h"
+#include "aquarium_sample.h"
+#include "lvgl.h"
+#include <math.h>
+
+#include "unity/unity.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define RAW_FITS_MAX        5242        /*5242 * 6.25 = 32762.5 -> 32763*/
+#define RAW_SENSOR_MIN      (-55 * 16)  /*DS18B20 range*/
+#define RAW_SENSOR_MAX      (125 * 16)
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void check(int input, long got, long expected);
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_raw_to_centi_is_exact_for_every_code(void)
+{
+    for(int raw = -RAW_FITS_MAX; raw <= RAW_FITS_MAX; raw++) {
+        check(raw, ds18b20_raw_to_centi((int16_t)raw), lround(raw / 16.0 * 100.0));
+    }
+
+    /*Landmarks: the datasheet's table, ties both ways*/
+    TEST_ASSERT_EQUAL_INT16(12500, ds18b20_raw_to_centi(0x07D0));
+    TEST_ASSERT_EQUAL_INT16(8500, ds18b20_raw_to_centi(0x0550));
+    TEST_ASSERT_EQUAL_INT16(2506, ds18b20_raw_to_centi(0x0191));   /*25.0625*/
+    TEST_ASSERT_EQUAL_INT16(-1013, ds18b20_raw_to_centi((int16_t)0xFF5E));  /*-10.125*/
+    TEST_ASSERT_EQUAL_INT16(-5500, ds18b20_raw_to_centi((int16_t)0xFC90));
+    TEST_ASSERT_EQUAL_INT16(6, ds18b20_raw_to_centi(1));           /*6.25*/
+    TEST_ASSERT_EQUAL_INT16(-6, ds18b20_raw_to_centi(-1));
+    TEST_ASSERT_EQUAL_INT16(13, ds18b20_raw_to_centi(2));          /*12.5*/
+    TEST_ASSERT_EQUAL_INT16(-13, ds18b20_raw_to_centi(-2));
+}
+
+void test_centi_to_tenths_is_exact_for_every_value(void)
+{
+    for(int c = INT16_MIN; c <= INT16_MAX; c++) {
+        check(c, temp_centi_to_tenths((temp_centi_t)c), lround(c / 10.0));
+    }
+
+    /*The truncation this replaced showed 24.96 as 24.9*/
+    TEST_ASSERT_EQUAL(250, temp_centi_to_tenths(2496));
+    TEST_ASSERT_EQUAL(249, temp_centi_to_tenths(2494));
+    TEST_ASSERT_EQUAL(250, temp_centi_to_tenths(2495));
+    TEST_ASSERT_EQUAL(-250, temp_centi_to_tenths(-2495));
+    TEST_ASSERT_EQUAL(0, temp_centi_to_tenths(-4));
+}
+
+void test_sensor_codes_reach_the_screen_rounded_once(void)
+{
+    /*Every 12-bit code, so every 9..11-bit one (the same codes, low bits 0)*/
+    for(int raw = RAW_SENSOR_MIN; raw <= RAW_SENSOR_MAX; raw++) {
+        check(raw, temp_centi_to_tenths(ds18b20_raw_to_centi((int16_t)raw)), lround(raw / 16.0 * 10.0));
+    }
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+/*Per input, so a failure names the first code that is off*/
+static void check(int input, long got, long expected)
+{
+    if(got == expected) return;
+    char msg[64];
+    lv_snprintf(msg, sizeof(msg), "input %d: got %ld, expected %ld", input, got, expected);
+    TEST_FAIL_MESSAGE(msg);
+}
+
+#endif
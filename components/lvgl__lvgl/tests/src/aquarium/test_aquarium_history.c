@@ -0,0 +1,271 @@
+/**
+ * @file test_aquarium_history.c
+ * The delta-encoded history (main/aquarium_history.c) against the samples
+ * that went in:
+ * - values are exact and times within a quarter of the spacing, through
+ *   interval changes, skipped slots, gaps and large steps,
+ * - last(), range() and window() agree with a plain array,
+ * - the ring drops whole blocks, oldest first,
+ * - the worst case (a one-LSB change every sample) covers about 3.6 days,
+ * - gaps at the limit of the spacing token (2^30 ms) and beyond.
+ */
+#if LV_BUILD_TEST
+#include "aquarium_history.h"
+#include <string.h>
+
+#include "unity/unity.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define T0_US               1000000LL
+#define SLOT_US             5000000LL
+#define SAMPLES             20000
+#define DAY_US              (24 * 3600LL * 1000000)
+#define INTERVAL_MAX_MS     ((1LL << 30) - 1)   /*Longest spacing a token holds*/
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void append(int64_t t, int16_t centi);
+static void generate(int n, bool busy);
+static void check_points(const aquarium_history_point_t * got, int n, int first);
+static uint32_t rnd(void);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static aquarium_history_t hist;
+static aquarium_history_point_t ref[SAMPLES * 3];
+static int ref_count;
+static aquarium_history_point_t out[SAMPLES * 3];
+static aquarium_history_point_t pts[SAMPLES];
+static uint32_t seed;
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+void setUp(void)
+{
+    aquarium_history_init(&hist);
+    ref_count = 0;
+    seed = 1;
+}
+
+void tearDown(void)
+{
+}
+
+void test_round_trip(void)
+{
+    generate(SAMPLES, false);
+
+    aquarium_history_info_t info;
+    aquarium_history_get_info(&hist, &info);
+    TEST_ASSERT_EQUAL_UINT32(SAMPLES, info.samples);
+    TEST_ASSERT_EQUAL_INT64(ref[0].time_us, info.oldest_us);
+
+    TEST_ASSERT_EQUAL(SAMPLES, aquarium_history_last(&hist, SAMPLES * 2, out));
+    check_points(out, SAMPLES, 0);
+    TEST_ASSERT_EQUAL(100, aquarium_history_last(&hist, 100, out));
+    check_points(out, 100, SAMPLES - 100);
+    TEST_ASSERT_EQUAL(0, aquarium_history_last(&hist, 0, out));
+}
+
+void test_range_and_window_match_the_samples(void)
+{
+    generate(SAMPLES, false);
+
+    /*Windows inside the stream, at its ends and outside it*/
+    const int64_t span = ref[ref_count - 1].time_us - ref[0].time_us;
+    const int64_t from[] = {ref[0].time_us - 1, ref[0].time_us + span / 3, ref[0].time_us + span / 2, ref[ref_count - 1].time_us + 1};
+    const int64_t len[] = {3600LL * 1000000, 24 * 3600LL * 1000000, span, 1000000};
+    for(size_t w = 0; w < sizeof(from) / sizeof(from[0]); w++) {
+        const int64_t to = from[w] + len[w];
+        int n = aquarium_history_range(&hist, from[w], to, pts, SAMPLES);
+
+        /*The samples whose reconstructed time is in the window*/
+        TEST_ASSERT_EQUAL(SAMPLES, aquarium_history_last(&hist, SAMPLES, out));
+        int first = -1;
+        int expected = 0;
+        int32_t min = INT16_MAX, max = INT16_MIN;
+        int64_t sum = 0;
+        for(int i = 0; i < ref_count; i++) {
+            if(out[i].time_us < from[w] || out[i].time_us > to) continue;
+            if(first < 0) first = i;
+            expected++;
+            if(ref[i].centi < min) min = ref[i].centi;
+            if(ref[i].centi > max) max = ref[i].centi;
+            sum += ref[i].centi;
+        }
+        TEST_ASSERT_EQUAL(expected, n);
+        if(n > 0) check_points(pts, n, first);
+
+        aquarium_history_window_t win;
+        TEST_ASSERT_EQUAL(n > 0, aquarium_history_window(&hist, from[w], to, &win));
+        if(n == 0) continue;
+        TEST_ASSERT_EQUAL_UINT32(n, win.count);
+        TEST_ASSERT_EQUAL_INT16(min, win.min);
+        TEST_ASSERT_EQUAL_INT16(max, win.max);
+        int64_t half = n / 2;
+        TEST_ASSERT_EQUAL_INT16((sum >= 0 ? sum + half : sum - half) / n, win.avg);
+    }
+
+    /*max caps the copy, oldest first*/
+    TEST_ASSERT_EQUAL(10, aquarium_history_range(&hist, INT64_MIN, INT64_MAX, out, 10));
+    check_points(out, 10, 0);
+    TEST_ASSERT_EQUAL(0, aquarium_history_range(&hist, INT64_MIN, INT64_MAX, out, 0));
+}
+
+void test_full_ring_drops_the_oldest_blocks(void)
+{
+    /*A change of up to 60 centi-degC every sample: one or two bytes each,
+     *so the 64 KB wrap*/
+    generate(SAMPLES * 3, true);
+
+    aquarium_history_info_t info;
+    aquarium_history_get_info(&hist, &info);
+    TEST_ASSERT_LESS_THAN_UINT32(SAMPLES * 3, info.samples);
+    TEST_ASSERT_GREATER_THAN_UINT32(SAMPLES * 3 / 2, info.samples);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(HISTORY_BLOCK_COUNT * HISTORY_BLOCK_DATA, info.bytes);
+
+    /*What is left is the newest samples, unbroken*/
+    int n = aquarium_history_last(&hist, SAMPLES * 3, out);
+    TEST_ASSERT_EQUAL_UINT32(info.samples, n);
+    check_points(out, n, ref_count - n);
+    TEST_ASSERT_EQUAL_INT64(out[0].time_us, info.oldest_us);
+}
+
+void test_worst_case_capacity(void)
+{
+    /*Every 5 s sample one 12-bit LSB off the last: a byte each, the ring
+     *covers its data bytes in slots, less the block dropped on the wrap*/
+    const int n = HISTORY_BLOCK_COUNT * HISTORY_BLOCK_DATA * 3 / 2;
+    for(int i = 0; i < n; i++) aquarium_history_append(&hist, T0_US + i * SLOT_US, (int16_t)(2500 + (i & 1) * 6));
+
+    aquarium_history_info_t info;
+    aquarium_history_get_info(&hist, &info);
+    TEST_ASSERT_EQUAL_UINT32(info.samples, info.bytes + HISTORY_BLOCK_COUNT);   /*+ the absolute first samples*/
+    int64_t span_us = info.newest_us - info.oldest_us;
+    TEST_ASSERT_GREATER_OR_EQUAL_INT64((int64_t)(HISTORY_BLOCK_COUNT - 1) * HISTORY_BLOCK_DATA * SLOT_US, span_us);
+    TEST_ASSERT_LESS_OR_EQUAL_INT64((int64_t)HISTORY_BLOCK_COUNT * HISTORY_BLOCK_DATA * SLOT_US, span_us);
+
+    /*The figure aquarium_history.h gives: about 3.6 days, short of a week*/
+    TEST_ASSERT_INT64_WITHIN(DAY_US / 10, DAY_US * 36 / 10, span_us);
+    TEST_ASSERT_LESS_THAN_INT64(7 * DAY_US, span_us);
+}
+
+void test_gap_at_the_spacing_token_limit(void)
+{
+    append(T0_US, 2500);
+    append(T0_US + SLOT_US, 2500);
+
+    /*The longest gap a spacing token holds, then the same spacing again*/
+    int64_t t = T0_US + SLOT_US + INTERVAL_MAX_MS * 1000;
+    append(t, 2512);
+    append(t + INTERVAL_MAX_MS * 1000, 2512);
+    append(t + INTERVAL_MAX_MS * 1000 + SLOT_US, 2518);
+
+    TEST_ASSERT_EQUAL(ref_count, aquarium_history_last(&hist, 16, out));
+    check_points(out, ref_count, 0);
+}
+
+void test_gap_beyond_the_spacing_token_starts_a_block(void)
+{
+    append(T0_US, 2500);
+    append(T0_US + SLOT_US, 2506);
+
+    /*2^30 ms would not fit the token (it used to wrap to a zero spacing),
+     *2^32 ms not even the 32-bit spacing*/
+    const int64_t t1 = T0_US + SLOT_US + (INTERVAL_MAX_MS + 1) * 1000;
+    append(t1, 2490);
+    append(t1 + SLOT_US, 2490);
+    const int64_t t = t1 + SLOT_US + (1LL << 32) * 1000;
+    append(t, 2470);
+    append(t + SLOT_US, 2476);
+    append(t + 2 * SLOT_US, 2476);
+
+    TEST_ASSERT_EQUAL(ref_count, aquarium_history_last(&hist, 16, out));
+    check_points(out, ref_count, 0);
+
+    aquarium_history_info_t info;
+    aquarium_history_get_info(&hist, &info);
+    TEST_ASSERT_EQUAL_UINT32(ref_count, info.samples);
+    TEST_ASSERT_EQUAL_INT64(ref[ref_count - 1].time_us, info.newest_us);
+
+    /*The windows on either side of a gap only see their own samples*/
+    aquarium_history_window_t win;
+    TEST_ASSERT_TRUE(aquarium_history_window(&hist, t, t + 2 * SLOT_US, &win));
+    TEST_ASSERT_EQUAL_UINT32(3, win.count);
+    TEST_ASSERT_EQUAL_INT16(2470, win.min);
+    TEST_ASSERT_TRUE(aquarium_history_window(&hist, t1, t1 + SLOT_US, &win));
+    TEST_ASSERT_EQUAL_UINT32(2, win.count);
+    TEST_ASSERT_EQUAL_INT16(2490, win.max);
+    TEST_ASSERT_FALSE(aquarium_history_window(&hist, T0_US + 2 * SLOT_US, t1 - SLOT_US, &win));
+    TEST_ASSERT_FALSE(aquarium_history_window(&hist, t1 + 2 * SLOT_US, t - SLOT_US, &win));
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static void append(int64_t t, int16_t centi)
+{
+    ref[ref_count].time_us = t;
+    ref[ref_count].centi = centi;
+    ref_count++;
+    aquarium_history_append(&hist, t, centi);
+}
+
+/*Samples as the controller appends them: slot times (on the grid, give or
+ *take a clock tick), stretched and snapped intervals, overruns skipping
+ *slots, the odd gap of any length (reboot, bus down); flat water with
+ *12-bit steps, or a busy signal (a change every sample)*/
+static void generate(int n, bool busy)
+{
+    int64_t t = T0_US;
+    int64_t interval = SLOT_US;
+    int16_t v = 2500;
+    for(int i = 0; i < n; i++) {
+        uint32_t r = rnd();
+        if(r % 500 == 0) interval = SLOT_US * (1 + rnd() % 12);        /*5..60 s*/
+        if(r % 701 == 0) t += interval * (1 + rnd() % 3);               /*Skipped slots*/
+        if(r % 1999 == 0) t += (int64_t)(rnd() % 86400000) * 1000 + rnd() % 1000;  /*Gap up to a day*/
+        int64_t tick = (int64_t)(rnd() % 21) - 10;
+
+        if(busy) v = (int16_t)(2500 + (int)(rnd() % 121) - 60);
+        else if(r % 37 == 0) v += (r & 64) ? 6 : -6;
+        else if(r % 4001 == 0) v = (int16_t)(1000 + rnd() % 3000);     /*Probe swap*/
+
+        append(t + (i ? tick : 0), v);
+        t += interval;
+    }
+}
+
+/*got[] against ref[first..]: exact values; times within a quarter of the
+ *spacing the history holds around the sample (it snaps to that grid), or
+ *the 1 ms it rounds a new spacing to*/
+static void check_points(const aquarium_history_point_t * got, int n, int first)
+{
+    for(int i = 0; i < n; i++) {
+        const aquarium_history_point_t * e = &ref[first + i];
+        TEST_ASSERT_EQUAL_INT16_MESSAGE(e->centi, got[i].centi, "value");
+
+        int64_t spacing = 0;
+        if(i > 0) spacing = got[i].time_us - got[i - 1].time_us;
+        if(i + 1 < n && got[i + 1].time_us - got[i].time_us > spacing) spacing = got[i + 1].time_us - got[i].time_us;
+        int64_t tol = spacing / 4 > 500 ? spacing / 4 : 500;
+        int64_t err = got[i].time_us - e->time_us;
+        if(err < 0) err = -err;
+        TEST_ASSERT_TRUE_MESSAGE(err <= tol, "time");
+    }
+}
+
+static uint32_t rnd(void)
+{
+    seed = seed * 1103515245u + 12345u;
+    return seed >> 8;
+}
+
+#endif
@@ -0,0 +1,169 @@
+/**
+ * @file test_aquarium_interval.c
+ * The adaptive interval of main/aquarium_controller.c over a simulated day
+ * on the fake clock, one probe on the simulated bus, against the fixed
+ * TEMP_UPDATE_INTERVAL_MS (17280 samples a day):
+ * - steady water with a 12-bit LSB of noise stretches to
+ *   TEMP_UPDATE_INTERVAL_MAX_MS (about 1440 samples a day),
+ * - a heater dying (0.5 degC/h down through TEMP_MIN_NORMAL) snaps back to
+ *   fast sampling an hour before the limit, and the crossing is published
+ *   within the noise (about 13300 samples a day).
+ */
+#if LV_BUILD_TEST
+#include "aquarium_controller_harness.c"
+#include <math.h>
+
+#include "unity/unity.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define DAY_US              (24 * 3600LL * 1000000)
+#define HOUR_US             (3600LL * 1000000)
+#define FIXED_PER_DAY       (DAY_US / ((int64_t)TEMP_UPDATE_INTERVAL_MS * 1000))
+#define MIN_PER_DAY         (DAY_US / ((int64_t)TEMP_UPDATE_INTERVAL_MAX_MS * 1000))
+
+/*The heater dies at RAMP_START_US, the water cools at RAMP_CENTI_H until
+ *RAMP_FLOOR_CENTI*/
+#define RAMP_FROM_CENTI     2550
+#define RAMP_START_US       (2 * HOUR_US)
+#define RAMP_CENTI_H        (-50)
+#define RAMP_FLOOR_CENTI    2100
+#define LSB_RAMP_US         (625 * HOUR_US / 100 / -RAMP_CENTI_H)
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct {
+    uint32_t samples;
+    int64_t crossed_us;         /*Water below TEMP_MIN_NORMAL, -1: never*/
+    int64_t detected_us;        /*First published sample below it, -1: never*/
+    uint32_t fast_samples;      /*Taken at TEMP_UPDATE_INTERVAL_MS*/
+    int64_t last_slow_us;       /*Last sample taken at a stretched interval*/
+} day_result_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void run_day(double (*water)(int64_t t_us), day_result_t * res);
+static double steady(int64_t t_us);
+static double heater_dies(int64_t t_us);
+static uint32_t rnd(void);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static onewire_bus_t * bus;
+static ds_reader_t reader;
+static uint32_t seed;
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+void setUp(void)
+{
+    TEST_ASSERT_EQUAL(ESP_OK, onewire_new_sim_bus(&bus));
+    onewire_sim_add_ds18b20(bus, 0x100001);
+    seed = 1;
+}
+
+void tearDown(void)
+{
+    onewire_del_bus(bus);
+}
+
+void test_steady_water_stretches_the_interval(void)
+{
+    day_result_t res;
+    run_day(steady, &res);
+
+    /*Doubling from 5 s takes four samples, then one a minute*/
+    TEST_ASSERT_UINT32_WITHIN(MIN_PER_DAY / 100, MIN_PER_DAY, res.samples);
+    TEST_ASSERT_LESS_THAN_UINT32(FIXED_PER_DAY / 10, res.samples);
+    TEST_ASSERT_EQUAL_INT64(-1, res.crossed_us);
+    TEST_ASSERT_EQUAL_INT64(-1, res.detected_us);
+    TEST_ASSERT_EQUAL_UINT32(TEMP_UPDATE_INTERVAL_MAX_MS, g_sched_stats.interval_ms);
+}
+
+void test_heater_dying_snaps_back_before_the_limit(void)
+{
+    day_result_t res;
+    run_day(heater_dies, &res);
+
+    /*Slow until the trend gives less than ADAPT_ETA_FAST_S to the limit or
+     *the water is within ADAPT_NEAR_LIMIT of it, fast from there on (it
+     *stays below the limit): the day costs about the part spent there*/
+    int64_t fast_from = RAMP_START_US +
+                        (int64_t)(RAMP_FROM_CENTI - TEMP_MIN_NORMAL) * HOUR_US / -RAMP_CENTI_H - HOUR_US;
+    uint32_t expected = (uint32_t)(fast_from / ((int64_t)TEMP_UPDATE_INTERVAL_MAX_MS * 1000) +
+                                   (DAY_US - fast_from) / ((int64_t)TEMP_UPDATE_INTERVAL_MS * 1000));
+    TEST_ASSERT_UINT32_WITHIN(expected / 20, expected, res.samples);
+    TEST_ASSERT_LESS_THAN_UINT32(FIXED_PER_DAY, res.samples);
+
+    /*Fast for good most of an hour ahead of the crossing (the smoothed
+     *level the ETA starts from lags the water)...*/
+    TEST_ASSERT_GREATER_THAN_INT64(0, res.crossed_us);
+    TEST_ASSERT_GREATER_OR_EQUAL_INT64(HOUR_US * 3 / 4, res.crossed_us - res.last_slow_us);
+
+    /*...so the crossing is published within the time the ramp takes for a
+     *12-bit LSB (the noise can show it that much early or late), not a
+     *stretched interval late*/
+    TEST_ASSERT_INT64_WITHIN(LSB_RAMP_US, res.crossed_us, res.detected_us);
+    TEST_ASSERT_EQUAL_UINT32(TEMP_UPDATE_INTERVAL_MS, g_sched_stats.interval_ms);
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+/*A day of samples with the probe following water(): its value in
+ *centi-degC at the slot, rounded to a 12-bit code plus an LSB of noise*/
+static void run_day(double (*water)(int64_t t_us), day_result_t * res)
+{
+    memset(res, 0, sizeof(*res));
+    res->crossed_us = -1;
+    res->detected_us = -1;
+    harness_start(bus, &reader);
+
+    while(esp_timer_get_time() < HARNESS_T0_US + DAY_US) {
+        /*The next slot, from when the conversion starts*/
+        int64_t t = aquarium_host_timer_deadline() - HARNESS_T0_US;
+        if(res->samples == 0) t = 0;
+        double centi = water(t);
+        int16_t raw = (int16_t)(lround(centi * 16 / 100) + (int)(rnd() % 3) - 1);
+        onewire_sim_set_temperature(bus, 0, raw);
+
+        bool fast = reader.interval_ms == TEMP_UPDATE_INTERVAL_MS;
+        TEST_ASSERT_EQUAL(DS_RESULT_OK, harness_sample(&reader, 0));
+        res->samples++;
+        if(fast) res->fast_samples++;
+        else res->last_slow_us = reader.slot_us - HARNESS_T0_US;
+
+        int64_t slot = reader.slot_us - HARNESS_T0_US;
+        if(res->crossed_us < 0 && centi < TEMP_MIN_NORMAL) res->crossed_us = slot;
+        if(res->detected_us < 0 && g_sensors[0].temp_centi < TEMP_MIN_NORMAL) res->detected_us = slot;
+    }
+}
+
+/*25.25 degC: 9-bit codes away from the rounding edge of the noise*/
+static double steady(int64_t t_us)
+{
+    (void)t_us;
+    return 2525;
+}
+
+static double heater_dies(int64_t t_us)
+{
+    if(t_us < RAMP_START_US) return RAMP_FROM_CENTI;
+    double centi = RAMP_FROM_CENTI + (double)(t_us - RAMP_START_US) * RAMP_CENTI_H / HOUR_US;
+    return centi > RAMP_FLOOR_CENTI ? centi : RAMP_FLOOR_CENTI;
+}
+
+static uint32_t rnd(void)
+{
+    seed = seed * 1103515245u + 12345u;
+    return seed >> 8;
+}
+
+#endif
@@ -0,0 +1,324 @@
+/**
+ * @file test_aquarium_power.c
+ * The wake schedule of the whole device on the host: the wake/sleep
+ * counters of main/aquarium_power.c, driven like on the device by the
+ * aquarium task (two wakes per sample: start the conversion, read it) and
+ * the LVGL task loop (main/LVGL_Driver/LVGL_Driver.c) running the real
+ * screen (main/aquarium_ui.c) on a simulated single core.
+ *
+ * The cost of each wake is modelled (CONVERT_WAKE_US, READ_WAKE_US,
+ * UI_PASS_US plus the bytes the flush filter lets through at the panel's
+ * SPI clock); the wake counts come from the schedule itself:
+ * - the flush-done interrupt only ends a wait inside the pass (its own
+ *   notification slot), it is not a wake of its own,
+ * - display on: the status dot pulses at UI_PULSE_FPS,
+ * - backlight dimmed or panel asleep: the pulse stops, the UI only wakes
+ *   for samples and the loop's longest sleep (LVGL_TASK_MAX_WAIT_MS),
+ * - idle + active always add up to the simulated time.
+ */
+#if LV_BUILD_TEST
+#include "../lvgl.h"
+#include "aquarium_ui.h"
+#include "aquarium_controller.h"
+#include "aquarium_power.h"
+#include "LVGL_Flush_Filter.h"
+
+#include "unity/unity.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define HOR_RES             172
+#define VER_RES             320
+#define BUF_LINES           20          /*LVGL_BUF_MIN_LINES*/
+
+#define PULSE_FPS           8           /*UI_PULSE_FPS*/
+#define MAX_WAIT_MS         5000        /*LVGL_TASK_MAX_WAIT_MS*/
+#define CONV_US             750000      /*12-bit conversion*/
+#define SIM_US              (600 * 1000000LL)
+
+/*The modelled cost of a wake: bus reset + Convert T; scratchpads of two
+ *probes at 15 kbit/s, history, Matter and LED; an LVGL pass with nothing
+ *to draw. The panel gets 1.5 bytes per us (12 MHz SPI).*/
+#define CONVERT_WAKE_US     1000
+#define READ_WAKE_US        8000
+#define UI_PASS_US          200
+#define PANEL_US(bytes)     ((bytes) * 2 / 3)
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct {
+    aquarium_power_stats_t power;
+    uint32_t samples;
+    uint32_t frames;
+} sim_result_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void flush_cb(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * color_p);
+static void rounder_cb(lv_disp_drv_t * drv, lv_area_t * area);
+static void monitor_cb(lv_disp_drv_t * drv, uint32_t time, uint32_t px);
+static void simulate(uint32_t interval_ms, sim_result_t * res);
+static void ui_pass(void);
+static void check_accounting(const sim_result_t * res);
+static uint32_t per_hour(uint32_t count);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static aquarium_sample_t sample;
+static uint32_t sample_seq;
+
+static lv_disp_t * disp;
+static lv_color_t buf1[HOR_RES * BUF_LINES];
+static lv_color_t buf2[HOR_RES * BUF_LINES];
+static uint32_t filter_hash[FLUSH_FILTER_HASHES(HOR_RES, VER_RES)];
+static flush_filter_t filter;
+
+static int64_t now_us;              /*The core is busy until then*/
+static int64_t ui_next_us;          /*When the LVGL task wakes up*/
+static int64_t tick_us;             /*Time already given to lv_tick_inc()*/
+static uint64_t panel_bytes;
+static uint32_t frames;
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+/*The controller and the LVGL task, as seen by aquarium_ui.c*/
+bool aquarium_get_sample(int index, aquarium_sample_t * out)
+{
+    LV_UNUSED(index);
+    *out = sample;
+    return sample_seq != 0;
+}
+
+uint32_t aquarium_get_sample_seq(int index)
+{
+    LV_UNUSED(index);
+    return sample_seq;
+}
+
+bool LVGL_Lock(int timeout_ms)
+{
+    LV_UNUSED(timeout_ms);
+    return true;
+}
+
+void LVGL_Unlock(void)
+{
+}
+
+/*The task notification: the LVGL task runs as soon as the core is free*/
+void LVGL_Wake(void)
+{
+    if(ui_next_us > now_us) ui_next_us = now_us;
+}
+
+void setUp(void)
+{
+    if(disp == NULL) {
+        static lv_disp_draw_buf_t draw_buf;
+        lv_disp_draw_buf_init(&draw_buf, buf1, buf2, HOR_RES * BUF_LINES);
+        static lv_disp_drv_t disp_drv;
+        lv_disp_drv_init(&disp_drv);
+        disp_drv.hor_res = HOR_RES;
+        disp_drv.ver_res = VER_RES;
+        disp_drv.draw_buf = &draw_buf;
+        disp_drv.flush_cb = flush_cb;
+        disp_drv.rounder_cb = rounder_cb;
+        disp_drv.monitor_cb = monitor_cb;
+        Flush_Filter_Init(&filter, filter_hash, HOR_RES, VER_RES);
+        disp = lv_disp_drv_register(&disp_drv);
+        lv_disp_set_default(disp);
+        aquarium_ui_init();
+
+        /*The device has no input device and one display: the test runner's
+         *would wake the loop every LV_DISP_DEF_REFR_PERIOD*/
+        lv_indev_t * indev;
+        for(indev = lv_indev_get_next(NULL); indev; indev = lv_indev_get_next(indev)) {
+            lv_timer_pause(indev->driver->read_timer);
+        }
+        lv_disp_t * d;
+        for(d = lv_disp_get_next(NULL); d; d = lv_disp_get_next(d)) {
+            if(d != disp) lv_timer_pause(d->refr_timer);
+        }
+    }
+    lv_disp_set_default(disp);
+
+    /*Display on, like after boot or a button press*/
+    aquarium_ui_set_active(true);
+    aquarium_ui_set_dimmed(false);
+}
+
+void tearDown(void)
+{
+}
+
+void test_pulse_wakes_the_ui_at_its_frame_rate(void)
+{
+    sim_result_t res;
+    simulate(TEMP_UPDATE_INTERVAL_MS, &res);
+    check_accounting(&res);
+
+    /*At most a frame per pulse step (a step that does not change the
+     *opacity, at the turns of the fade, draws nothing), one wake for it
+     *plus one per sample*/
+    uint32_t seconds = (uint32_t)(SIM_US / 1000000);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(seconds * PULSE_FPS, res.frames);
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(seconds * PULSE_FPS * 95 / 100, res.frames);
+    TEST_ASSERT_UINT32_WITHIN(seconds * PULSE_FPS / 20, seconds * PULSE_FPS + res.samples,
+                              res.power.act_wakes[POWER_ACT_UI]);
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT64(res.power.active_us * 50, res.power.idle_us);
+    TEST_PRINTF("display on, 5 s: %u wakes/h, %u UI frames/h, sleepable %u.%u%%",
+                (unsigned)per_hour(res.power.wakes), (unsigned)per_hour(res.frames),
+                (unsigned)(res.power.idle_us * 100 / SIM_US), (unsigned)(res.power.idle_us * 1000 / SIM_US % 10));
+}
+
+void test_dimmed_display_only_wakes_for_samples(void)
+{
+    aquarium_ui_set_dimmed(true);
+    sim_result_t res;
+    simulate(TEMP_UPDATE_INTERVAL_MS, &res);
+    check_accounting(&res);
+
+    /*The dot back at full opacity, then nothing to draw: an unchanged
+     *reading invalidates nothing*/
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(1, res.frames);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(res.samples + SIM_US / (MAX_WAIT_MS * 1000) + 2,
+                                     res.power.act_wakes[POWER_ACT_UI]);
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT64(res.power.active_us * 200, res.power.idle_us);
+    TEST_PRINTF("dimmed, 5 s: %u wakes/h, sleepable %u.%u%%", (unsigned)per_hour(res.power.wakes),
+                (unsigned)(res.power.idle_us * 100 / SIM_US), (unsigned)(res.power.idle_us * 1000 / SIM_US % 10));
+}
+
+void test_panel_asleep_with_a_stretched_interval(void)
+{
+    aquarium_ui_set_dimmed(true);
+    aquarium_ui_set_active(false);
+    sim_result_t res;
+    simulate(TEMP_UPDATE_INTERVAL_MAX_MS, &res);
+    check_accounting(&res);
+
+    TEST_ASSERT_EQUAL_UINT32(SIM_US / ((int64_t)TEMP_UPDATE_INTERVAL_MAX_MS * 1000), res.samples);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(1, res.frames);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(res.samples + SIM_US / (MAX_WAIT_MS * 1000) + 2,
+                                     res.power.act_wakes[POWER_ACT_UI]);
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT64(res.power.active_us * 1000, res.power.idle_us);
+    TEST_PRINTF("asleep, 60 s: %u wakes/h, sleepable %u.%u%%", (unsigned)per_hour(res.power.wakes),
+                (unsigned)(res.power.idle_us * 100 / SIM_US), (unsigned)(res.power.idle_us * 1000 / SIM_US % 10));
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static void flush_cb(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * color_p)
+{
+    lv_area_t window;
+    if(Flush_Filter_Apply(&filter, area, color_p, &window)) {
+        panel_bytes += lv_area_get_size(&window) * sizeof(lv_color_t);
+    }
+    lv_disp_flush_ready(drv);
+}
+
+static void rounder_cb(lv_disp_drv_t * drv, lv_area_t * area)
+{
+    LV_UNUSED(drv);
+    Flush_Filter_Round(&filter, area);
+}
+
+static void monitor_cb(lv_disp_drv_t * drv, uint32_t time, uint32_t px)
+{
+    LV_UNUSED(drv);
+    LV_UNUSED(time);
+    LV_UNUSED(px);
+    frames++;
+}
+
+/*SIM_US of samples at `interval_ms` (the same reading every time) and the
+ *LVGL task, one core: whichever task is due next runs, for its modelled
+ *cost, between aquarium_power_begin() and _end() like on the device*/
+static void simulate(uint32_t interval_ms, sim_result_t * res)
+{
+    lv_memset_00(res, sizeof(*res));
+    frames = 0;
+    const int64_t start = now_us;
+    const int64_t end = start + SIM_US;
+    aquarium_power_init(start);
+
+    int64_t slot = start;
+    int64_t sensor_next_us = start;
+    bool converting = false;
+    ui_next_us = start;
+    while(true) {
+        bool sensor = sensor_next_us <= ui_next_us;
+        int64_t due = sensor ? sensor_next_us : ui_next_us;
+        if(due >= end) break;
+        if(due > now_us) now_us = due;
+
+        if(!sensor) {
+            ui_pass();
+            continue;
+        }
+        aquarium_power_begin(POWER_ACT_SENSOR, now_us);
+        if(!converting) {
+            sensor_next_us = slot + CONV_US;
+            now_us += CONVERT_WAKE_US;
+        }
+        else {
+            sample.temp_centi = 2500;
+            sample.valid = true;
+            sample.eta_s = -1;
+            sample.seq = ++sample_seq;
+            aquarium_ui_notify_sample();
+            res->samples++;
+            slot += (int64_t)interval_ms * 1000;
+            sensor_next_us = slot;
+            now_us += READ_WAKE_US;
+        }
+        converting = !converting;
+        aquarium_power_end(POWER_ACT_SENSOR, now_us);
+    }
+
+    if(now_us < end) now_us = end;
+    aquarium_power_get_stats(now_us, &res->power);
+    res->frames = frames;
+}
+
+/*One turn of lvgl_task(): run the timers (twice if a refresh got due),
+ *then sleep until the next timer, at most MAX_WAIT_MS*/
+static void ui_pass(void)
+{
+    lv_tick_inc((uint32_t)((now_us - tick_us) / 1000));
+    tick_us = now_us - (now_us - tick_us) % 1000;
+
+    aquarium_power_begin(POWER_ACT_UI, now_us);
+    uint64_t bytes = panel_bytes;
+    uint32_t wait_ms = lv_timer_handler();
+    if(wait_ms == 0) wait_ms = lv_timer_handler();
+    if(wait_ms > MAX_WAIT_MS) wait_ms = MAX_WAIT_MS;
+    now_us += UI_PASS_US + (int64_t)PANEL_US(panel_bytes - bytes);
+    aquarium_power_end(POWER_ACT_UI, now_us);
+    ui_next_us = now_us + (int64_t)(wait_ms > 0 ? wait_ms : 1) * 1000;
+}
+
+/*Every us is either idle or active; on one core the tasks never overlap,
+ *so each activity starts from idle: one wake each*/
+static void check_accounting(const sim_result_t * res)
+{
+    TEST_ASSERT_EQUAL_UINT64(SIM_US, res->power.idle_us + res->power.active_us);
+    TEST_ASSERT_EQUAL_UINT32(2 * res->samples, res->power.act_wakes[POWER_ACT_SENSOR]);
+    TEST_ASSERT_EQUAL_UINT32(res->power.act_wakes[POWER_ACT_SENSOR] + res->power.act_wakes[POWER_ACT_UI],
+                             res->power.wakes);
+    TEST_ASSERT_EQUAL_UINT64(res->power.active_us, res->power.act_us[POWER_ACT_SENSOR] + res->power.act_us[POWER_ACT_UI]);
+}
+
+static uint32_t per_hour(uint32_t count)
+{
+    return (uint32_t)((uint64_t)count * 3600 * 1000000 / SIM_US);
+}
+
+#endif
@@ -0,0 +1,226 @@
+/**
+ * @file test_aquarium_resolution.c
+ * The resolution policy of main/aquarium_controller.c over simulated hours
+ * on the fake clock, one probe on the simulated bus (which truncates the
+ * reading to the resolution it is set to), reported like the device logs it
+ * (average conversion time, bus time saved against always 12 bits):
+ * - flat water far from TEMP_MIN_NORMAL/TEMP_MAX_NORMAL steps down to
+ *   9 bits, one bit per sample,
+ * - water cooling towards TEMP_MIN_NORMAL comes back up as the margin
+ *   shrinks, and is read at 12 bits once it is within RES_NEAR_LIMIT,
+ * - a fast change far from the limits is read at 12 bits.
+ */
+#if LV_BUILD_TEST
+#include "aquarium_controller_harness.c"
+#include <math.h>
+
+#include "unity/unity.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define HOUR_US             (3600LL * 1000000)
+#define CONV_12BIT_MS       750
+
+/*25.25 degC: 225 centi-degC above TEMP_MIN_NORMAL (beyond RES_FAR_LIMIT),
+ *its 9-bit code away from the rounding edge of the noise*/
+#define FLAT_CENTI          2525
+
+/*From FLAT_CENTI the water cools at RAMP_CENTI_H from RAMP_START_US, down
+ *to RAMP_FLOOR_CENTI (below the limit)*/
+#define RAMP_START_US       (2 * HOUR_US)
+#define RAMP_CENTI_H        (-50)
+#define RAMP_FLOOR_CENTI    2250
+
+/*A 1 degC step up, still far from TEMP_MAX_NORMAL*/
+#define STEP_AT_US          (2 * HOUR_US)
+#define STEP_CENTI          100
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct {
+    uint32_t samples;
+    uint32_t wrong_near;        /*Read below 12 bits within RES_NEAR_LIMIT*/
+    uint32_t near;              /*Samples taken within RES_NEAR_LIMIT*/
+    int64_t first_9bit_us;      /*-1: never*/
+    int64_t first_12bit_after_us;   /*First 12-bit sample after `after_us`*/
+} run_result_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void run(double (*water)(int64_t t_us), int64_t duration_us, int64_t after_us, run_result_t * res);
+static double flat(int64_t t_us);
+static double cooling(int64_t t_us);
+static double step(int64_t t_us);
+static void report(const char * name);
+static uint32_t rnd(void);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static onewire_bus_t * bus;
+static ds_reader_t reader;
+static uint32_t seed;
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+void setUp(void)
+{
+    TEST_ASSERT_EQUAL(ESP_OK, onewire_new_sim_bus(&bus));
+    onewire_sim_add_ds18b20(bus, 0x100001);
+    seed = 1;
+}
+
+void tearDown(void)
+{
+    onewire_del_bus(bus);
+}
+
+void test_flat_water_far_from_the_limits_is_read_at_9_bits(void)
+{
+    run_result_t res;
+    run(flat, 6 * HOUR_US, 0, &res);
+    report("flat");
+
+    /*12 bits without a previous reading and for the sample after it, then
+     *one bit down per sample while the interval doubles from 5 s: the
+     *fifth sample (0 + 5 + 10 + 20 + 40 s) is the first at 9 bits*/
+    TEST_ASSERT_EQUAL_UINT32(res.samples, g_conv_stats.samples);
+    TEST_ASSERT_EQUAL_UINT32(2, g_conv_stats.samples_at_bits[3]);
+    TEST_ASSERT_EQUAL_UINT32(1, g_conv_stats.samples_at_bits[2]);
+    TEST_ASSERT_EQUAL_UINT32(1, g_conv_stats.samples_at_bits[1]);
+    TEST_ASSERT_EQUAL_UINT32(res.samples - 4, g_conv_stats.samples_at_bits[0]);
+    TEST_ASSERT_EQUAL_INT64(75 * 1000000LL, res.first_9bit_us);
+
+    TEST_ASSERT_LESS_THAN_UINT64(CONV_12BIT_MS, g_conv_stats.conversion_ms_total / g_conv_stats.samples);
+    TEST_ASSERT_LESS_THAN_UINT64(ds18b20_conversion_time_ms(10),
+                                 g_conv_stats.conversion_ms_total / g_conv_stats.samples);
+    TEST_ASSERT_GREATER_THAN_UINT64(0, g_conv_stats.conversion_ms_saved);
+    TEST_ASSERT_EQUAL_UINT64((uint64_t)CONV_12BIT_MS * g_conv_stats.samples,
+                             g_conv_stats.conversion_ms_total + g_conv_stats.conversion_ms_saved);
+
+    /*The bus model agrees on the time spent converting*/
+    TEST_ASSERT_UINT64_WITHIN(g_conv_stats.samples * 2, g_conv_stats.conversion_ms_total,
+                              onewire_sim_get_stats(bus)->conversion_time_us / 1000);
+}
+
+void test_water_near_a_limit_is_read_at_12_bits(void)
+{
+    run_result_t res;
+    run(cooling, 10 * HOUR_US, 0, &res);
+    report("cooling");
+
+    /*Flat at first: down to 9 bits; every sample from the moment the water
+     *is published within RES_NEAR_LIMIT of TEMP_MIN_NORMAL (and below it)
+     *at 12 bits*/
+    TEST_ASSERT_GREATER_OR_EQUAL_INT64(0, res.first_9bit_us);
+    TEST_ASSERT_LESS_THAN_INT64(RAMP_START_US, res.first_9bit_us);
+    TEST_ASSERT_GREATER_THAN_UINT32(0, g_conv_stats.samples_at_bits[0]);
+    TEST_ASSERT_GREATER_THAN_UINT32(0, g_conv_stats.samples_at_bits[1]);
+    TEST_ASSERT_GREATER_THAN_UINT32(0, g_conv_stats.samples_at_bits[2]);
+    TEST_ASSERT_GREATER_THAN_UINT32(res.near / 2, g_conv_stats.samples_at_bits[3]);
+    TEST_ASSERT_GREATER_THAN_UINT32(0, res.near);
+    TEST_ASSERT_EQUAL_UINT32(0, res.wrong_near);
+
+    TEST_ASSERT_LESS_THAN_UINT64(CONV_12BIT_MS, g_conv_stats.conversion_ms_total / g_conv_stats.samples);
+    TEST_ASSERT_GREATER_THAN_UINT64(0, g_conv_stats.conversion_ms_saved);
+}
+
+void test_fast_change_is_read_at_12_bits(void)
+{
+    run_result_t res;
+    run(step, 3 * HOUR_US, STEP_AT_US, &res);
+    report("step");
+
+    /*At 9 bits when the step comes, 12 bits within the samples the filter
+     *takes to follow it (its rejects, then the restart)*/
+    TEST_ASSERT_GREATER_OR_EQUAL_INT64(0, res.first_9bit_us);
+    TEST_ASSERT_GREATER_OR_EQUAL_INT64(0, res.first_12bit_after_us);
+    TEST_ASSERT_LESS_OR_EQUAL_INT64(STEP_AT_US + (FILTER_MAX_REJECTS + 2) * (int64_t)TEMP_UPDATE_INTERVAL_MAX_MS * 1000,
+                                    res.first_12bit_after_us);
+    TEST_ASSERT_LESS_THAN_UINT64(CONV_12BIT_MS, g_conv_stats.conversion_ms_total / g_conv_stats.samples);
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+/*Samples with the probe following water(): its value in centi-degC at the
+ *slot, rounded to a 12-bit code plus an LSB of noise. Each sample's
+ *resolution comes from the split of g_conv_stats it added to.*/
+static void run(double (*water)(int64_t t_us), int64_t duration_us, int64_t after_us, run_result_t * res)
+{
+    memset(res, 0, sizeof(*res));
+    res->first_9bit_us = -1;
+    res->first_12bit_after_us = -1;
+    harness_start(bus, &reader);
+
+    while(esp_timer_get_time() < HARNESS_T0_US + duration_us) {
+        int64_t t = aquarium_host_timer_deadline() - HARNESS_T0_US;
+        if(res->samples == 0) t = 0;
+        int16_t raw = (int16_t)(lround(water(t) * 16 / 100) + (int)(rnd() % 3) - 1);
+        onewire_sim_set_temperature(bus, 0, raw);
+
+        /*What was published before this sample, which set its resolution*/
+        bool was_near = g_sensors[0].valid && g_sensors[0].temp_centi < TEMP_MIN_NORMAL + RES_NEAR_LIMIT;
+        uint32_t before[4];
+        memcpy(before, g_conv_stats.samples_at_bits, sizeof(before));
+
+        TEST_ASSERT_EQUAL(DS_RESULT_OK, harness_sample(&reader, 0));
+        res->samples++;
+        int bits = 0;
+        for(int b = 0; b < 4; b++) {
+            if(g_conv_stats.samples_at_bits[b] != before[b]) bits = DS18B20_RESOLUTION_MIN + b;
+        }
+        TEST_ASSERT_NOT_EQUAL(0, bits);
+
+        int64_t slot = reader.slot_us - HARNESS_T0_US;
+        if(bits == 9 && res->first_9bit_us < 0) res->first_9bit_us = slot;
+        if(bits == 12 && slot > after_us && after_us > 0 && res->first_12bit_after_us < 0) res->first_12bit_after_us = slot;
+        if(was_near) {
+            res->near++;
+            if(bits != 12) res->wrong_near++;
+        }
+    }
+}
+
+static double flat(int64_t t_us)
+{
+    (void)t_us;
+    return FLAT_CENTI;
+}
+
+static double cooling(int64_t t_us)
+{
+    if(t_us < RAMP_START_US) return FLAT_CENTI;
+    double centi = FLAT_CENTI + (double)(t_us - RAMP_START_US) * RAMP_CENTI_H / HOUR_US;
+    return centi > RAMP_FLOOR_CENTI ? centi : RAMP_FLOOR_CENTI;
+}
+
+static double step(int64_t t_us)
+{
+    return t_us < STEP_AT_US ? FLAT_CENTI : FLAT_CENTI + STEP_CENTI;
+}
+
+/*The line the controller logs every 100 samples, and the split*/
+static void report(const char * name)
+{
+    TEST_PRINTF("%s: %u samples (9/10/11/12 bits: %u/%u/%u/%u), avg conversion %u ms, %u ms saved", name,
+                (unsigned)g_conv_stats.samples, (unsigned)g_conv_stats.samples_at_bits[0],
+                (unsigned)g_conv_stats.samples_at_bits[1], (unsigned)g_conv_stats.samples_at_bits[2],
+                (unsigned)g_conv_stats.samples_at_bits[3],
+                (unsigned)(g_conv_stats.conversion_ms_total / g_conv_stats.samples),
+                (unsigned)g_conv_stats.conversion_ms_saved);
+}
+
+static uint32_t rnd(void)
+{
+    seed = seed * 1103515245u + 12345u;
+    return seed >> 8;
+}
+
+#endif
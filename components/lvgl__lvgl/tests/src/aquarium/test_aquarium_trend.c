@@ -0,0 +1,250 @@
+/**
+ * @file test_aquarium_trend.c
+ * The O(1) sliding regression (main/aquarium_trend.c) against a brute-force
+ * one that recomputes the window's sums from scratch after every sample:
+ * - an empty window (first sample, gap longer than the window) and a single
+ *   sample give no slope,
+ * - the window slides by age and by the ring's capacity, and the ring wraps
+ *   many times over,
+ * - the slope is exact on synthetic ramps, and within rounding of a
+ *   double-precision fit on a noisy stream,
+ * - the time-to-threshold follows the slope and the smoothed level.
+ */
+#if LV_BUILD_TEST
+#include "aquarium_trend.h"
+#include <math.h>
+
+#include "unity/unity.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define SAMPLES             20000
+#define WINDOW_S            1200        /*TREND_WINDOW_S*/
+#define MIN_SAMPLES         12
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void push(int32_t t, int16_t centi, aquarium_trend_result_t * res);
+static void check_against_brute_force(const aquarium_trend_result_t * res);
+static void generate(int n, int32_t max_step_s, bool gaps);
+static uint32_t rnd(void);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static aquarium_trend_t tr;
+static int32_t ref_t[SAMPLES];
+static int16_t ref_y[SAMPLES];
+static int ref_count;
+static int ref_first;           /*Oldest sample in the window*/
+static uint32_t seed;
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+void setUp(void)
+{
+    const aquarium_trend_config_t cfg = {WINDOW_S, MIN_SAMPLES, 3};
+    aquarium_trend_init(&tr, &cfg);
+    ref_count = 0;
+    ref_first = 0;
+    seed = 1;
+}
+
+void tearDown(void)
+{
+}
+
+void test_empty_window_and_single_sample_give_no_slope(void)
+{
+    const aquarium_trend_config_t cfg = {WINDOW_S, 1, 3};
+    aquarium_trend_init(&tr, &cfg);
+
+    /*The first sample: one point has no slope, whatever min_samples says*/
+    aquarium_trend_result_t res;
+    push(1000, 2500, &res);
+    TEST_ASSERT_FALSE(res.valid);
+    TEST_ASSERT_EQUAL_UINT16(1, res.samples);
+    TEST_ASSERT_EQUAL_INT16(2500, res.ewma);
+    TEST_ASSERT_EQUAL_INT32(TREND_NO_ETA, aquarium_trend_eta_s(&res, 2300, 2800, 10));
+
+    push(1005, 2506, &res);
+    TEST_ASSERT_TRUE(res.valid);
+    TEST_ASSERT_EQUAL_INT32(6 * 3600 / 5, res.slope_centi_h);
+
+    /*A gap longer than the window empties it: the new sample is alone again*/
+    push(1005 + WINDOW_S + 1, 2400, &res);
+    TEST_ASSERT_FALSE(res.valid);
+    TEST_ASSERT_EQUAL_UINT16(1, res.samples);
+    TEST_ASSERT_EQUAL_INT32(0, res.slope_centi_h);
+    check_against_brute_force(&res);
+
+    /*Exactly the window apart still counts as inside it*/
+    push(1005 + 2 * WINDOW_S + 1, 2412, &res);
+    TEST_ASSERT_TRUE(res.valid);
+    TEST_ASSERT_EQUAL_UINT16(2, res.samples);
+    TEST_ASSERT_EQUAL_INT32(12 * 3600 / WINDOW_S, res.slope_centi_h);
+    check_against_brute_force(&res);
+}
+
+void test_min_samples_holds_the_slope_back(void)
+{
+    aquarium_trend_result_t res;
+    for(int i = 0; i < MIN_SAMPLES; i++) {
+        push(i * 5, (int16_t)(2500 + i), &res);
+        TEST_ASSERT_EQUAL(i + 1 >= MIN_SAMPLES, res.valid);
+        check_against_brute_force(&res);
+    }
+}
+
+void test_ramps_are_exact(void)
+{
+    /*y = 2500 -+ t / 36 on a 36 s grid: exactly -+100 centi-degC per hour,
+     *through the ring wrapping and the window sliding*/
+    const int16_t dir[] = {-1, 1};
+    for(size_t d = 0; d < sizeof(dir) / sizeof(dir[0]); d++) {
+        setUp();
+        aquarium_trend_result_t res;
+        for(int i = 0; i < 2000; i++) {
+            push(i * 36, (int16_t)(2500 + dir[d] * i), &res);
+            if(i + 1 >= MIN_SAMPLES) TEST_ASSERT_EQUAL_INT32(dir[d] * 100, res.slope_centi_h);
+        }
+        TEST_ASSERT_EQUAL_UINT16(WINDOW_S / 36 + 1, res.samples);
+    }
+
+    /*Flat water: no slope, no time-to-threshold*/
+    setUp();
+    aquarium_trend_result_t res;
+    for(int i = 0; i < 500; i++) push(i * 5, 2500, &res);
+    TEST_ASSERT_TRUE(res.valid);
+    TEST_ASSERT_EQUAL_INT32(0, res.slope_centi_h);
+    TEST_ASSERT_EQUAL_INT16(2500, res.ewma);
+    TEST_ASSERT_EQUAL_INT32(TREND_NO_ETA, aquarium_trend_eta_s(&res, 2300, 2800, 10));
+}
+
+void test_eta_follows_the_slope(void)
+{
+    /*Heater dead: cooling at 50 centi-degC per hour from 25.00 degC*/
+    aquarium_trend_result_t res;
+    for(int i = 0; i < 400; i++) push(i * 72, (int16_t)(2500 - i), &res);
+    TEST_ASSERT_EQUAL_INT32(-50, res.slope_centi_h);
+    TEST_ASSERT_EQUAL_INT32((res.ewma - 2000) * 3600 / 50, aquarium_trend_eta_s(&res, 2000, 2800, 10));
+
+    /*Flatter than the minimum slope: none; already beyond the limit: now*/
+    TEST_ASSERT_EQUAL_INT32(TREND_NO_ETA, aquarium_trend_eta_s(&res, 2000, 2800, 51));
+    TEST_ASSERT_EQUAL_INT32(0, aquarium_trend_eta_s(&res, res.ewma, 2800, 10));
+    TEST_ASSERT_EQUAL_INT32(0, aquarium_trend_eta_s(&res, res.ewma + 100, 2800, 10));
+
+    /*Warming heads for the high limit*/
+    res.slope_centi_h = 50;
+    TEST_ASSERT_EQUAL_INT32((2800 - res.ewma) * 3600 / 50, aquarium_trend_eta_s(&res, 2000, 2800, 10));
+}
+
+void test_noisy_stream_matches_brute_force(void)
+{
+    /*5..20 s spacing with gaps: the window slides by age*/
+    generate(SAMPLES, 20, true);
+}
+
+void test_full_ring_matches_brute_force(void)
+{
+    /*1..2 s spacing: more samples than the ring holds in the window, so
+     *the capacity drops them*/
+    generate(SAMPLES, 2, false);
+    TEST_ASSERT_EQUAL_UINT16(TREND_RING_SIZE, tr.count);
+}
+
+void test_min_samples_one_matches_brute_force(void)
+{
+    const aquarium_trend_config_t cfg = {60, 1, 0};
+    aquarium_trend_init(&tr, &cfg);
+    generate(SAMPLES, 30, true);
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static void push(int32_t t, int16_t centi, aquarium_trend_result_t * res)
+{
+    ref_t[ref_count] = t;
+    ref_y[ref_count] = centi;
+    ref_count++;
+    aquarium_trend_push(&tr, t, centi, res);
+
+    /*The same window: at most the ring, nothing older than window_s*/
+    while(ref_count - ref_first > TREND_RING_SIZE || t - ref_t[ref_first] > (int32_t)tr.cfg.window_s) ref_first++;
+}
+
+/*Sums of the window from scratch, the same rounding; and a centred
+ *double-precision fit the integer slope must round from*/
+static void check_against_brute_force(const aquarium_trend_result_t * res)
+{
+    int64_t n = ref_count - ref_first;
+    TEST_ASSERT_EQUAL_UINT16(n, res->samples);
+
+    int64_t sx = 0, sy = 0, sxx = 0, sxy = 0;
+    double mx = 0, my = 0;
+    for(int i = ref_first; i < ref_count; i++) {
+        int64_t x = ref_t[i] - ref_t[ref_first];
+        sx += x;
+        sy += ref_y[i];
+        sxx += x * x;
+        sxy += x * ref_y[i];
+        mx += ref_t[i];
+        my += ref_y[i];
+    }
+    int64_t den = n * sxx - sx * sx;
+    bool valid = n >= tr.cfg.min_samples && den > 0;
+    TEST_ASSERT_EQUAL_MESSAGE(valid, res->valid, "valid");
+    if(!valid) {
+        TEST_ASSERT_EQUAL_INT32(0, res->slope_centi_h);
+        return;
+    }
+
+    int64_t num = (n * sxy - sx * sy) * 3600;
+    int64_t half = den / 2;
+    TEST_ASSERT_EQUAL_INT32_MESSAGE((num >= 0 ? num + half : num - half) / den, res->slope_centi_h, "slope");
+
+    mx /= (double)n;
+    my /= (double)n;
+    double dxy = 0, dxx = 0;
+    for(int i = ref_first; i < ref_count; i++) {
+        dxy += (ref_t[i] - mx) * (ref_y[i] - my);
+        dxx += (ref_t[i] - mx) * (ref_t[i] - mx);
+    }
+    TEST_ASSERT_TRUE_MESSAGE(fabs(dxy / dxx * 3600 - res->slope_centi_h) <= 0.5 + 1e-6, "double fit");
+}
+
+/*A random walk of 12-bit steps with drifts, spaced 1..max_step_s apart,
+ *now and then a gap longer than the window (reboot, bus down)*/
+static void generate(int n, int32_t max_step_s, bool gaps)
+{
+    int32_t t = 0;
+    int16_t v = 2500;
+    int drift = 0;
+    aquarium_trend_result_t res;
+    for(int i = 0; i < n; i++) {
+        uint32_t r = rnd();
+        if(r % 300 == 0) drift = (int)(rnd() % 7) - 3;
+        if(r % 5 == 0) v = (int16_t)(v + drift * 6);
+        if(r % 3 == 0) v = (int16_t)(v + ((r & 32) ? 6 : -6));
+        if(v < 500 || v > 5000) v = 2500;
+        if(gaps && r % 997 == 0) t += (int32_t)(tr.cfg.window_s + rnd() % (3 * tr.cfg.window_s));
+
+        push(t, v, &res);
+        check_against_brute_force(&res);
+        t += 1 + (int32_t)(rnd() % (uint32_t)max_step_s);
+    }
+}
+
+static uint32_t rnd(void)
+{
+    seed = seed * 1103515245u + 12345u;
+    return seed >> 8;
+}
+
+#endif
@@ -0,0 +1,281 @@
+/**
+ * @file test_aquarium_ui.c
+ * Golden images and budgets of the aquarium screen (main/aquarium_ui.c),
+ * one test per UI state: sensor lost, COLD, HOT, OPTIMAL.
+ *
+ * The screen is drawn like on the device: 172x320 RGB565, 20-line stripes,
+ * the flush filter, and a panel frame buffer that only gets what the filter
+ * lets through. Each test moves to a reference state, then publishes the
+ * state under test and checks
+ * - the invalidated area and the render time of that one update,
+ * - the panel image against ref_imgs/aquarium_<state>.png,
+ * - that a full lv_snapshot of the screen is the same image (an area that
+ *   should have been invalidated but was not shows up here).
+ * Two more publish readings the screen already shows: the same one again, and
+ * one that differs only below the displayed 0.1 degC. Neither may invalidate
+ * a pixel or start a refresh.
+ *
+ * The clock is frozen (no lv_tick_inc()): the status dot pulse stays at its
+ * first frame and the images are stable.
+ * A missing reference image is created from the current rendering.
+ */
+#if LV_BUILD_TEST
+#include "../lvgl.h"
+#include "aquarium_ui.h"
+#include "aquarium_controller.h"
+#include "LVGL_Flush_Filter.h"
+#include <time.h>
+
+#include "unity/unity.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define HOR_RES             172
+#define VER_RES             320
+#define BUF_LINES           20      /*LVGL_BUF_MIN_LINES*/
+
+/*Render time of one update on the host. Generous: it catches a state that
+ *suddenly redraws the whole screen or renders something slow, not jitter.*/
+#define RENDER_BUDGET_US    20000
+
+/*Invalidated area of one update (px) from the reference state, a little
+ *above the current figures: an update that grows shows up here*/
+#define INV_BUDGET_INVALID  25000
+#define INV_BUDGET_COLD     25000
+#define INV_BUDGET_HOT      25000
+#define INV_BUDGET_OPTIMAL  5200
+
+/*The reference state the tests start from: OPTIMAL at 25.0*/
+#define TEMP_REF            2500
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void flush_cb(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * color_p);
+static void rounder_cb(lv_disp_drv_t * drv, lv_area_t * area);
+static void monitor_cb(lv_disp_drv_t * drv, uint32_t time, uint32_t px);
+static void publish(int16_t temp_centi, bool valid);
+static uint32_t update_us(void);
+static void check_state(const char * ref_img, int16_t temp_centi, bool valid, uint32_t inv_budget);
+static void check_no_redraw(int16_t temp_centi);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static aquarium_sample_t sample;
+static uint32_t sample_seq;
+
+static lv_disp_t * disp;
+static lv_color_t buf1[HOR_RES * BUF_LINES];
+static lv_color_t buf2[HOR_RES * BUF_LINES];
+static uint32_t filter_hash[FLUSH_FILTER_HASHES(HOR_RES, VER_RES)];
+static flush_filter_t filter;
+
+static lv_color_t panel_fb[HOR_RES * VER_RES];      /*What the panel shows*/
+static lv_color_t snapshot_buf[HOR_RES * VER_RES];
+static lv_color32_t png_buf[HOR_RES * VER_RES];
+static uint32_t inv_px;
+static uint32_t refreshes;
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+/*The controller and the LVGL task, as seen by aquarium_ui.c*/
+bool aquarium_get_sample(int index, aquarium_sample_t * out)
+{
+    LV_UNUSED(index);
+    *out = sample;
+    return sample_seq != 0;
+}
+
+uint32_t aquarium_get_sample_seq(int index)
+{
+    LV_UNUSED(index);
+    return sample_seq;
+}
+
+bool LVGL_Lock(int timeout_ms)
+{
+    LV_UNUSED(timeout_ms);
+    return true;
+}
+
+void LVGL_Unlock(void)
+{
+}
+
+void LVGL_Wake(void)
+{
+}
+
+void setUp(void)
+{
+    if(disp) {
+        lv_disp_set_default(disp);
+        return;
+    }
+
+    /*Once: the screen lives across the tests like on the device*/
+    static lv_disp_draw_buf_t draw_buf;
+    lv_disp_draw_buf_init(&draw_buf, buf1, buf2, HOR_RES * BUF_LINES);
+    static lv_disp_drv_t disp_drv;
+    lv_disp_drv_init(&disp_drv);
+    disp_drv.hor_res = HOR_RES;
+    disp_drv.ver_res = VER_RES;
+    disp_drv.draw_buf = &draw_buf;
+    disp_drv.flush_cb = flush_cb;
+    disp_drv.rounder_cb = rounder_cb;
+    disp_drv.monitor_cb = monitor_cb;
+    Flush_Filter_Init(&filter, filter_hash, HOR_RES, VER_RES);
+    disp = lv_disp_drv_register(&disp_drv);
+    lv_disp_set_default(disp);
+
+    aquarium_ui_init();
+    lv_refr_now(disp);
+}
+
+void tearDown(void)
+{
+}
+
+void test_aquarium_ui_sensor_lost(void)
+{
+    check_state("aquarium_invalid.png", TEMP_REF, false, INV_BUDGET_INVALID);
+}
+
+void test_aquarium_ui_cold(void)
+{
+    check_state("aquarium_cold.png", 2200, true, INV_BUDGET_COLD);
+}
+
+void test_aquarium_ui_hot(void)
+{
+    check_state("aquarium_hot.png", 2950, true, INV_BUDGET_HOT);
+}
+
+void test_aquarium_ui_optimal(void)
+{
+    check_state("aquarium_optimal.png", 2530, true, INV_BUDGET_OPTIMAL);
+}
+
+void test_aquarium_ui_same_reading_draws_nothing(void)
+{
+    publish(TEMP_REF, true);
+    lv_refr_now(disp);
+
+    check_no_redraw(TEMP_REF);
+    check_no_redraw(TEMP_REF);
+}
+
+void test_aquarium_ui_change_below_a_tenth_draws_nothing(void)
+{
+    publish(TEMP_REF, true);
+    lv_refr_now(disp);
+
+    /*Both still round to 25.0*/
+    check_no_redraw(TEMP_REF + 3);
+    check_no_redraw(TEMP_REF - 4);
+
+    /*A tenth more is drawn: the counters do see an update*/
+    inv_px = 0;
+    refreshes = 0;
+    publish(TEMP_REF + 10, true);
+    lv_refr_now(disp);
+    TEST_ASSERT_GREATER_THAN_UINT32(0, inv_px);
+    TEST_ASSERT_EQUAL_UINT32(1, refreshes);
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static void flush_cb(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * color_p)
+{
+    lv_area_t window;
+    lv_color_t * px = Flush_Filter_Apply(&filter, area, color_p, &window);
+    if(px) {
+        lv_coord_t w = lv_area_get_width(&window);
+        lv_coord_t y;
+        for(y = window.y1; y <= window.y2; y++, px += w) {
+            lv_memcpy(&panel_fb[y * HOR_RES + window.x1], px, w * sizeof(lv_color_t));
+        }
+    }
+    lv_disp_flush_ready(drv);
+}
+
+static void rounder_cb(lv_disp_drv_t * drv, lv_area_t * area)
+{
+    LV_UNUSED(drv);
+    Flush_Filter_Round(&filter, area);
+}
+
+static void monitor_cb(lv_disp_drv_t * drv, uint32_t time, uint32_t px)
+{
+    LV_UNUSED(drv);
+    LV_UNUSED(time);
+    inv_px += px;
+    refreshes++;
+}
+
+/*A new sample, as the controller would publish it; the UI picks it up in its timer*/
+static void publish(int16_t temp_centi, bool valid)
+{
+    sample.temp_centi = temp_centi;
+    sample.valid = valid;
+    sample.eta_s = -1;
+    sample.seq = ++sample_seq;
+    aquarium_ui_notify_sample();
+    lv_timer_handler();
+}
+
+/*Render what the last publish() invalidated*/
+static uint32_t update_us(void)
+{
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    lv_refr_now(disp);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (uint32_t)((end.tv_sec - start.tv_sec) * 1000000 + (end.tv_nsec - start.tv_nsec) / 1000);
+}
+
+static void check_state(const char * ref_img, int16_t temp_centi, bool valid, uint32_t inv_budget)
+{
+    publish(TEMP_REF, true);
+    lv_refr_now(disp);
+
+    inv_px = 0;
+    publish(temp_centi, valid);
+    uint32_t us = update_us();
+    TEST_PRINTF("%s: %u px invalidated (budget %u), %u us (budget %u)", ref_img, (unsigned)inv_px,
+                (unsigned)inv_budget, (unsigned)us, (unsigned)RENDER_BUDGET_US);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(inv_budget, inv_px);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(RENDER_BUDGET_US, us);
+
+    /*The whole screen drawn from scratch must be what the updates left on the panel*/
+    lv_img_dsc_t dsc;
+    TEST_ASSERT_EQUAL_UINT32(sizeof(snapshot_buf), lv_snapshot_buf_size_needed(lv_scr_act(), LV_IMG_CF_TRUE_COLOR));
+    TEST_ASSERT_EQUAL(LV_RES_OK, lv_snapshot_take_to_buf(lv_scr_act(), LV_IMG_CF_TRUE_COLOR, &dsc, snapshot_buf,
+                                                         sizeof(snapshot_buf)));
+    TEST_ASSERT_EQUAL_MEMORY(snapshot_buf, panel_fb, sizeof(panel_fb));
+
+    uint32_t i;
+    for(i = 0; i < HOR_RES * VER_RES; i++) png_buf[i].full = lv_color_to32(panel_fb[i]);
+    TEST_ASSERT_EQUAL_BUF_SCREENSHOT(ref_img, png_buf, HOR_RES, VER_RES);
+}
+
+/*Publish a reading that shows like the one on screen: the update timer runs,
+ *finds nothing to change and leaves the screen valid*/
+static void check_no_redraw(int16_t temp_centi)
+{
+    inv_px = 0;
+    refreshes = 0;
+    publish(temp_centi, true);
+    TEST_ASSERT_EQUAL_UINT16(0, disp->inv_p);
+    lv_refr_now(disp);
+    TEST_ASSERT_EQUAL_UINT32(0, inv_px);
+    TEST_ASSERT_EQUAL_UINT32(0, refreshes);
+}
+
+#endif
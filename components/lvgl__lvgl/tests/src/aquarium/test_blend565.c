@@ -0,0 +1,219 @@
+/**
+ * @file test_blend565.c
+ * The SWAR RGB565 kernels of lv_draw_sw_blend.c must give the same pixels as the scalar
+ * blends (blend565_ref.c) bit by bit: solid fill, opacity fill, mask fill (with and without
+ * opacity) and opaque copy, at every destination/source alignment, odd and even widths and
+ * strides. The pixels around the blend area must stay untouched.
+ */
+#if LV_BUILD_TEST
+#include "../lvgl.h"
+#include "blend565_ref.h"
+
+#include "unity/unity.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define MAX_W       180
+#define MAX_H       4
+#define MAX_OFS     3                                   /*Start offset in pixels: every alignment*/
+#define POOL_PX     ((MAX_W + 8) * MAX_H + MAX_OFS + 8)
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static uint32_t rnd(void);
+static void fill_pool(lv_color_t * pool);
+static void fill_mask(lv_opa_t * mask, int32_t len);
+static void check_fill(int32_t ofs, int32_t w, int32_t h, lv_coord_t stride, lv_color_t color, lv_opa_t opa,
+                       bool masked);
+static void check_copy(int32_t ofs, int32_t src_ofs, int32_t w, int32_t h, lv_coord_t stride);
+static void check_equal(const char * what, int32_t ofs, int32_t w, int32_t h, lv_coord_t stride);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static uint32_t seed;
+
+/*uint32_t: word aligned, the offsets make every alignment*/
+static uint32_t pool_ref32[POOL_PX / 2 + 1];
+static uint32_t pool_sw32[POOL_PX / 2 + 1];
+static uint32_t pool_src32[POOL_PX / 2 + 1];
+static lv_opa_t mask_ref[MAX_W * MAX_H];
+static lv_opa_t mask_sw[MAX_W * MAX_H];
+
+static const int32_t widths[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 15, 16, 17, 33, 172, 173};
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+void setUp(void)
+{
+    seed = 12345;
+}
+
+void tearDown(void)
+{
+}
+
+void test_blend565_fill(void)
+{
+    static const lv_opa_t opas[] = {LV_OPA_COVER, LV_OPA_MAX, LV_OPA_MIN + 1, LV_OPA_50, 77, LV_OPA_MAX - 1};
+    uint32_t i;
+    for(i = 0; i < sizeof(widths) / sizeof(widths[0]); i++) {
+        int32_t w = widths[i];
+        int32_t ofs;
+        for(ofs = 0; ofs <= MAX_OFS; ofs++) {
+            uint32_t o;
+            for(o = 0; o < sizeof(opas) / sizeof(opas[0]); o++) {
+                lv_color_t color;
+                color.full = (uint16_t)rnd();
+                check_fill(ofs, w, 1, w, color, opas[o], false);
+                check_fill(ofs, w, MAX_H, w, color, opas[o], false);          /*Contiguous rows*/
+                check_fill(ofs, w, MAX_H, w + 1, color, opas[o], false);      /*Alignment changes per row*/
+                check_fill(ofs, w, MAX_H, w + 4, color, opas[o], false);
+                check_fill(ofs, w, MAX_H, w + 3, color, opas[o], true);
+                check_fill(ofs, w, MAX_H, w + 2, color, opas[o], true);
+            }
+        }
+    }
+}
+
+/*Every opacity and mask value on random backgrounds and colors*/
+void test_blend565_fill_every_mix(void)
+{
+    uint32_t v;
+    for(v = 0; v <= 255; v++) {
+        lv_color_t color;
+        color.full = (uint16_t)rnd();
+        if(v > LV_OPA_MIN && v < LV_OPA_MAX) check_fill(v & 1, 172, 2, 173, color, (lv_opa_t)v, false);
+
+        /*A flat mask, then the same with opacity*/
+        int32_t ofs = v & 3;
+        lv_memset(mask_ref, (uint8_t)v, sizeof(mask_ref));
+        lv_memcpy(mask_sw, mask_ref, sizeof(mask_sw));
+        fill_pool((lv_color_t *)pool_ref32);
+        lv_memcpy(pool_sw32, pool_ref32, sizeof(pool_sw32));
+        blend565_ref_fill((lv_color_t *)pool_ref32 + ofs, 172, 2, 172, color, LV_OPA_COVER, mask_ref, 172);
+        blend565_sw_fill((lv_color_t *)pool_sw32 + ofs, 172, 2, 172, color, LV_OPA_COVER, mask_sw);
+        check_equal("mask fill, every mask value", ofs, 172, 2, 172);
+
+        blend565_ref_fill((lv_color_t *)pool_ref32 + ofs, 172, 2, 172, color, LV_OPA_60, mask_ref, 172);
+        blend565_sw_fill((lv_color_t *)pool_sw32 + ofs, 172, 2, 172, color, LV_OPA_60, mask_sw);
+        check_equal("mask fill with opacity, every mask value", ofs, 172, 2, 172);
+    }
+}
+
+void test_blend565_copy(void)
+{
+    uint32_t i;
+    for(i = 0; i < sizeof(widths) / sizeof(widths[0]); i++) {
+        int32_t w = widths[i];
+        int32_t ofs;
+        for(ofs = 0; ofs <= MAX_OFS; ofs++) {
+            int32_t src_ofs;
+            for(src_ofs = 0; src_ofs <= MAX_OFS; src_ofs++) {
+                check_copy(ofs, src_ofs, w, 1, w);
+                check_copy(ofs, src_ofs, w, MAX_H, w);
+                check_copy(ofs, src_ofs, w, MAX_H, w + 1);
+                check_copy(ofs, src_ofs, w, MAX_H, w + 3);
+            }
+        }
+    }
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static uint32_t rnd(void)
+{
+    seed = seed * 1103515245u + 12345u;
+    return seed >> 8;
+}
+
+/*Runs of equal pixels (the result caches) and noise*/
+static void fill_pool(lv_color_t * pool)
+{
+    int32_t i = 0;
+    while(i < POOL_PX) {
+        lv_color_t c;
+        c.full = (uint16_t)rnd();
+        int32_t run = (rnd() & 3) == 0 ? (int32_t)(rnd() % 24) + 1 : 1;
+        while(run-- && i < POOL_PX) pool[i++] = c;
+    }
+}
+
+/*Transparent, covering, anti-aliased and runs of the same partial value (horizontal edges)*/
+static void fill_mask(lv_opa_t * mask, int32_t len)
+{
+    int32_t i;
+    for(i = 0; i < len; i++) {
+        switch(rnd() % 5) {
+            case 0:
+                mask[i] = LV_OPA_TRANSP;
+                break;
+            case 1:
+                mask[i] = LV_OPA_COVER;
+                break;
+            case 2:
+                mask[i] = i > 0 ? mask[i - 1] : LV_OPA_50;
+                break;
+            default:
+                mask[i] = (lv_opa_t)rnd();
+                break;
+        }
+    }
+}
+
+static void check_fill(int32_t ofs, int32_t w, int32_t h, lv_coord_t stride, lv_color_t color, lv_opa_t opa,
+                       bool masked)
+{
+    fill_pool((lv_color_t *)pool_ref32);
+    lv_memcpy(pool_sw32, pool_ref32, sizeof(pool_sw32));
+    if(masked) {
+        fill_mask(mask_ref, w * h);
+        lv_memcpy(mask_sw, mask_ref, sizeof(mask_sw));
+    }
+
+    blend565_ref_fill((lv_color_t *)pool_ref32 + ofs, w, h, stride, color, opa, masked ? mask_ref : NULL, w);
+    blend565_sw_fill((lv_color_t *)pool_sw32 + ofs, w, h, stride, color, opa, masked ? mask_sw : NULL);
+
+    char what[64];
+    lv_snprintf(what, sizeof(what), "%s fill, opa %d", masked ? "mask" : "plain", opa);
+    check_equal(what, ofs, w, h, stride);
+}
+
+static void check_copy(int32_t ofs, int32_t src_ofs, int32_t w, int32_t h, lv_coord_t stride)
+{
+    fill_pool((lv_color_t *)pool_ref32);
+    lv_memcpy(pool_sw32, pool_ref32, sizeof(pool_sw32));
+    fill_pool((lv_color_t *)pool_src32);
+
+    const lv_color_t * src = (const lv_color_t *)pool_src32 + src_ofs;
+    blend565_ref_copy((lv_color_t *)pool_ref32 + ofs, w, h, stride, src, w);
+    blend565_sw_copy((lv_color_t *)pool_sw32 + ofs, w, h, stride, src);
+
+    char what[64];
+    lv_snprintf(what, sizeof(what), "copy, source offset %d", (int)src_ofs);
+    check_equal(what, ofs, w, h, stride);
+}
+
+/*The whole pool: the blend area and what is around it*/
+static void check_equal(const char * what, int32_t ofs, int32_t w, int32_t h, lv_coord_t stride)
+{
+    const lv_color_t * ref = (const lv_color_t *)pool_ref32;
+    const lv_color_t * sw = (const lv_color_t *)pool_sw32;
+    int32_t i;
+    for(i = 0; i < POOL_PX; i++) {
+        if(ref[i].full != sw[i].full) {
+            char msg[160];
+            lv_snprintf(msg, sizeof(msg), "%s, offset %d, %dx%d, stride %d: pixel %d is 0x%04x, scalar 0x%04x",
+                        what, (int)ofs, (int)w, (int)h, (int)stride, (int)(i - ofs), sw[i].full, ref[i].full);
+            TEST_FAIL_MESSAGE(msg);
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,235 @@
+/**
+ * @file test_flush_filter.c
+ * The flush filter (main/LVGL_Driver/LVGL_Flush_Filter.c) on the device's
+ * 172 px rows: ten FLUSH_FILTER_BLOCK_W blocks and a last one of 12 px.
+ * Stripes of a noise frame go through the filter to a panel frame buffer
+ * that only gets the window it returns, like flush_cb does:
+ * - the first flush (and the first after a reset) sends the whole stripe,
+ * - an unchanged stripe sends nothing, a change sends only its blocks,
+ * - every single-pixel change of a stripe is flushed, the last partial
+ *   block included, as that block alone, its pixels packed,
+ * - an area the rounder did not align hashes its edge blocks partially.
+ * After every flush the panel must show the frame.
+ */
+#if LV_BUILD_TEST
+#include "../lvgl.h"
+#include "LVGL_Flush_Filter.h"
+
+#include "unity/unity.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define HOR_RES             172
+#define VER_RES             320
+#define BUF_LINES           20      /*LVGL_BUF_MIN_LINES*/
+#define LAST_BLOCK_X        ((FLUSH_FILTER_BLOCKS(HOR_RES) - 1) * FLUSH_FILTER_BLOCK_W)
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static lv_color_t * flush(const lv_area_t * area, lv_area_t * window);
+static void check_panel(const lv_area_t * area);
+static void check_single_block(lv_coord_t x, lv_coord_t y, const lv_area_t * area, const lv_area_t * window,
+                               const lv_color_t * px);
+static uint32_t rnd(void);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static flush_filter_t filter;
+static uint32_t filter_hash[FLUSH_FILTER_HASHES(HOR_RES, VER_RES)];
+static lv_color_t frame[HOR_RES * VER_RES];         /*What LVGL renders*/
+static lv_color_t panel_fb[HOR_RES * VER_RES];      /*What the panel shows*/
+static lv_color_t draw_buf[HOR_RES * BUF_LINES];
+static uint32_t seed;
+
+static const lv_area_t stripe = {0, 100, HOR_RES - 1, 100 + BUF_LINES - 1};
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+void setUp(void)
+{
+    seed = 1;
+    for(int i = 0; i < HOR_RES * VER_RES; i++) {
+        frame[i].full = (uint16_t)rnd();
+        panel_fb[i].full = (uint16_t)~frame[i].full;
+    }
+    Flush_Filter_Init(&filter, filter_hash, HOR_RES, VER_RES);
+}
+
+void tearDown(void)
+{
+}
+
+void test_first_flush_sends_everything(void)
+{
+    lv_area_t window;
+    TEST_ASSERT_NOT_NULL(flush(&stripe, &window));
+    TEST_ASSERT_EQUAL_MEMORY(&stripe, &window, sizeof(window));
+    check_panel(&stripe);
+
+    /*After a reset the panel content is unknown again*/
+    Flush_Filter_Reset(&filter);
+    TEST_ASSERT_NOT_NULL(flush(&stripe, &window));
+    TEST_ASSERT_EQUAL_MEMORY(&stripe, &window, sizeof(window));
+}
+
+void test_unchanged_blocks_are_skipped(void)
+{
+    lv_area_t window;
+    flush(&stripe, &window);
+    TEST_ASSERT_NULL(flush(&stripe, &window));
+
+    /*An area of the stripe, and the blocks of one row around a change*/
+    lv_area_t part = {FLUSH_FILTER_BLOCK_W, stripe.y1 + 3, 5 * FLUSH_FILTER_BLOCK_W - 1, stripe.y1 + 8};
+    TEST_ASSERT_NULL(flush(&part, &window));
+
+    frame[(stripe.y1 + 5) * HOR_RES + 3 * FLUSH_FILTER_BLOCK_W + 7].full ^= 0x0400;
+    lv_color_t * px = flush(&stripe, &window);
+    check_single_block(3 * FLUSH_FILTER_BLOCK_W + 7, stripe.y1 + 5, &stripe, &window, px);
+    TEST_ASSERT_NULL(flush(&stripe, &window));
+
+    /*Two changes: the window spans both, the rows between them included*/
+    frame[(stripe.y1 + 2) * HOR_RES + 20].full ^= 1;
+    frame[(stripe.y1 + 9) * HOR_RES + 150].full ^= 1;
+    px = flush(&stripe, &window);
+    TEST_ASSERT_NOT_NULL(px);
+    TEST_ASSERT_EQUAL_INT(FLUSH_FILTER_BLOCK_W, window.x1);
+    TEST_ASSERT_EQUAL_INT(10 * FLUSH_FILTER_BLOCK_W - 1, window.x2);
+    TEST_ASSERT_EQUAL_INT(stripe.y1 + 2, window.y1);
+    TEST_ASSERT_EQUAL_INT(stripe.y1 + 9, window.y2);
+    check_panel(&stripe);
+}
+
+void test_every_single_pixel_change_is_flushed(void)
+{
+    /*The lowest and the highest bit, and all of them*/
+    static const uint16_t flips[] = {0x0001, 0x8000, 0xffff};
+
+    lv_area_t window;
+    flush(&stripe, &window);
+    for(lv_coord_t y = stripe.y1; y <= stripe.y2; y++) {
+        for(lv_coord_t x = 0; x < HOR_RES; x++) {
+            for(size_t i = 0; i < sizeof(flips) / sizeof(flips[0]); i++) {
+                lv_color_t * p = &frame[y * HOR_RES + x];
+                p->full ^= flips[i];
+                check_single_block(x, y, &stripe, &window, flush(&stripe, &window));
+
+                /*And back*/
+                p->full ^= flips[i];
+                check_single_block(x, y, &stripe, &window, flush(&stripe, &window));
+            }
+        }
+    }
+    check_panel(&stripe);
+}
+
+void test_last_partial_block(void)
+{
+    lv_area_t window;
+    flush(&stripe, &window);
+
+    /*Its last pixel, on the last row of the stripe: 12 px wide window*/
+    frame[stripe.y2 * HOR_RES + HOR_RES - 1].full ^= 1;
+    lv_color_t * px = flush(&stripe, &window);
+    TEST_ASSERT_NOT_NULL(px);
+    TEST_ASSERT_EQUAL_INT(LAST_BLOCK_X, window.x1);
+    TEST_ASSERT_EQUAL_INT(HOR_RES - 1, window.x2);
+    TEST_ASSERT_EQUAL_INT(HOR_RES - LAST_BLOCK_X, lv_area_get_width(&window));
+    TEST_ASSERT_EQUAL_INT(stripe.y2, window.y1);
+    TEST_ASSERT_EQUAL_INT(stripe.y2, window.y2);
+    TEST_ASSERT_EQUAL_MEMORY(&frame[stripe.y2 * HOR_RES + LAST_BLOCK_X], px,
+                             (HOR_RES - LAST_BLOCK_X) * sizeof(lv_color_t));
+
+    /*The rounder never goes past the row*/
+    lv_area_t area = {LAST_BLOCK_X + 3, 0, HOR_RES - 2, 0};
+    Flush_Filter_Round(&filter, &area);
+    TEST_ASSERT_EQUAL_INT(LAST_BLOCK_X, area.x1);
+    TEST_ASSERT_EQUAL_INT(HOR_RES - 1, area.x2);
+}
+
+void test_unrounded_area_hashes_the_edge_blocks_partially(void)
+{
+    /*5..100: 11 px of block 0, 5 px of block 6*/
+    const lv_area_t area = {5, stripe.y1, 100, stripe.y2};
+    const lv_coord_t xs[] = {5, 15, 16, 95, 96, 100};
+
+    /*The panel already shows the stripe: only the edge blocks differ, the
+     *window is clipped to the area*/
+    lv_area_t window;
+    flush(&stripe, &window);
+    TEST_ASSERT_NOT_NULL(flush(&area, &window));
+    TEST_ASSERT_EQUAL_MEMORY(&area, &window, sizeof(window));
+    TEST_ASSERT_NULL(flush(&area, &window));
+
+    for(size_t i = 0; i < sizeof(xs) / sizeof(xs[0]); i++) {
+        frame[(stripe.y1 + 4) * HOR_RES + xs[i]].full ^= 1;
+        check_single_block(xs[i], stripe.y1 + 4, &area, &window, flush(&area, &window));
+    }
+    TEST_ASSERT_NULL(flush(&area, &window));
+
+    /*The whole blocks again: the partial hashes do not match them*/
+    TEST_ASSERT_NOT_NULL(flush(&stripe, &window));
+    TEST_ASSERT_EQUAL_INT(0, window.x1);
+    TEST_ASSERT_EQUAL_INT(7 * FLUSH_FILTER_BLOCK_W - 1, window.x2);
+    TEST_ASSERT_NULL(flush(&stripe, &window));
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+/*Render `area` of the frame into the draw buffer and flush it: the panel
+ *gets the window the filter returns*/
+static lv_color_t * flush(const lv_area_t * area, lv_area_t * window)
+{
+    lv_coord_t w = lv_area_get_width(area);
+    for(lv_coord_t y = area->y1; y <= area->y2; y++) {
+        lv_memcpy(&draw_buf[(y - area->y1) * w], &frame[y * HOR_RES + area->x1], w * sizeof(lv_color_t));
+    }
+
+    lv_color_t * px = Flush_Filter_Apply(&filter, area, draw_buf, window);
+    if(px == NULL) return NULL;
+
+    TEST_ASSERT_TRUE(_lv_area_is_in(window, area, 0));
+    lv_coord_t ww = lv_area_get_width(window);
+    for(lv_coord_t y = window->y1; y <= window->y2; y++) {
+        lv_memcpy(&panel_fb[y * HOR_RES + window->x1], &px[(y - window->y1) * ww], ww * sizeof(lv_color_t));
+    }
+    return px;
+}
+
+static void check_panel(const lv_area_t * area)
+{
+    for(lv_coord_t y = area->y1; y <= area->y2; y++) {
+        TEST_ASSERT_EQUAL_MEMORY(&frame[y * HOR_RES + area->x1], &panel_fb[y * HOR_RES + area->x1],
+                                 lv_area_get_width(area) * sizeof(lv_color_t));
+    }
+}
+
+/*Only the block of (x, y) (within the area) was sent, its pixels packed*/
+static void check_single_block(lv_coord_t x, lv_coord_t y, const lv_area_t * area, const lv_area_t * window,
+                               const lv_color_t * px)
+{
+    lv_coord_t x1 = LV_MAX(area->x1, x - x % FLUSH_FILTER_BLOCK_W);
+    lv_coord_t x2 = LV_MIN(area->x2, x - x % FLUSH_FILTER_BLOCK_W + FLUSH_FILTER_BLOCK_W - 1);
+
+    TEST_ASSERT_NOT_NULL_MESSAGE(px, "a single-pixel change was skipped");
+    TEST_ASSERT_EQUAL_INT(x1, window->x1);
+    TEST_ASSERT_EQUAL_INT(x2, window->x2);
+    TEST_ASSERT_EQUAL_INT(y, window->y1);
+    TEST_ASSERT_EQUAL_INT(y, window->y2);
+    TEST_ASSERT_EQUAL_MEMORY(&frame[y * HOR_RES + x1], px, (x2 - x1 + 1) * sizeof(lv_color_t));
+    check_panel(area);
+}
+
+static uint32_t rnd(void)
+{
+    seed = seed * 1103515245u + 12345u;
+    return seed >> 8;
+}
+
+#endif
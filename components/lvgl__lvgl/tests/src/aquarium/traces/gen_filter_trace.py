@@ -0,0 +1,58 @@
+#!/usr/bin/env python3
+"""
+Writes filter_spikes.csv, the trace filter_replay runs in ctest: 4 hours of
+one probe at the controller's 5 s slots and 12 bits, on a noisy long cable.
+
+- Truth: 25 degC with a slow swing, a step to 22.5 degC for 30 min (water
+  change) and back, a 0.1 degC/min ramp to 28.5 degC (heater stuck) and back.
+- Reading: truth + 1 LSB of noise, quantized to 1/16 degC, then converted to
+  centi-degC like ds18b20_raw_to_centi().
+- 1% of the readings are CRC-valid spikes of 3..23 degC either way.
+
+Columns: time in seconds, reading and truth in centi-degC. The output only
+depends on the seed; re-run to regenerate.
+"""
+
+import math
+import os
+import random
+
+SEED = 11
+SLOT_S = 5
+HOURS = 4
+SPIKE_RATE = 0.01
+
+
+def truth_at(t):
+    base = 2500 + 30 * math.sin(2 * math.pi * t / 5400)
+    if 3600 <= t < 5400:
+        return 2250
+    if 9000 <= t < 10200:
+        return min(2850, base + (t - 9000) / 60 * 10)
+    if 10200 <= t < 10800:
+        return 2850
+    return base
+
+
+def raw_to_centi(raw):
+    q = raw * 25
+    return (q + 2) // 4 if q >= 0 else -((-q + 2) // 4)
+
+
+def main():
+    rnd = random.Random(SEED)
+    path = os.path.join(os.path.dirname(os.path.abspath(__file__)), "filter_spikes.csv")
+    with open(path, "w") as f:
+        f.write("# gen_filter_trace.py: t_s,centi,truth_centi\n")
+        for i in range(HOURS * 3600 // SLOT_S):
+            t = i * SLOT_S
+            truth = truth_at(t)
+            raw = round(truth * 16 / 100 + rnd.gauss(0, 1))
+            centi = raw_to_centi(raw)
+            if rnd.random() < SPIKE_RATE:
+                centi += rnd.choice((-1, 1)) * rnd.randint(300, 2300)
+            f.write("%d,%d,%d\n" % (t, centi, round(truth)))
+
+
+if __name__ == "__main__":
+    main()
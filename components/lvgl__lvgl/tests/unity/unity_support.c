@@ -66,24 +66,27 @@ static void png_release(png_img_t * p);
 
 bool lv_test_assert_img_eq(const char * fn_ref)
 {
-    char fn_ref_full[512];
-    sprintf(fn_ref_full, "%s%s", REF_IMGS_PATH, fn_ref);
-
-    uint8_t * screen_buf;
-
     lv_obj_invalidate(lv_scr_act());
     lv_refr_now(NULL);
 
     extern lv_color32_t test_fb[];
 
-    screen_buf = (uint8_t *)test_fb;
+    return lv_test_assert_buf_eq(fn_ref, test_fb, 800, 480);
+}
+
+bool lv_test_assert_buf_eq(const char * fn_ref, const lv_color32_t * buf, uint32_t width, uint32_t height)
+{
+    char fn_ref_full[512];
+    sprintf(fn_ref_full, "%s%s", REF_IMGS_PATH, fn_ref);
+
+    uint8_t * screen_buf = (uint8_t *)buf;
 
     png_img_t p;
     int res = read_png_file(&p, fn_ref_full);
     if(res == ERR_FILE_NOT_FOUND) {
         TEST_PRINTF("%s%s", fn_ref_full, " was not found, creating is now from the rendered screen");
         fflush(stderr);
-        write_png_file(screen_buf, 800, 480, fn_ref_full);
+        write_png_file(screen_buf, width, height, fn_ref_full);
 
         return true;
     }
@@ -91,6 +94,12 @@ bool lv_test_assert_img_eq(const char * fn_ref)
         return false;
     }
 
+    if((uint32_t)p.width != width || (uint32_t)p.height != height) {
+        TEST_PRINTF("%s is %dx%d, the screen is %ux%u", fn_ref_full, p.width, p.height, (unsigned)width, (unsigned)height);
+        png_release(&p);
+        return false;
+    }
+
     uint8_t * ptr_act = NULL;
     const png_byte * ptr_ref = NULL;
 
@@ -128,7 +137,7 @@ bool lv_test_assert_img_eq(const char * fn_ref)
         char fn_err_full[512];
         sprintf(fn_err_full, "%s%s_err.png", REF_IMGS_PATH, fn_ref_no_ext);
 
-        write_png_file(screen_buf, 800, 480, fn_err_full);
+        write_png_file(screen_buf, width, height, fn_err_full);
     }
 
     png_release(&p);
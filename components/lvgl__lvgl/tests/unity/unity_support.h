@@ -10,6 +10,7 @@ extern "C" {
 #include "../../lvgl.h"
 
 bool lv_test_assert_img_eq(const char * fn_ref);
+bool lv_test_assert_buf_eq(const char * fn_ref, const lv_color32_t * buf, uint32_t width, uint32_t height);
 
 
 #if LV_COLOR_DEPTH != 32
@@ -31,6 +32,9 @@ bool lv_test_assert_img_eq(const char * fn_ref);
                                                             }
 #endif
 
+/*Compare an image already rendered to a 32 bit buffer (e.g. an lv_snapshot converted), any color depth*/
+#  define TEST_ASSERT_EQUAL_BUF_SCREENSHOT(path, buf, w, h)  TEST_ASSERT(lv_test_assert_buf_eq(path, buf, w, h))
+
 #  define TEST_ASSERT_EQUAL_COLOR(c1, c2)                   TEST_ASSERT_EQUAL_UINT32(c1.full, c2.full)
 #  define TEST_ASSERT_EQUAL_COLOR_MESSAGE(c1, c2, msg)      TEST_ASSERT_EQUAL_UINT32_MESSAGE(c1.full, c2.full, msg)
 
@@ -3,6 +3,7 @@
 static const char *TAG_LCD = "WS_LCD";
 
 esp_lcd_panel_handle_t panel_handle = NULL;
+static volatile bool lcd_asleep = false;
 
 void LCD_Init(void)
 {
@@ -60,6 +61,23 @@ void LCD_Init(void)
 
 }
 
+// Panel sleep (SLPIN/SLPOUT). The caller must hold the LVGL lock: the flush
+// path uses the same panel IO. While asleep, flushes are dropped.
+void LCD_Sleep(bool sleep)
+{
+    if (sleep == lcd_asleep) {
+        return;
+    }
+    lcd_asleep = sleep;
+    esp_lcd_panel_disp_sleep(panel_handle, sleep);
+    ESP_LOGI(TAG_LCD, "Panel %s", sleep ? "sleep-in" : "sleep-out");
+}
+
+bool LCD_Is_Asleep(void)
+{
+    return lcd_asleep;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Backlight program
 static ledc_channel_config_t ledc_channel;
@@ -73,12 +91,13 @@ void BK_Init(void)
     ESP_ERROR_CHECK(gpio_config(&bk_gpio_config));
     
     // 配置LEDC
+    // RC_FAST clock: the PWM (and a running fade) keeps going through light sleep
     ledc_timer_config_t ledc_timer = {
-        .duty_resolution = LEDC_TIMER_13_BIT,
+        .duty_resolution = LEDC_ResolutionRatio,
         .freq_hz = 5000,
         .speed_mode = LEDC_LS_MODE,
         .timer_num = LEDC_HS_TIMER,
-        .clk_cfg = LEDC_AUTO_CLK
+        .clk_cfg = LEDC_USE_RC_FAST_CLK
     };
     ledc_timer_config(&ledc_timer);
 
@@ -87,16 +106,25 @@ void BK_Init(void)
     ledc_channel.gpio_num   = EXAMPLE_PIN_NUM_BK_LIGHT;
     ledc_channel.speed_mode = LEDC_LS_MODE;
     ledc_channel.timer_sel  = LEDC_HS_TIMER;
+    ledc_channel.sleep_mode = LEDC_SLEEP_MODE_KEEP_ALIVE;
     ledc_channel_config(&ledc_channel);
     ledc_fade_func_install(0);
 }
+static uint32_t BK_Duty(uint8_t Light)
+{
+    if(Light > 100) Light = 100;
+    return (uint32_t)LEDC_MAX_Duty * Light / 100;
+}
 void BK_Light(uint8_t Light)
 {   
-    if(Light > 100) Light = 100;
-    uint16_t Duty = LEDC_MAX_Duty-(81*(100-Light));
-    if(Light == 0) Duty = 0;
     // 设置PWM占空比
-    ledc_set_duty(ledc_channel.speed_mode, ledc_channel.channel, Duty);
+    ledc_set_duty(ledc_channel.speed_mode, ledc_channel.channel, BK_Duty(Light));
     ledc_update_duty(ledc_channel.speed_mode, ledc_channel.channel);
 }
+// Hardware fade: the LEDC steps the duty itself, no CPU time or interrupts until the end
+void BK_Fade(uint8_t Light, uint32_t time_ms)
+{
+    ledc_set_fade_with_time(ledc_channel.speed_mode, ledc_channel.channel, BK_Duty(Light), time_ms);
+    ledc_fade_start(ledc_channel.speed_mode, ledc_channel.channel, LEDC_FADE_NO_WAIT);
+}
 // end Backlight program
\ No newline at end of file
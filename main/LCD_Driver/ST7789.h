@@ -44,7 +44,7 @@
 #define LEDC_HS_CH0_GPIO       EXAMPLE_PIN_NUM_BK_LIGHT
 #define LEDC_HS_CH0_CHANNEL    LEDC_CHANNEL_0
 #define LEDC_TEST_DUTY         (4000)
-#define LEDC_ResolutionRatio   LEDC_TIMER_13_BIT
+#define LEDC_ResolutionRatio   LEDC_TIMER_11_BIT                          // RC_FAST (~17.5MHz) / 5kHz
 #define LEDC_MAX_Duty          ((1 << LEDC_ResolutionRatio) - 1)
 
 
@@ -52,5 +52,9 @@ extern esp_lcd_panel_handle_t panel_handle;
 
 void BK_Init(void);                             // Initialize the LCD backlight, which has been called in the LCD_Init function, ignore it                                                         
 void BK_Light(uint8_t Light);                   // Call this function to adjust the brightness of the backlight. The value of the parameter Light ranges from 0 to 100
+void BK_Fade(uint8_t Light, uint32_t time_ms);  // Hardware fade to Light (0-100) over time_ms, returns at once
+
+void LCD_Sleep(bool sleep);                     // ST7789 SLPIN/SLPOUT (hold the LVGL lock); frame memory is kept
+bool LCD_Is_Asleep(void);
 
 void LCD_Init(void);                     // Call this function to initialize the screen (must be called in the main function) !!!!!
\ No newline at end of file
@@ -36,6 +36,7 @@ static esp_err_t panel_st7789t_mirror(esp_lcd_panel_t *panel, bool mirror_x, boo
 static esp_err_t panel_st7789t_swap_xy(esp_lcd_panel_t *panel, bool swap_axes);
 static esp_err_t panel_st7789t_set_gap(esp_lcd_panel_t *panel, int x_gap, int y_gap);
 static esp_err_t panel_st7789t_disp_on_off(esp_lcd_panel_t *panel, bool off);
+static esp_err_t panel_st7789t_disp_sleep(esp_lcd_panel_t *panel, bool sleep);
 
 typedef struct {
     esp_lcd_panel_t base;
@@ -109,6 +110,7 @@ esp_err_t esp_lcd_new_panel_st7789t(const esp_lcd_panel_io_handle_t io, const es
     st7789t->base.mirror = panel_st7789t_mirror;
     st7789t->base.swap_xy = panel_st7789t_swap_xy;
     st7789t->base.disp_on_off = panel_st7789t_disp_on_off;
+    st7789t->base.disp_sleep = panel_st7789t_disp_sleep;
     *ret_panel = &(st7789t->base);
     ESP_LOGD(TAG, "new st7789t panel @%p", st7789t);
     // printf("AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA\r\n");
@@ -305,3 +307,16 @@ static esp_err_t panel_st7789t_disp_on_off(esp_lcd_panel_t *panel, bool on_off)
     esp_lcd_panel_io_tx_param(io, command, NULL, 0);
     return ESP_OK;
 }
+
+// SLPIN keeps the frame memory: the picture comes back as it was after SLPOUT.
+// The controller needs 5 ms before the next command and 120 ms after SLPOUT
+// before sleeping again (or before the picture is stable); the caller spaces
+// transitions accordingly.
+static esp_err_t panel_st7789t_disp_sleep(esp_lcd_panel_t *panel, bool sleep)
+{
+    st7789t_panel_t *st7789t = __containerof(panel, st7789t_panel_t, base);
+    esp_lcd_panel_io_handle_t io = st7789t->io;
+    esp_lcd_panel_io_tx_param(io, sleep ? LCD_CMD_SLPIN : LCD_CMD_SLPOUT, NULL, 0);
+    vTaskDelay(pdMS_TO_TICKS(5));
+    return ESP_OK;
+}
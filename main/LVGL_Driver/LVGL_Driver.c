@@ -1,44 +1,116 @@
 #include "LVGL_Driver.h"
+#include "aquarium_power.h"
+#include "esp_heap_caps.h"
 
 static const char *TAG_LVGL = "WS_LVGL";
 
-static lv_color_t buf1[ LVGL_BUF_LEN ];
-static lv_color_t buf2[ LVGL_BUF_LEN];
-// static lv_color_t* buf1 = (lv_color_t*) heap_caps_malloc(LVGL_BUF_LEN , MALLOC_CAP_SPIRAM);
-// static lv_color_t* buf2 = (lv_color_t*) heap_caps_malloc(LVGL_BUF_LEN , MALLOC_CAP_SPIRAM);
-    
+#if configTASK_NOTIFICATION_ARRAY_ENTRIES <= LVGL_NOTIFY_FLUSH
+#error "LVGL needs CONFIG_FREERTOS_TASK_NOTIFICATION_ARRAY_ENTRIES >= 2 (flush-done apart from wake requests)"
+#endif
+
+static lv_color_t *buf1;                                                      // Two stripes: LVGL renders into one while the other is on the SPI DMA
+static lv_color_t *buf2;
+
 
 lv_disp_draw_buf_t disp_buf;                                                 // contains internal graphic buffer(s) called draw buffer(s)
 lv_disp_drv_t disp_drv;                                                      // contains callback functions
-    
-void example_increase_lvgl_tick(void *arg)
-{
-    /* Tell LVGL how many milliseconds has elapsed */
-    lv_tick_inc(EXAMPLE_LVGL_TICK_PERIOD_MS);
-}
 
+static SemaphoreHandle_t lvgl_mutex = NULL;                                   // Recursive: LVGL callbacks may call the UI API
+static TaskHandle_t lvgl_task_handle = NULL;
+static lvgl_service_cb_t lvgl_service = NULL;
+
+static lvgl_stats_t lvgl_stats;
+static lvgl_stats_t stats_window;                                             // Counters at the start of the rate window
+static int64_t stats_window_us;
+static int64_t frame_start_us;
+static int64_t frame_wait_us;
+
+#if LVGL_FLUSH_FILTER
+static uint32_t *flush_filter_hash;                                           // Internal RAM, taken out of the draw buffer budget
+static flush_filter_t flush_filter;
+#endif
+    
 bool example_notify_lvgl_flush_ready(esp_lcd_panel_io_handle_t panel_io, esp_lcd_panel_io_event_data_t *edata, void *user_ctx)
 {
     lv_disp_drv_t *disp_driver = (lv_disp_drv_t *)user_ctx;
     lv_disp_flush_ready(disp_driver);
-    return false;
+    // Wake the LVGL task blocked in example_lvgl_wait_cb (its own slot: the idle loop does not see it)
+    BaseType_t woken = pdFALSE;
+    if (lvgl_task_handle) {
+        vTaskNotifyGiveIndexedFromISR(lvgl_task_handle, LVGL_NOTIFY_FLUSH, &woken);
+    }
+    return woken == pdTRUE;
+}
+
+/* LVGL waits for a flush to finish: block instead of spinning on the flag (spurious wakes just loop) */
+void example_lvgl_wait_cb(lv_disp_drv_t *drv)
+{
+    int64_t start = esp_timer_get_time();
+    if (xTaskGetCurrentTaskHandle() == lvgl_task_handle) {
+        ulTaskNotifyTakeIndexed(LVGL_NOTIFY_FLUSH, pdTRUE, pdMS_TO_TICKS(LVGL_FLUSH_WAIT_MS));
+    }
+    int64_t waited = esp_timer_get_time() - start;
+    frame_wait_us += waited;
+    lvgl_stats.flush_wait_us += waited;
+}
+
+/* A refresh starts: its render time runs until the last stripe is handed to the panel */
+void example_lvgl_render_start_cb(lv_disp_drv_t *drv)
+{
+    frame_start_us = esp_timer_get_time();
+    frame_wait_us = 0;
+    if (lvgl_task_handle) {
+        ulTaskNotifyValueClearIndexed(lvgl_task_handle, LVGL_NOTIFY_FLUSH, UINT32_MAX);   // The last frame's final flush-done
+    }
 }
 
 void example_lvgl_flush_cb(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map)
 {
     esp_lcd_panel_handle_t panel_handle = (esp_lcd_panel_handle_t) drv->user_data;
+    lvgl_stats.stripes++;
+    if (lv_disp_flush_is_last(drv)) {
+        lvgl_stats.frames++;
+        lvgl_stats.render_us += esp_timer_get_time() - frame_start_us - frame_wait_us;
+    }
+    if (LCD_Is_Asleep()) {
+        lv_disp_flush_ready(drv);                                                                       // No SPI traffic while the panel sleeps
+        return;
+    }
+#if LVGL_FLUSH_FILTER
+    lv_area_t window;
+    lv_color_t *changed = Flush_Filter_Apply(&flush_filter, area, color_map, &window);
+    lvgl_stats.filtered_bytes += (lv_area_get_size(area) - (changed ? lv_area_get_size(&window) : 0)) * sizeof(lv_color_t);
+    if (changed == NULL) {
+        lv_disp_flush_ready(drv);                                                                       // The panel already shows all of it
+        return;
+    }
+    area = &window;
+    color_map = changed;
+#endif
     int offsetx1 = area->x1;
     int offsetx2 = area->x2;
     int offsety1 = area->y1;
     int offsety2 = area->y2;
+    lvgl_stats.flush_bytes += lv_area_get_size(area) * sizeof(lv_color_t);
     // copy a buffer's content to a specific area of the display
     esp_lcd_panel_draw_bitmap(panel_handle, offsetx1 + Offset_X, offsety1 + Offset_Y, offsetx2 + Offset_X + 1, offsety2 + Offset_Y + 1, color_map);
 }
 
+/* Invalidated areas widened to whole flush filter blocks, so every block can be compared */
+void example_lvgl_rounder_cb(lv_disp_drv_t *drv, lv_area_t *area)
+{
+#if LVGL_FLUSH_FILTER
+    Flush_Filter_Round(&flush_filter, area);
+#endif
+}
+
 /* Rotate display and touch, when rotated screen in LVGL. Called when driver parameters are updated. */
 void example_lvgl_port_update_callback(lv_disp_drv_t *drv)
 {
     esp_lcd_panel_handle_t panel_handle = (esp_lcd_panel_handle_t) drv->user_data;
+#if LVGL_FLUSH_FILTER
+    Flush_Filter_Reset(&flush_filter);                                                                  // New orientation: the hashes no longer match the panel
+#endif
 
     switch (drv->rotated) {
     case LV_DISP_ROT_NONE:
@@ -64,6 +136,50 @@ void example_lvgl_port_update_callback(lv_disp_drv_t *drv)
     }
 }
 
+/* Two stripe buffers from internal DMA RAM: the budget above the reserve, stepped down if fragmented */
+static uint32_t lvgl_alloc_buffers(void)
+{
+    const uint32_t caps = MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA;
+    const size_t line_bytes = EXAMPLE_LCD_H_RES * sizeof(lv_color_t);
+    size_t free_bytes = heap_caps_get_free_size(caps);
+    size_t filter_bytes = 0;
+#if LVGL_FLUSH_FILTER
+    // Same pool as the stripes and the reserve: it costs stripe lines, not Matter's RAM
+    filter_bytes = FLUSH_FILTER_HASHES(EXAMPLE_LCD_H_RES, EXAMPLE_LCD_V_RES) * sizeof(uint32_t);
+    flush_filter_hash = heap_caps_malloc(filter_bytes, MALLOC_CAP_INTERNAL);
+    if (flush_filter_hash == NULL) {
+        ESP_LOGE(TAG_LVGL, "❌ No RAM for the flush filter (%u bytes)", (unsigned)filter_bytes);
+        ESP_ERROR_CHECK(ESP_ERR_NO_MEM);
+    }
+#endif
+    size_t used = LVGL_BUF_HEAP_RESERVE + filter_bytes;
+    size_t budget = free_bytes > used ? free_bytes - used : 0;
+    uint32_t lines = budget / (2 * line_bytes);
+    if (lines > LVGL_BUF_MAX_LINES) {
+        lines = LVGL_BUF_MAX_LINES;
+    }
+    if (lines < LVGL_BUF_MIN_LINES) {
+        lines = LVGL_BUF_MIN_LINES;
+    }
+    for (;;) {
+        buf1 = heap_caps_malloc(lines * line_bytes, caps);
+        buf2 = heap_caps_malloc(lines * line_bytes, caps);
+        if (buf1 && buf2) {
+            break;
+        }
+        heap_caps_free(buf1);
+        heap_caps_free(buf2);
+        if (lines == LVGL_BUF_MIN_LINES) {
+            ESP_LOGE(TAG_LVGL, "❌ No RAM for two %d-line draw buffers", LVGL_BUF_MIN_LINES);
+            ESP_ERROR_CHECK(ESP_ERR_NO_MEM);
+        }
+        lines = lines * 3 / 4 > LVGL_BUF_MIN_LINES ? lines * 3 / 4 : LVGL_BUF_MIN_LINES;
+    }
+    ESP_LOGI(TAG_LVGL, "Draw buffers: 2 x %lu lines (%u bytes each, flush filter %u bytes, %u bytes were free)",
+             (unsigned long)lines, (unsigned)(lines * line_bytes), (unsigned)filter_bytes, (unsigned)free_bytes);
+    return lines;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 lv_disp_t *disp;
 void LVGL_Init(void)
@@ -71,7 +187,8 @@ void LVGL_Init(void)
     ESP_LOGI(TAG_LVGL, "Initialize LVGL library");
     lv_init();
     
-    lv_disp_draw_buf_init(&disp_buf, buf1, buf2, LVGL_BUF_LEN );                              // initialize LVGL draw buffers
+    lvgl_stats.buf_lines = lvgl_alloc_buffers();
+    lv_disp_draw_buf_init(&disp_buf, buf1, buf2, EXAMPLE_LCD_H_RES * lvgl_stats.buf_lines);              // initialize LVGL draw buffers
 
     ESP_LOGI(TAG_LVGL, "Register display driver to LVGL");
     lv_disp_drv_init(&disp_drv);                                                                        // Create a new screen object and initialize the associated device
@@ -79,22 +196,126 @@ void LVGL_Init(void)
     disp_drv.ver_res = EXAMPLE_LCD_V_RES;                                                     // Horizontal pixel count
     // disp_drv.rotated = LV_DISP_ROT_90; // 图像旋转                                                            // Vertical axis pixel count
     disp_drv.flush_cb = example_lvgl_flush_cb;                                                          // Function : copy a buffer's content to a specific area of the display
+    disp_drv.wait_cb = example_lvgl_wait_cb;                                                            // Function : sleep while a flush is in progress
+    disp_drv.render_start_cb = example_lvgl_render_start_cb;                                            // Function : start of a refresh (render time)
+#if LVGL_FLUSH_FILTER
+    Flush_Filter_Init(&flush_filter, flush_filter_hash, EXAMPLE_LCD_H_RES, EXAMPLE_LCD_V_RES);
+    disp_drv.rounder_cb = example_lvgl_rounder_cb;                                                      // Function : align areas to the flush filter blocks
+#endif
     disp_drv.drv_update_cb = example_lvgl_port_update_callback;                                         // Function : Rotate display and touch, when rotated screen in LVGL. Called when driver parameters are updated. 
     disp_drv.draw_buf = &disp_buf;                                                                      // LVGL will use this buffer(s) to draw the screens contents
     disp_drv.user_data = panel_handle;                
     ESP_LOGI(TAG_LVGL,"Register display indev to LVGL");                                                  // Custom display driver user data
     disp = lv_disp_drv_register(&disp_drv);                                                  // Create screen objects
     
-    /********************* LVGL *********************/
-    ESP_LOGI(TAG_LVGL, "Install LVGL tick timer");
-    // Tick interface for LVGL (using esp_timer to generate 2ms periodic event)
-    const esp_timer_create_args_t lvgl_tick_timer_args = {
-        .callback = &example_increase_lvgl_tick,
-        .name = "lvgl_tick"
-    };
-    
-    esp_timer_handle_t lvgl_tick_timer = NULL;
-    ESP_ERROR_CHECK(esp_timer_create(&lvgl_tick_timer_args, &lvgl_tick_timer));
-    ESP_ERROR_CHECK(esp_timer_start_periodic(lvgl_tick_timer, EXAMPLE_LVGL_TICK_PERIOD_MS * 1000));
+    // Tick: LV_TICK_CUSTOM reads esp_timer_get_time(), no periodic timer waking the chip
+    lvgl_mutex = xSemaphoreCreateRecursiveMutex();
+}
 
+bool LVGL_Lock(int timeout_ms)
+{
+    TickType_t ticks = timeout_ms < 0 ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+    return xSemaphoreTakeRecursive(lvgl_mutex, ticks) == pdTRUE;
+}
+
+void LVGL_Unlock(void)
+{
+    xSemaphoreGiveRecursive(lvgl_mutex);
+}
+
+void LVGL_Wake(void)
+{
+    if (lvgl_task_handle) {
+        xTaskNotifyGiveIndexed(lvgl_task_handle, LVGL_NOTIFY_WAKE);
+    }
+}
+
+void LVGL_Wake_FromISR(BaseType_t *woken)
+{
+    if (lvgl_task_handle) {
+        vTaskNotifyGiveIndexedFromISR(lvgl_task_handle, LVGL_NOTIFY_WAKE, woken);
+    }
+}
+
+void LVGL_Set_Service(lvgl_service_cb_t cb)
+{
+    lvgl_service = cb;
+}
+
+/* Per-minute rates, worked out when the task runs anyway (no wake of its own) */
+static void lvgl_stats_roll(int64_t now_us)
+{
+    int64_t elapsed_us = now_us - stats_window_us;
+    if (elapsed_us < (int64_t)LVGL_STATS_PERIOD_MS * 1000) {
+        return;
+    }
+    uint32_t frames = lvgl_stats.frames - stats_window.frames;
+    uint64_t bytes = lvgl_stats.flush_bytes - stats_window.flush_bytes;
+    lvgl_stats.frames_per_min = (uint32_t)((uint64_t)frames * 60000000ULL / elapsed_us);
+    lvgl_stats.flush_bytes_per_min = (uint32_t)(bytes * 60000000ULL / elapsed_us);
+    if (frames) {
+        lvgl_stats.flush_bytes_per_frame = (uint32_t)(bytes / frames);
+        lvgl_stats.stripes_per_frame_x10 = (lvgl_stats.stripes - stats_window.stripes) * 10 / frames;
+        lvgl_stats.render_us_per_frame = (uint32_t)((lvgl_stats.render_us - stats_window.render_us) / frames);
+        lvgl_stats.flush_wait_us_per_frame = (uint32_t)((lvgl_stats.flush_wait_us - stats_window.flush_wait_us) / frames);
+    }
+    lvgl_stats.heap_free = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    lvgl_stats.heap_min_free = heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL);
+    stats_window_us = now_us;
+    stats_window = lvgl_stats;
+    ESP_LOGI(TAG_LVGL, "UI: %lu frames/min, %lu KB/min to the panel (%lu B/frame, %llu KB filtered so far)",
+             (unsigned long)lvgl_stats.frames_per_min, (unsigned long)(lvgl_stats.flush_bytes_per_min / 1024),
+             (unsigned long)lvgl_stats.flush_bytes_per_frame, (unsigned long long)(lvgl_stats.filtered_bytes / 1024));
+    if (frames) {
+        ESP_LOGI(TAG_LVGL, "UI frame: %lu.%lu stripes of <= %u lines, render %lu us, flush wait %lu us",
+                 (unsigned long)(lvgl_stats.stripes_per_frame_x10 / 10), (unsigned long)(lvgl_stats.stripes_per_frame_x10 % 10),
+                 lvgl_stats.buf_lines, (unsigned long)lvgl_stats.render_us_per_frame,
+                 (unsigned long)lvgl_stats.flush_wait_us_per_frame);
+    }
+    ESP_LOGI(TAG_LVGL, "UI heap: %lu bytes free, %lu lowest since boot (draw buffers 2 x %u lines, reserve %u)",
+             (unsigned long)lvgl_stats.heap_free, (unsigned long)lvgl_stats.heap_min_free,
+             lvgl_stats.buf_lines, (unsigned)LVGL_BUF_HEAP_RESERVE);
+}
+
+void LVGL_Get_Stats(lvgl_stats_t *out)
+{
+    LVGL_Lock(-1);
+    *out = lvgl_stats;
+    LVGL_Unlock();
+}
+
+/* One pass over the service hook and the LVGL timers; returns ms until the next is due */
+static uint32_t lvgl_run(void)
+{
+    LVGL_Lock(-1);
+    uint32_t service_ms = lvgl_service ? lvgl_service() : LV_NO_TIMER_READY;
+    uint32_t wait_ms = lv_timer_handler();
+    lvgl_stats_roll(esp_timer_get_time());
+    LVGL_Unlock();
+    return service_ms < wait_ms ? service_ms : wait_ms;
+}
+
+/* Run LVGL timers, then sleep until the next one is due or somebody calls LVGL_Wake() */
+static void lvgl_task(void *arg)
+{
+    ESP_LOGI(TAG_LVGL, "LVGL task started");
+    while (1) {
+        aquarium_power_begin(POWER_ACT_UI, esp_timer_get_time());
+        uint32_t wait_ms = lvgl_run();
+        if (wait_ms == 0) {
+            wait_ms = lvgl_run();                                                                  // A timer got due during the pass (refresh after an animation step)
+        }
+        if (wait_ms > LVGL_TASK_MAX_WAIT_MS) {
+            wait_ms = LVGL_TASK_MAX_WAIT_MS;                                                       // Also LV_NO_TIMER_READY
+        }
+        TickType_t ticks = pdMS_TO_TICKS(wait_ms);
+        aquarium_power_end(POWER_ACT_UI, esp_timer_get_time());
+        ulTaskNotifyTakeIndexed(LVGL_NOTIFY_WAKE, pdTRUE, ticks > 0 ? ticks : 1);
+    }
+}
+
+void LVGL_Start_Task(void)
+{
+    stats_window_us = esp_timer_get_time();
+    xTaskCreatePinnedToCore(lvgl_task, "lvgl", LVGL_TASK_STACK, NULL, LVGL_TASK_PRIORITY, &lvgl_task_handle, 0);
 }
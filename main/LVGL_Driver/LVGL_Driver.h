@@ -2,6 +2,7 @@
 #include <stdio.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 #include "esp_timer.h"
 #include "esp_err.h"
 #include "esp_log.h"
@@ -9,9 +10,43 @@
 #include "demos/lv_demos.h"
 
 #include "ST7789.h"
+#include "LVGL_Flush_Filter.h"
 
-#define LVGL_BUF_LEN  (EXAMPLE_LCD_H_RES * 20)
-#define EXAMPLE_LVGL_TICK_PERIOD_MS    2
+// Draw buffers: two stripes of internal DMA RAM, as tall as the heap allows at LVGL_Init() once the reserve
+// and the flush filter's hashes are set aside
+#define LVGL_BUF_MIN_LINES      20                                         // Floor (also the old fixed size)
+#define LVGL_BUF_MAX_LINES      40                                         // 8 stripes per full frame. Conservative until "UI heap" (logged per minute) is read after Matter commissioning; full-frame buffers make LVGL 8.3 wait for each flush before rendering
+#define LVGL_BUF_HEAP_RESERVE   (160 * 1024)                               // Left free for WiFi + Matter, which start later (an estimate, not measured yet)
+
+// LVGL service task: runs lv_timer_handler() and sleeps until the deadline it returns
+#define LVGL_TASK_STACK         6144
+#define LVGL_TASK_PRIORITY      4                                          // Below the aquarium task (6)
+#define LVGL_TASK_MAX_WAIT_MS   5000                                       // Longest sleep with no LVGL timer due
+#define LVGL_FLUSH_WAIT_MS      20                                         // wait_cb block per check while a flush runs
+// Task notification slots of the LVGL task (CONFIG_FREERTOS_TASK_NOTIFICATION_ARRAY_ENTRIES >= 2): a wake
+// request is never eaten by wait_cb mid-frame, and the last stripe's flush-done does not wake the idle loop
+#define LVGL_NOTIFY_WAKE        0                                          // LVGL_Wake(): run the timers now
+#define LVGL_NOTIFY_FLUSH       1                                          // Flush-done ISR -> wait_cb
+#define LVGL_STATS_PERIOD_MS    60000                                      // Rate window for frames / SPI bytes (logged)
+#define LVGL_FLUSH_FILTER       1                                          // Send only pixel blocks the panel does not show yet (14 KB of row hashes, allocated with the draw buffers: fewer stripe lines, same reserve)
+
+typedef struct {
+    uint32_t frames;                                                       // Refreshes rendered (also while the panel sleeps)
+    uint32_t stripes;                                                      // flush_cb calls
+    uint64_t flush_bytes;                                                  // Pixel data sent to the panel
+    uint64_t filtered_bytes;                                               // Rendered but already on the panel (flush filter)
+    uint64_t render_us;                                                    // Refresh start -> last stripe handed over, minus flush waits
+    uint64_t flush_wait_us;                                                // Blocked until the other buffer's DMA was done
+    uint16_t buf_lines;                                                    // Draw buffer height chosen at boot
+    uint32_t heap_free;                                                    // Internal RAM free at the last rate window
+    uint32_t heap_min_free;                                                // Lowest internal free RAM since boot: the margin LVGL_BUF_HEAP_RESERVE left
+    uint32_t frames_per_min;                                               // Last complete window
+    uint32_t flush_bytes_per_min;
+    uint32_t flush_bytes_per_frame;
+    uint32_t stripes_per_frame_x10;
+    uint32_t render_us_per_frame;
+    uint32_t flush_wait_us_per_frame;
+} lvgl_stats_t;
 
 extern lv_disp_draw_buf_t disp_buf;                                                 // contains internal graphic buffer(s) called draw buffer(s)
 extern lv_disp_drv_t disp_drv;                                                      // contains callback functions
@@ -21,6 +56,20 @@ bool example_notify_lvgl_flush_ready(esp_lcd_panel_io_handle_t panel_io, esp_lcd
 void example_lvgl_flush_cb(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map);
 /* Rotate display and touch, when rotated screen in LVGL. Called when driver parameters are updated. */
 void example_lvgl_port_update_callback(lv_disp_drv_t *drv);
-void example_increase_lvgl_tick(void *arg);
+void example_lvgl_wait_cb(lv_disp_drv_t *drv);
+void example_lvgl_rounder_cb(lv_disp_drv_t *drv, lv_area_t *area);
+void example_lvgl_render_start_cb(lv_disp_drv_t *drv);
+
+void LVGL_Init(void);                     // Call this function to initialize the screen (must be called in the main function) !!!!!
+
+/* Runs in the LVGL task, under the lock, before each lv_timer_handler(); returns ms until it wants to run again */
+typedef uint32_t (*lvgl_service_cb_t)(void);
 
-void LVGL_Init(void);                     // Call this function to initialize the screen (must be called in the main function) !!!!!
\ No newline at end of file
+/* Other tasks must hold the lock around any lv_* call once the LVGL task runs (timeout_ms < 0: wait forever) */
+bool LVGL_Lock(int timeout_ms);
+void LVGL_Unlock(void);
+void LVGL_Wake(void);                     // Run lv_timer_handler() now (e.g. after lv_timer_ready)
+void LVGL_Wake_FromISR(BaseType_t *woken);
+void LVGL_Set_Service(lvgl_service_cb_t cb);   // One hook (display power states), set before LVGL_Start_Task()
+void LVGL_Start_Task(void);               // After the UI is built
+void LVGL_Get_Stats(lvgl_stats_t *out);   // Takes the lock
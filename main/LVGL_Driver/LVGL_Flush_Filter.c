@@ -0,0 +1,85 @@
+#include "LVGL_Flush_Filter.h"
+#include <string.h>
+
+/* FNV-1a over the pixels, seeded with the column range: equal hashes mean the same pixels at the same place */
+static uint32_t block_hash(const lv_color_t *px, lv_coord_t x1, lv_coord_t len)
+{
+    uint32_t h = (2166136261u ^ ((uint32_t)x1 << 16 | (uint32_t)len)) * 16777619u;
+    for (lv_coord_t i = 0; i < len; i++) {
+        h = (h ^ px[i].full) * 16777619u;
+    }
+    return h ? h : 1;                                                      // 0 is "unknown"
+}
+
+void Flush_Filter_Init(flush_filter_t *f, uint32_t *hash, lv_coord_t hor_res, lv_coord_t ver_res)
+{
+    f->hash = hash;
+    f->hor_res = hor_res;
+    f->ver_res = ver_res;
+    f->blocks = FLUSH_FILTER_BLOCKS(hor_res);
+    Flush_Filter_Reset(f);
+}
+
+void Flush_Filter_Reset(flush_filter_t *f)
+{
+    memset(f->hash, 0, (size_t)f->blocks * f->ver_res * sizeof(f->hash[0]));
+}
+
+void Flush_Filter_Round(const flush_filter_t *f, lv_area_t *area)
+{
+    area->x1 -= area->x1 % FLUSH_FILTER_BLOCK_W;
+    area->x2 += FLUSH_FILTER_BLOCK_W - 1 - area->x2 % FLUSH_FILTER_BLOCK_W;
+    if (area->x2 >= f->hor_res) {
+        area->x2 = f->hor_res - 1;
+    }
+}
+
+lv_color_t *Flush_Filter_Apply(flush_filter_t *f, const lv_area_t *area, lv_color_t *color_map, lv_area_t *window)
+{
+    lv_coord_t w = lv_area_get_width(area);
+    int first = area->x1 / FLUSH_FILTER_BLOCK_W;
+    int last = area->x2 / FLUSH_FILTER_BLOCK_W;
+    int changed_first = last + 1, changed_last = -1;
+    lv_coord_t changed_y1 = area->y2 + 1, changed_y2 = area->y1 - 1;
+
+    const lv_color_t *row = color_map;
+    for (lv_coord_t y = area->y1; y <= area->y2; y++, row += w) {
+        uint32_t *hash = f->hash + (uint32_t)y * f->blocks;
+        bool row_changed = false;
+        for (int b = first; b <= last; b++) {
+            // Edge blocks of an unrounded area are hashed partially, the seed keeps them apart
+            lv_coord_t x1 = LV_MAX(area->x1, b * FLUSH_FILTER_BLOCK_W);
+            lv_coord_t x2 = LV_MIN(area->x2, b * FLUSH_FILTER_BLOCK_W + FLUSH_FILTER_BLOCK_W - 1);
+            uint32_t h = block_hash(row + (x1 - area->x1), x1, x2 - x1 + 1);
+            if (h != hash[b]) {
+                hash[b] = h;
+                row_changed = true;
+                changed_first = LV_MIN(changed_first, b);
+                changed_last = LV_MAX(changed_last, b);
+            }
+        }
+        if (row_changed) {
+            changed_y1 = LV_MIN(changed_y1, y);
+            changed_y2 = y;
+        }
+    }
+    if (changed_last < 0) {
+        return NULL;
+    }
+
+    window->x1 = LV_MAX(area->x1, changed_first * FLUSH_FILTER_BLOCK_W);
+    window->x2 = LV_MIN(area->x2, changed_last * FLUSH_FILTER_BLOCK_W + FLUSH_FILTER_BLOCK_W - 1);
+    window->y1 = changed_y1;
+    window->y2 = changed_y2;
+
+    lv_color_t *out = color_map + (uint32_t)(changed_y1 - area->y1) * w;
+    lv_coord_t out_w = lv_area_get_width(window);
+    if (out_w != w) {
+        // Narrower: pack the rows (forward, each lands at or before its source)
+        lv_coord_t skip = window->x1 - area->x1;
+        for (lv_coord_t r = 0; r < lv_area_get_height(window); r++) {
+            memmove(out + (uint32_t)r * out_w, out + (uint32_t)r * w + skip, (size_t)out_w * sizeof(lv_color_t));
+        }
+    }
+    return out;
+}
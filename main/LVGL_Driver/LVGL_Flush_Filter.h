@@ -0,0 +1,37 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "lvgl.h"
+
+/*
+ * Flush filter: keeps what was last sent to the panel as one hash per row and
+ * FLUSH_FILTER_BLOCK_W-pixel column block, and trims each flushed stripe to the
+ * blocks that differ. Rows of unchanged text or background inside a wide
+ * invalidation never reach the SPI bus.
+ *
+ * Partial render mode only: the stripe is packed in place, LVGL renders the
+ * next one from scratch. Needs only lvgl.h, so it runs on the host too.
+ */
+
+#define FLUSH_FILTER_BLOCK_W   16                                          // Even; the rounder aligns flush areas to it
+#define FLUSH_FILTER_BLOCKS(hor_res)            (((hor_res) + FLUSH_FILTER_BLOCK_W - 1) / FLUSH_FILTER_BLOCK_W)
+#define FLUSH_FILTER_HASHES(hor_res, ver_res)   (FLUSH_FILTER_BLOCKS(hor_res) * (ver_res))
+
+typedef struct {
+    uint32_t *hash;                                                        // FLUSH_FILTER_HASHES() entries, 0 = unknown
+    lv_coord_t hor_res;
+    lv_coord_t ver_res;
+    uint16_t blocks;                                                       // Per row
+} flush_filter_t;
+
+void Flush_Filter_Init(flush_filter_t *f, uint32_t *hash, lv_coord_t hor_res, lv_coord_t ver_res);
+void Flush_Filter_Reset(flush_filter_t *f);                                // Panel content unknown (reset, rotation): send everything once
+void Flush_Filter_Round(const flush_filter_t *f, lv_area_t *area);         // rounder_cb: whole blocks horizontally
+
+/*
+ * Compare a rendered stripe with what the panel shows and record it.
+ * Returns NULL if every block is unchanged; otherwise the changed window
+ * (*window, whole blocks, rows from the first to the last changed one) and
+ * its pixels, contiguous.
+ */
+lv_color_t *Flush_Filter_Apply(flush_filter_t *f, const lv_area_t *area, lv_color_t *color_map, lv_area_t *window);
@@ -33,6 +33,10 @@ static const char* SOFTWARE_VERSION_STRING = "1.0.0";
 // Matter endpoint ID
 static uint16_t temperature_endpoint_id = 0;
 
+// Vendor-specific attributes on Temperature Measurement (MEI: vendor 0xFFF1)
+static const uint32_t ATTR_TREND_SLOPE_ID = 0xFFF10000;   // int16, 0.01°C per hour
+static const uint32_t ATTR_TREND_ETA_ID   = 0xFFF10001;   // int32, seconds (-1 = none)
+
 /**
  * Matter attribute update callback
  */
@@ -153,6 +157,11 @@ bool aquarium_matter_init(void)
     temperature_endpoint_id = endpoint::get_id(endpoint);
     ESP_LOGI(TAG, "Temperature sensor endpoint created: 0x%x", temperature_endpoint_id);
     
+    // Trend attributes (readable by any Matter controller, ignored by HomeKit)
+    cluster_t *temp_cluster = cluster::get(endpoint, TemperatureMeasurement::Id);
+    attribute::create(temp_cluster, ATTR_TREND_SLOPE_ID, ATTRIBUTE_FLAG_NONE, esp_matter_int16(0));
+    attribute::create(temp_cluster, ATTR_TREND_ETA_ID, ATTRIBUTE_FLAG_NONE, esp_matter_int32(-1));
+    
     // Set device information (manufacturer, model, etc.)
     set_device_info(node);
     
@@ -184,23 +193,46 @@ bool aquarium_matter_init(void)
 /**
  * Update Matter temperature - Called from aquarium_controller.c
  */
-extern "C" void aquarium_matter_update_temperature(float temp_celsius)
+extern "C" void aquarium_matter_update_temperature(int16_t temp_centi)
 {
     if (temperature_endpoint_id == 0) {
         return;
     }
     
-    // Convert to Matter format (0.01°C resolution)
-    int16_t temp_matter = (int16_t)(temp_celsius * 100.0f);
-    
-    // Update attribute
-    esp_matter_attr_val_t val = esp_matter_nullable_int16(temp_matter);
+    // Matter MeasuredValue is already 0.01°C: no conversion
+    esp_matter_attr_val_t val = esp_matter_nullable_int16(temp_centi);
     attribute::update(temperature_endpoint_id, 
                       TemperatureMeasurement::Id,
                       TemperatureMeasurement::Attributes::MeasuredValue::Id, 
                       &val);
 }
 
+/**
+ * Update trend attributes - Called from aquarium_controller.c
+ */
+extern "C" void aquarium_matter_update_trend(int16_t slope_centi_h, int32_t eta_s)
+{
+    static int16_t last_slope = 0;
+    static int32_t last_eta = -1;
+    
+    if (temperature_endpoint_id == 0) {
+        return;
+    }
+    
+    // Only changed values, so subscribers don't get a report every sample
+    if (slope_centi_h != last_slope) {
+        esp_matter_attr_val_t val = esp_matter_int16(slope_centi_h);
+        attribute::update(temperature_endpoint_id, TemperatureMeasurement::Id, ATTR_TREND_SLOPE_ID, &val);
+        last_slope = slope_centi_h;
+    }
+    // ETA in whole minutes is enough for a report
+    if (eta_s / 60 != last_eta / 60 || (eta_s < 0) != (last_eta < 0)) {
+        esp_matter_attr_val_t val = esp_matter_int32(eta_s);
+        attribute::update(temperature_endpoint_id, TemperatureMeasurement::Id, ATTR_TREND_ETA_ID, &val);
+        last_eta = eta_s;
+    }
+}
+
 /**
  * Print QR code for commissioning
  */
@@ -29,9 +29,18 @@ bool aquarium_matter_init(void);
 /**
  * Update Matter temperature attribute
  * 
- * @param temp_celsius Temperature in Celsius
+ * @param temp_centi Temperature in 0.01°C (Matter MeasuredValue units)
  */
-void aquarium_matter_update_temperature(float temp_celsius);
+void aquarium_matter_update_temperature(int16_t temp_centi);
+
+/**
+ * Update the vendor-specific trend attributes (Temperature Measurement
+ * cluster, test vendor 0xFFF1): slope and time-to-threshold
+ * 
+ * @param slope_centi_h Slope in 0.01°C per hour
+ * @param eta_s Seconds until a limit is reached, -1 if none
+ */
+void aquarium_matter_update_trend(int16_t slope_centi_h, int32_t eta_s);
 
 /**
  * Start Matter commissioning (pairing mode)
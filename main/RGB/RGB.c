@@ -16,6 +16,7 @@ void RGB_Init(void)
         .max_leds = 1,
     };
     led_strip_rmt_config_t rmt_config = {
+        .clk_src = RMT_CLK_SRC_XTAL,        // No PM lock: the LED latches, light sleep stays allowed
         .resolution_hz = 10 * 1000 * 1000,  // 10MHz
         .flags.with_dma = false,
     };
@@ -101,6 +101,10 @@ void wifi_sta_start(void)
     ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
     ESP_ERROR_CHECK(esp_wifi_start());
 
+    // Modem sleep: the radio wakes for DTIM beacons, the association (and
+    // Matter) stays up while the SoC light-sleeps between samples
+    esp_wifi_set_ps(WIFI_PS_MIN_MODEM);
+
     // 1) Scan FIRST (no connect yet)
     wifi_scan_print();
 
@@ -2,249 +2,646 @@
  * @file aquarium_controller.c
  * @brief Aquarium Temperature Controller
  * 
- * - DS18B20 temperature reading every 5 seconds
+ * - DS18B20 temperature reading every 5-60 s, adaptive (stretched while flat)
  * - RGB LED at 18% brightness
  * - Matter/HomeKit updates
- * - Critical sections for reliable OneWire timing
+ * - RMT-timed 1-Wire (bit-bang fallback with critical sections)
+ * - Non-blocking read: esp_timer wakes the task for each conversion phase
+ * - Drift-free sampling: absolute slot deadlines, jitter/overrun statistics
+ * - Optional alarm mode: TH/TL in the probes, Alarm Search instead of reads
+ * - Median + Kalman filter rejects single-sample spikes before publication
+ * - Trend: O(1) sliding regression slope + time-to-threshold (UI, Matter)
+ * - Multiple probes: ROM search + one broadcast Convert T per sample
+ * - Adaptive 9..12-bit resolution: short conversions while the water is stable
+ * - Samples published lock-free (seqlock) to the UI and other readers
+ * - 64 KB delta-encoded history of the primary sensor (days at 5-60 s, adaptive)
+ * - Integer centi-degC from scratchpad to LED, UI, Matter and logs (no FPU)
+ * - Power: PM lock and 1-Wire peripheral held only while the task works
  */
 
 #include "aquarium_controller.h"
+#include "aquarium_power.h"
+#include "aquarium_ui.h"
 #include "RGB.h"
 #include "esp_log.h"
 #include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 #include "driver/gpio.h"
-#include "esp_attr.h"
-#include <math.h>
+#include "ds18b20.h"
+#include "onewire_sim.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
 #include "Matter/aquarium_matter.h"
 
 static const char *TAG = "AQUARIUM";
 
-// Global temperature storage
-static float g_last_temperature = NAN;
-static bool g_temperature_valid = false;
+// Sensor table (filled by ROM search). Owned by the aquarium task; other
+// tasks read the published copies in g_samples.
+static aquarium_sample_t g_sensors[AQUARIUM_MAX_SENSORS];
+static int g_sensor_count = 0;
+
+static aquarium_filter_t g_filters[AQUARIUM_MAX_SENSORS];
+static aquarium_sample_slot_t g_samples[AQUARIUM_MAX_SENSORS];
+static atomic_int g_published_count;
 
 // Max retries for reading
 #define MAX_READ_RETRIES 3
 
+// Pause before a retry
+#define DS_RETRY_DELAY_MS     100
+
+// Adaptive resolution: 12-bit near a threshold or while the water moves,
+// stepping down to 9-bit (94ms instead of 750ms) when stable and far away
+// (all centi-degC)
+#define RES_NEAR_LIMIT        50      // Closer than this to a limit: 12-bit
+#define RES_MID_LIMIT         100     // 11-bit
+#define RES_FAR_LIMIT         200     // 10-bit, beyond: 9-bit
+#define RES_FAST_DELTA        50      // Change per sample forcing 12-bit (one 9-bit LSB)
+#define RES_SLOW_DELTA        12      // Change per sample forcing 11-bit (two 12-bit LSBs)
+
+// Adaptive interval (centi-degC): a sample moving at most ADAPT_FLAT_DELTA
+// doubles the interval, one moving ADAPT_STEP_DELTA or more (or closer than
+// ADAPT_NEAR_LIMIT to a limit) snaps back to the minimum; in between it holds
+#define ADAPT_FLAT_DELTA      3       // Half a 12-bit LSB either side of noise
+#define ADAPT_STEP_DELTA      10
+#define ADAPT_NEAR_LIMIT      50
+#define ADAPT_ETA_FAST_S      3600    // Trend reaches a limit within this: fast
+
+// DS18B20 alarm registers compare the integer part of the temperature:
+// alarm when T <= TL or T >= TH. Fractional limits round outwards, so the
+// alarm may fire up to 1 degC early but never late.
+#define DS_ALARM_TL           ((TEMP_MIN_NORMAL + 99) / 100 - 1)
+#define DS_ALARM_TH           (TEMP_MAX_NORMAL / 100)
+
+// Plausible water temperature (centi-degC); anything else is a bad read
+#define TEMP_SANE_MIN         500
+#define TEMP_SANE_MAX         5000
+
+// Conversion statistics (adaptive resolution)
+static aquarium_conversion_stats_t g_conv_stats;
+
+// Scheduler statistics
+static aquarium_sched_stats_t g_sched_stats;
+
+// What the getters return: the aquarium task bumps the counters above
+// without locking and copies them here once per wake-up, so other tasks
+// never see a set that is half way through an update
+static portMUX_TYPE s_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static aquarium_conversion_stats_t s_conv_stats_pub;
+static aquarium_sched_stats_t s_sched_stats_pub;
+static aquarium_filter_stats_t s_filter_stats_pub[AQUARIUM_MAX_SENSORS];
+
+// Trend of the primary sensor (aquarium task only)
+static aquarium_trend_t s_trend;
+
+// History of the primary sensor, shared by UI, Matter and logging
+static aquarium_history_t s_history;
+static SemaphoreHandle_t s_history_lock = NULL;
+
 // ============================================================================
-// DS18B20 1-Wire Implementation (with critical sections)
+// 1-Wire Bus
 // ============================================================================
 
-static portMUX_TYPE ow_spinlock = portMUX_INITIALIZER_UNLOCKED;
+static onewire_bus_t *s_bus = NULL;
 
-static inline void ow_delay_us(uint32_t us) { 
-    esp_rom_delay_us(us); 
+// ============================================================================
+// Statistics
+// ============================================================================
+
+// Aquarium task only
+static void stats_publish(void) {
+    taskENTER_CRITICAL(&s_stats_lock);
+    s_conv_stats_pub = g_conv_stats;
+    s_sched_stats_pub = g_sched_stats;
+    for (int i = 0; i < g_sensor_count; i++) {
+        s_filter_stats_pub[i] = g_filters[i].stats;
+    }
+    taskEXIT_CRITICAL(&s_stats_lock);
 }
 
-static void ow_drive_low(gpio_num_t pin) {
-    gpio_set_direction(pin, GPIO_MODE_OUTPUT_OD);
-    gpio_set_level(pin, 0);
+// ============================================================================
+// ROM Search
+// ============================================================================
+
+static const aquarium_filter_config_t s_filter_config = {
+    .median_window = FILTER_MEDIAN_WINDOW,
+    .process_noise = FILTER_PROCESS_NOISE,
+    .measurement_noise = FILTER_MEAS_NOISE,
+    .gate_sigma = FILTER_GATE_SIGMA,
+    .max_rejects = FILTER_MAX_REJECTS,
+};
+
+// Enumerate all DS18B20s on the bus into g_sensors. Known ROMs keep their
+// last reading and filter state; an empty search leaves the table untouched.
+static int ds_enumerate_sensors(void) {
+    uint8_t roms[AQUARIUM_MAX_SENSORS][8];
+    aquarium_sample_t found[AQUARIUM_MAX_SENSORS];
+    aquarium_filter_t found_filters[AQUARIUM_MAX_SENSORS];
+    int count = ds18b20_enumerate(s_bus, roms, AQUARIUM_MAX_SENSORS);
+    
+    for (int n = 0; n < count; n++) {
+        aquarium_sample_t *s = &found[n];
+        memset(s, 0, sizeof(*s));
+        memcpy(s->rom, roms[n], sizeof(s->rom));
+        s->eta_s = TREND_NO_ETA;
+        aquarium_filter_init(&found_filters[n], &s_filter_config);
+        for (int i = 0; i < g_sensor_count; i++) {
+            if (memcmp(g_sensors[i].rom, s->rom, sizeof(s->rom)) == 0) {
+                *s = g_sensors[i];
+                found_filters[n] = g_filters[i];
+                break;
+            }
+        }
+    }
+    
+    if (count == 0) {
+        return 0;
+    }
+    
+    memcpy(g_sensors, found, count * sizeof(found[0]));
+    memcpy(g_filters, found_filters, count * sizeof(found_filters[0]));
+    g_sensor_count = count;
+    
+    // Indices may have moved: republish every slot, vacated ones as invalid
+    for (int i = 0; i < AQUARIUM_MAX_SENSORS; i++) {
+        aquarium_sample_t empty = { .eta_s = TREND_NO_ETA, .valid = false };
+        aquarium_sample_publish(&g_samples[i], i < count ? &g_sensors[i] : &empty);
+    }
+    stats_publish();    // Filter counters follow their sensor's new index
+    atomic_store(&g_published_count, count);
+    
+    ESP_LOGI(TAG, "Found %d DS18B20 sensor(s)", count);
+    for (int i = 0; i < count; i++) {
+        const uint8_t *r = g_sensors[i].rom;
+        ESP_LOGI(TAG, "   [%d] %02X%02X%02X%02X%02X%02X%02X%02X", i,
+                 r[0], r[1], r[2], r[3], r[4], r[5], r[6], r[7]);
+    }
+    return count;
 }
 
-static void ow_release(gpio_num_t pin) {
-    gpio_set_direction(pin, GPIO_MODE_INPUT_OUTPUT_OD);
-    gpio_set_level(pin, 1);
+// ============================================================================
+// Conversion Phases (bus work only - no waiting here)
+// ============================================================================
+
+// Skip ROM + Write Scratchpad: every sensor gets the same resolution, so one
+// broadcast conversion window fits all. TH/TL (alarm mode) share the write.
+static bool ds_set_resolution(int bits) {
+    uint8_t config = ds18b20_resolution_to_config(bits);
+    return ds18b20_write_scratchpad(s_bus, NULL, DS_ALARM_TH, DS_ALARM_TL, config) == ESP_OK;
 }
 
-static int ow_read(gpio_num_t pin) { 
-    return gpio_get_level(pin); 
+// Reset + Alarm Search: true if any probe's last conversion was out of range
+static bool ds_any_alarm(void) {
+    uint8_t roms[AQUARIUM_MAX_SENSORS][8];
+    int count = ds18b20_alarm_search(s_bus, roms, AQUARIUM_MAX_SENSORS);
+    for (int i = 0; i < count; i++) {
+        ESP_LOGW(TAG, "🚨 Alarm flag: %02X%02X%02X%02X%02X%02X%02X%02X",
+                 roms[i][0], roms[i][1], roms[i][2], roms[i][3],
+                 roms[i][4], roms[i][5], roms[i][6], roms[i][7]);
+    }
+    return count > 0;
 }
 
-static int ow_reset(gpio_num_t pin) {
-    portENTER_CRITICAL(&ow_spinlock);
-    ow_drive_low(pin);
-    ow_delay_us(480);
-    ow_release(pin);
-    ow_delay_us(70);
-    int presence = (ow_read(pin) == 0);
-    ow_delay_us(410);
-    portEXIT_CRITICAL(&ow_spinlock);
-    return presence ? 0 : -1;
+// Reset + Skip ROM + Convert T: every sensor converts in the same window.
+// Returns false if no device answered.
+static bool ds_start_conversion(void) {
+    return ds18b20_convert_all(s_bus) == ESP_OK;
 }
 
-static void ow_write_bit(gpio_num_t pin, int v) {
-    if (v) {
-        ow_drive_low(pin);
-        ow_delay_us(6);
-        ow_release(pin);
-        ow_delay_us(64);
-    } else {
-        ow_drive_low(pin);
-        ow_delay_us(60);
-        ow_release(pin);
-        ow_delay_us(10);
+// Reset + Match ROM + Read Scratchpad for one sensor. Returns false on any
+// failure (no presence, CRC, stuck bus, power-on value). The resolution the
+// sensor converted at is stored in *bits (0 in alarm mode if its TH/TL are
+// not ours).
+static bool ds_read_result(const uint8_t rom[8], temp_centi_t *centi, int *bits) {
+    uint8_t sp[DS18B20_SCRATCHPAD_LEN];
+    int16_t raw;
+    if (ds18b20_read_scratchpad(s_bus, rom, sp) != ESP_OK ||
+        ds18b20_parse_scratchpad(sp, &raw) != ESP_OK) {
+        return false;
     }
+    *bits = ds18b20_config_to_resolution(sp[DS18B20_SP_CONFIG]);
+#if AQUARIUM_ALARM_MODE
+    // A power cycle brings back TH/TL from EEPROM: report an unknown
+    // resolution so the alarm limits are written again with it
+    if ((int8_t)sp[DS18B20_SP_TH] != DS_ALARM_TH || (int8_t)sp[DS18B20_SP_TL] != DS_ALARM_TL) {
+        *bits = 0;
+    }
+#endif
+    *centi = ds18b20_raw_to_centi(raw);
+    
+    // Sanity check
+    return *centi >= TEMP_SANE_MIN && *centi <= TEMP_SANE_MAX;
 }
 
-static int ow_read_bit(gpio_num_t pin) {
-    ow_drive_low(pin);
-    ow_delay_us(6);
-    ow_release(pin);
-    ow_delay_us(9);
-    int b = ow_read(pin);
-    ow_delay_us(55);
-    return b;
-}
+// ============================================================================
+// Read State Machine
+// ============================================================================
+//
+//   IDLE --(sample slot)--> [set resolution] + broadcast Convert T --> CONVERTING
+//   CONVERTING --(94..750ms)--> Match ROM + read scratchpad per sensor --> IDLE
+//   any failure --> RETRY_WAIT --(100ms)--> reset + Convert T ...
+//
+// A retry only re-reads the sensors that are still pending. The sample is
+// OK if at least one sensor delivered a reading.
+//
+// The conversion wait follows the resolution currently programmed. A sensor
+// reporting another resolution (e.g. reverted after a brown-out) may hold a
+// stale reading: it is rejected and the resolution is written again (with
+// TH/TL, which the brown-out reverted too).
+//
+// The machine never sleeps: every step returns immediately and leaves the
+// next wake-up time in deadline_us. The caller owns the clock (now_us), so
+// the schedule only depends on the timestamps it is fed.
+
+typedef enum {
+    DS_STATE_IDLE,          // Waiting for the next sample slot
+    DS_STATE_CONVERTING,    // Convert T issued, waiting for conversion time
+    DS_STATE_RETRY_WAIT,    // Attempt failed, retry scheduled
+} ds_state_t;
+
+typedef enum {
+    DS_RESULT_NONE,         // Still working on the current sample
+    DS_RESULT_OK,           // Sample finished, at least one sensor read
+    DS_RESULT_FAILED,       // All retries used up, no sensor read
+    DS_RESULT_QUIET,        // Alarm mode: converted, no alarm, nothing read
+} ds_result_t;
+
+typedef struct {
+    ds_state_t state;
+    int attempt;
+    int64_t slot_us;            // Scheduled time of the current sample slot
+    int64_t sample_start_us;    // When the current sample actually started
+    int64_t deadline_us;        // When the machine wants to run next
+    uint32_t pending_mask;      // Sensors not read yet in this sample
+    uint32_t read_mask;         // Sensors with a fresh reading in temps[]
+    bool rescan;                // Search the bus again before the next sample
+    bool full_read;             // Read scratchpads this slot (not just Alarm Search)
+    bool alarm_active;          // Alarm seen: read again next slot to catch the recovery
+    int64_t last_full_us;       // Slot of the last full read (heartbeat)
+    int resolution;             // Bits programmed into the sensors (0 = unknown)
+    int target_resolution;      // Bits wanted for the next sample
+    uint32_t conversion_ms;     // Wait used for the current conversion
+    uint32_t interval_ms;       // Spacing to the next slot
+    temp_centi_t temps[AQUARIUM_MAX_SENSORS];
+    int64_t read_us[AQUARIUM_MAX_SENSORS];  // When each scratchpad was read
+} ds_reader_t;
 
-static void ow_write_byte(gpio_num_t pin, uint8_t v) {
-    portENTER_CRITICAL(&ow_spinlock);
-    for (int i = 0; i < 8; i++) 
-        ow_write_bit(pin, (v >> i) & 1);
-    portEXIT_CRITICAL(&ow_spinlock);
+static void ds_reader_init(ds_reader_t *r, int64_t now_us) {
+    r->state = DS_STATE_IDLE;
+    r->attempt = 0;
+    r->slot_us = now_us;
+    r->sample_start_us = now_us;
+    r->deadline_us = now_us;
+    r->pending_mask = 0;
+    r->read_mask = 0;
+    r->rescan = true;
+    r->full_read = true;
+    r->alarm_active = false;
+    r->last_full_us = now_us;
+    r->resolution = 0;
+    r->target_resolution = DS18B20_RESOLUTION_MAX;
+    r->conversion_ms = 0;
+    r->interval_ms = TEMP_UPDATE_INTERVAL_MS;
 }
 
-static uint8_t ow_read_byte(gpio_num_t pin) {
-    portENTER_CRITICAL(&ow_spinlock);
-    uint8_t r = 0;
-    for (int i = 0; i < 8; i++) 
-        r |= (ow_read_bit(pin) << i);
-    portEXIT_CRITICAL(&ow_spinlock);
-    return r;
+// Next deadline is the next slot on the grid (slot + interval), never the
+// end of this sample: wake latency, conversion time and retries cannot make
+// the period drift. An overrun past that slot skips or catches up.
+static void ds_reader_schedule_next(ds_reader_t *r, int64_t now_us) {
+    const int64_t interval_us = (int64_t)r->interval_ms * 1000;
+    int64_t next = r->slot_us + interval_us;
+    
+    if (next <= now_us) {
+        g_sched_stats.overruns++;
+#if !TEMP_SCHED_CATCH_UP
+        int64_t missed = (now_us - next) / interval_us + 1;
+        g_sched_stats.skipped_slots += (uint32_t)missed;
+        next += missed * interval_us;
+#endif
+    }
+    r->deadline_us = next;
 }
 
-// ============================================================================
-// CRC8 for DS18B20
-// ============================================================================
+static ds_result_t ds_reader_finish(ds_reader_t *r, int64_t now_us, ds_result_t result) {
+    if (result == DS_RESULT_OK || result == DS_RESULT_QUIET) {
+        int bits = r->resolution ? r->resolution : DS18B20_RESOLUTION_MAX;
+        g_conv_stats.samples++;
+        g_conv_stats.samples_at_bits[bits - DS18B20_RESOLUTION_MIN]++;
+        g_conv_stats.conversion_ms_total += r->conversion_ms;
+        g_conv_stats.conversion_ms_saved += ds18b20_conversion_time_ms(DS18B20_RESOLUTION_MAX) - r->conversion_ms;
+    }
+    r->state = DS_STATE_IDLE;
+    ds_reader_schedule_next(r, now_us);
+    return result;
+}
 
-static uint8_t crc8(uint8_t *data, uint8_t len) {
-    uint8_t crc = 0;
-    for (uint8_t i = 0; i < len; i++) {
-        uint8_t byte = data[i];
-        for (uint8_t j = 0; j < 8; j++) {
-            uint8_t mix = (crc ^ byte) & 0x01;
-            crc >>= 1;
-            if (mix) crc ^= 0x8C;
-            byte >>= 1;
+static ds_result_t ds_reader_fail_attempt(ds_reader_t *r, int64_t now_us) {
+    r->attempt++;
+    if (r->attempt >= MAX_READ_RETRIES) {
+        if (r->read_mask == 0) {
+            r->rescan = true;   // Bus went silent: search again next sample
+            return ds_reader_finish(r, now_us, DS_RESULT_FAILED);
         }
+        return ds_reader_finish(r, now_us, DS_RESULT_OK);
     }
-    return crc;
+    r->state = DS_STATE_RETRY_WAIT;
+    r->deadline_us = now_us + (int64_t)DS_RETRY_DELAY_MS * 1000;
+    return DS_RESULT_NONE;
 }
 
-// ============================================================================
-// Single Temperature Read Attempt
-// ============================================================================
+static ds_result_t ds_reader_start_attempt(ds_reader_t *r, int64_t now_us) {
+    if (r->rescan) {
+        if (ds_enumerate_sensors() == 0) {
+            return ds_reader_fail_attempt(r, now_us);
+        }
+        r->rescan = false;
+        r->resolution = 0;      // New sensors start at their EEPROM setting
+        r->pending_mask = (1u << g_sensor_count) - 1;
+    }
+    if (r->resolution != r->target_resolution) {
+        r->resolution = ds_set_resolution(r->target_resolution) ? r->target_resolution : 0;
+    }
+    if (!ds_start_conversion()) {
+        return ds_reader_fail_attempt(r, now_us);
+    }
+    // Unknown resolution: wait for the worst case
+    int bits = r->resolution ? r->resolution : DS18B20_RESOLUTION_MAX;
+    r->conversion_ms = ds18b20_conversion_time_ms(bits);
+    r->state = DS_STATE_CONVERTING;
+    r->deadline_us = now_us + (int64_t)r->conversion_ms * 1000;
+    return DS_RESULT_NONE;
+}
 
-static float try_read_temperature(void) {
-    gpio_num_t pin = DS18B20_GPIO;
-    
-    // Configure GPIO each time (needed for reliable readings)
-    gpio_config_t io = {
-        .pin_bit_mask = 1ULL << pin,
-        .mode = GPIO_MODE_INPUT_OUTPUT_OD,
-        .pull_up_en = GPIO_PULLUP_ENABLE,
-        .pull_down_en = GPIO_PULLDOWN_DISABLE,
-        .intr_type = GPIO_INTR_DISABLE,
-    };
-    gpio_config(&io);
-    ow_release(pin);
-    
-    // Reset and check presence
-    if (ow_reset(pin) != 0) {
-        return NAN;
+/**
+ * Advance the read state machine. Does nothing before deadline_us.
+ * On DS_RESULT_OK, sensors whose bit is set in read_mask have a fresh
+ * reading in temps[].
+ */
+static ds_result_t ds_reader_step(ds_reader_t *r, int64_t now_us) {
+    if (now_us < r->deadline_us) {
+        return DS_RESULT_NONE;
     }
     
-    // Skip ROM + Convert Temperature
-    ow_write_byte(pin, 0xCC);
-    ow_write_byte(pin, 0x44);
-    
-    // Wait for conversion (750ms is enough for 12-bit)
-    vTaskDelay(pdMS_TO_TICKS(750));
-    
-    // Reset again
-    if (ow_reset(pin) != 0) {
-        return NAN;
+    switch (r->state) {
+        case DS_STATE_IDLE: {
+            // deadline_us is the slot this sample belongs to
+            uint32_t jitter = (uint32_t)(now_us - r->deadline_us);
+            g_sched_stats.slots++;
+            g_sched_stats.jitter_last_us = jitter;
+            g_sched_stats.jitter_total_us += jitter;
+            if (jitter > g_sched_stats.jitter_max_us) {
+                g_sched_stats.jitter_max_us = jitter;
+            }
+            r->slot_us = r->deadline_us;
+            r->sample_start_us = now_us;
+            r->attempt = 0;
+#if AQUARIUM_ALARM_MODE
+            // Heartbeat, unknown bus, or an alarm that may just have cleared
+            r->full_read = r->rescan || r->alarm_active ||
+                           r->slot_us - r->last_full_us >= (int64_t)ALARM_HEARTBEAT_MS * 1000;
+            r->alarm_active = false;
+#else
+            r->full_read = true;
+#endif
+            r->pending_mask = (1u << g_sensor_count) - 1;
+            r->read_mask = 0;
+            return ds_reader_start_attempt(r, now_us);
+        }
+            
+        case DS_STATE_RETRY_WAIT:
+            return ds_reader_start_attempt(r, now_us);
+            
+        case DS_STATE_CONVERTING:
+            if (!r->full_read) {
+                r->alarm_active = ds_any_alarm();
+                if (!r->alarm_active) {
+                    g_sched_stats.quiet_slots++;
+                    return ds_reader_finish(r, now_us, DS_RESULT_QUIET);
+                }
+                g_sched_stats.alarm_slots++;
+                r->full_read = true;
+            }
+            if (r->attempt == 0) {
+                g_sched_stats.full_reads++;
+                r->last_full_us = r->slot_us;
+            }
+            for (int i = 0; i < g_sensor_count; i++) {
+                if (!(r->pending_mask & (1u << i))) {
+                    continue;
+                }
+                int bits = 0;
+                temp_centi_t temp;
+                bool ok = ds_read_result(g_sensors[i].rom, &temp, &bits);
+                if (ok && r->resolution && bits != r->resolution) {
+                    r->resolution = 0;  // Rewrite on the retry
+                    ok = false;
+                }
+                if (ok) {
+                    r->temps[i] = temp;
+                    r->read_us[i] = now_us;
+                    r->pending_mask &= ~(1u << i);
+                    r->read_mask |= 1u << i;
+                }
+            }
+            if (r->pending_mask != 0) {
+                return ds_reader_fail_attempt(r, now_us);
+            }
+            return ds_reader_finish(r, now_us, DS_RESULT_OK);
     }
-    
-    // Read scratchpad
-    ow_write_byte(pin, 0xCC);
-    ow_write_byte(pin, 0xBE);
-    
-    uint8_t scratchpad[9];
-    for (int i = 0; i < 9; i++) {
-        scratchpad[i] = ow_read_byte(pin);
+    return DS_RESULT_NONE;
+}
+
+/**
+ * Resolution policy for one sensor: `temp` is the new reading, `delta` the
+ * change since the previous one (ignored without a previous reading).
+ */
+static int ds_pick_resolution(temp_centi_t temp, int delta, bool has_prev) {
+    if (!has_prev) {
+        return DS18B20_RESOLUTION_MAX;
     }
+    // Distance to the nearest limit (negative outside the normal range)
+    int below = temp - TEMP_MIN_NORMAL;
+    int above = TEMP_MAX_NORMAL - temp;
+    int margin = below < above ? below : above;
+    int rate = abs(delta);
     
-    // CRC check
-    if (crc8(scratchpad, 8) != scratchpad[8]) {
-        return NAN;
+    if (margin < RES_NEAR_LIMIT || rate >= RES_FAST_DELTA) return 12;
+    if (margin < RES_MID_LIMIT || rate >= RES_SLOW_DELTA) return 11;
+    if (margin < RES_FAR_LIMIT) return 10;
+    return 9;
+}
+
+// Measurement noise for the filter: sensor noise plus quantization
+// (LSB^2 / 12, LSB = 6.25 centi-degC at 12-bit, doubling per bit dropped)
+static uint16_t ds_filter_noise(int bits) {
+    uint32_t lsb_x100 = 625u << (DS18B20_RESOLUTION_MAX - bits);
+    return (uint16_t)(FILTER_MEAS_NOISE + lsb_x100 * lsb_x100 / 120000);
+}
+
+/**
+ * Interval policy for one sensor, same inputs as ds_pick_resolution plus the
+ * current interval. The grid stays anchored at the last slot, so a change
+ * only moves the slots after it.
+ */
+static uint32_t ds_pick_interval(temp_centi_t temp, int delta, bool has_prev, uint32_t current_ms) {
+#if TEMP_ADAPTIVE_INTERVAL
+    if (!has_prev) {
+        return TEMP_UPDATE_INTERVAL_MS;
     }
+    int below = temp - TEMP_MIN_NORMAL;
+    int above = TEMP_MAX_NORMAL - temp;
+    int margin = below < above ? below : above;
+    int rate = abs(delta);
     
-    int16_t raw = (int16_t)((scratchpad[1] << 8) | scratchpad[0]);
-    
-    // Invalid readings
-    if (raw == 0 || raw == 0x0550 || raw == 0xFFFF) {
-        return NAN;
+    if (margin < ADAPT_NEAR_LIMIT || rate >= ADAPT_STEP_DELTA) {
+        return TEMP_UPDATE_INTERVAL_MS;
     }
-    
-    float celsius = (float)raw / 16.0f;
-    
-    // Sanity check
-    if (celsius < 5.0f || celsius > 50.0f) {
-        return NAN;
+    if (rate > ADAPT_FLAT_DELTA) {
+        return current_ms;
     }
-    
-    return celsius;
+    uint32_t next = current_ms * 2;
+    return next > TEMP_UPDATE_INTERVAL_MAX_MS ? TEMP_UPDATE_INTERVAL_MAX_MS : next;
+#else
+    return TEMP_UPDATE_INTERVAL_MS;
+#endif
 }
 
-// ============================================================================
-// Read with Retry
-// ============================================================================
+// Applies to the slot after the one just scheduled: the deadline already set
+// by ds_reader_finish is moved to the new spacing
+static void ds_reader_plan_interval(ds_reader_t *r, uint32_t interval_ms, int64_t now_us) {
+    if (interval_ms == r->interval_ms) {
+        return;
+    }
+    if (interval_ms < r->interval_ms) {
+        g_sched_stats.fast_snaps++;
+    }
+    r->interval_ms = interval_ms;
+    g_sched_stats.interval_ms = interval_ms;
+    if (r->state == DS_STATE_IDLE) {
+        ds_reader_schedule_next(r, now_us);
+    }
+}
 
-static float read_ds18b20_temperature(void) {
-    for (int retry = 0; retry < MAX_READ_RETRIES; retry++) {
-        float temp = try_read_temperature();
-        if (!isnan(temp)) {
-            return temp;
-        }
-        if (retry < MAX_READ_RETRIES - 1) {
-            vTaskDelay(pdMS_TO_TICKS(100));  // Small delay before retry
-        }
+// Go up at once, come down one step per sample
+static void ds_reader_plan_resolution(ds_reader_t *r, int wanted) {
+    int current = r->resolution ? r->resolution : DS18B20_RESOLUTION_MAX;
+    if (wanted < current - 1) {
+        wanted = current - 1;
     }
-    return NAN;
+    r->target_resolution = wanted;
 }
 
 // ============================================================================
 // Public API
 // ============================================================================
 
-float aquarium_get_last_temperature(void) {
-    return g_last_temperature;
+int aquarium_history_get_last(int n, aquarium_history_point_t *out) {
+    xSemaphoreTake(s_history_lock, portMAX_DELAY);
+    int count = aquarium_history_last(&s_history, n, out);
+    xSemaphoreGive(s_history_lock);
+    return count;
+}
+
+int aquarium_history_get_range(int64_t from_us, int64_t to_us, aquarium_history_point_t *out, int max) {
+    xSemaphoreTake(s_history_lock, portMAX_DELAY);
+    int count = aquarium_history_range(&s_history, from_us, to_us, out, max);
+    xSemaphoreGive(s_history_lock);
+    return count;
+}
+
+bool aquarium_history_get_window(int64_t from_us, int64_t to_us, aquarium_history_window_t *out) {
+    xSemaphoreTake(s_history_lock, portMAX_DELAY);
+    bool found = aquarium_history_window(&s_history, from_us, to_us, out);
+    xSemaphoreGive(s_history_lock);
+    return found;
+}
+
+bool aquarium_get_filter_stats(int index, aquarium_filter_stats_t *out) {
+    if (index < 0 || index >= atomic_load(&g_published_count) || out == NULL) {
+        return false;
+    }
+    taskENTER_CRITICAL(&s_stats_lock);
+    *out = s_filter_stats_pub[index];
+    taskEXIT_CRITICAL(&s_stats_lock);
+    return true;
+}
+
+void aquarium_get_sched_stats(aquarium_sched_stats_t *out) {
+    taskENTER_CRITICAL(&s_stats_lock);
+    *out = s_sched_stats_pub;
+    taskEXIT_CRITICAL(&s_stats_lock);
+}
+
+void aquarium_get_conversion_stats(aquarium_conversion_stats_t *out) {
+    taskENTER_CRITICAL(&s_stats_lock);
+    *out = s_conv_stats_pub;
+    taskEXIT_CRITICAL(&s_stats_lock);
 }
 
-bool aquarium_is_temperature_valid(void) {
-    return g_temperature_valid;
+int aquarium_get_sensor_count(void) {
+    return atomic_load(&g_published_count);
+}
+
+bool aquarium_get_sample(int index, aquarium_sample_t *out) {
+    if (index < 0 || index >= AQUARIUM_MAX_SENSORS || out == NULL) {
+        return false;
+    }
+    if (aquarium_sample_read(&g_samples[index], out) == 0) {
+        return false;
+    }
+    return index < atomic_load(&g_published_count);
+}
+
+uint32_t aquarium_get_sample_seq(int index) {
+    if (index < 0 || index >= AQUARIUM_MAX_SENSORS) {
+        return 0;
+    }
+    return aquarium_sample_seq(&g_samples[index]);
 }
 
 // ============================================================================
 // RGB LED Control (18%)
 // ============================================================================
 
-static void update_led(float temp) {
-    if (isnan(temp) || !g_temperature_valid) {
-        Set_RGB((uint8_t)(80 * LED_BRIGHTNESS), 0, (uint8_t)(80 * LED_BRIGHTNESS));
+#define LED_SCALE(v)        ((uint8_t)((v) * LED_BRIGHTNESS_PCT / 100))
+
+// Green/blue across the normal range: 80/180 -> 180/150 -> 220/80, already
+// scaled to LED_BRIGHTNESS_PCT. Filled once by led_gradient_init().
+#define LED_GRADIENT_STEPS  65
+static uint8_t s_led_gradient[LED_GRADIENT_STEPS][2];
+
+static void led_gradient_init(void) {
+    const int half = (LED_GRADIENT_STEPS - 1) / 2;
+    for (int i = 0; i < LED_GRADIENT_STEPS; i++) {
+        int g, b;
+        if (i < half) {
+            g = 80 + (180 - 80) * i / half;
+            b = 180 + (150 - 180) * i / half;
+        } else {
+            g = 180 + (220 - 180) * (i - half) / half;
+            b = 150 + (80 - 150) * (i - half) / half;
+        }
+        s_led_gradient[i][0] = LED_SCALE(g);
+        s_led_gradient[i][1] = LED_SCALE(b);
+    }
+}
+
+static void update_led(const aquarium_sample_t *sensor) {
+    if (!sensor->valid) {
+        Set_RGB(LED_SCALE(80), 0, LED_SCALE(80));
         return;
     }
     
+    int temp = sensor->temp_centi;
     if (temp < TEMP_MIN_NORMAL || temp > TEMP_MAX_NORMAL) {
-        Set_RGB((uint8_t)(255 * LED_BRIGHTNESS), 0, 0);
+        Set_RGB(LED_SCALE(255), 0, 0);
     } else {
-        float progress = (temp - TEMP_MIN_NORMAL) / (TEMP_MAX_NORMAL - TEMP_MIN_NORMAL);
-        if (progress < 0.0f) progress = 0.0f;
-        if (progress > 1.0f) progress = 1.0f;
-        
-        uint8_t g, b;
-        if (progress < 0.5f) {
-            float t = progress * 2.0f;
-            g = (uint8_t)(80 + (180 - 80) * t);
-            b = (uint8_t)(180 + (150 - 180) * t);
-        } else {
-            float t = (progress - 0.5f) * 2.0f;
-            g = (uint8_t)(180 + (220 - 180) * t);
-            b = (uint8_t)(150 + (80 - 150) * t);
-        }
-        Set_RGB(0, (uint8_t)(g * LED_BRIGHTNESS), (uint8_t)(b * LED_BRIGHTNESS));
+        const int span = TEMP_MAX_NORMAL - TEMP_MIN_NORMAL;
+        int i = ((temp - TEMP_MIN_NORMAL) * (LED_GRADIENT_STEPS - 1) + span / 2) / span;
+        Set_RGB(0, s_led_gradient[i][0], s_led_gradient[i][1]);
     }
 }
 
@@ -252,29 +649,155 @@ static void update_led(float temp) {
 // Main Task
 // ============================================================================
 
-static void aquarium_task(void *arg) {
-    ESP_LOGI(TAG, "Temperature monitoring started");
-    ESP_LOGI(TAG, "   Interval: %d sec", TEMP_UPDATE_INTERVAL_MS / 1000);
+static TaskHandle_t s_aquarium_task = NULL;
+static esp_timer_handle_t s_wake_timer = NULL;
+
+// esp_timer callback: only wakes the task, all bus work happens there
+static void wake_timer_cb(void *arg) {
+    (void)arg;
+    xTaskNotifyGive(s_aquarium_task);
+}
+
+// One wake-up of the aquarium task: advance the reader, hand a finished
+// sample to the filter, history, Matter, UI and LED, and arm the wake
+// timer for the reader's next deadline. Time only comes from esp_timer.
+static ds_result_t aquarium_task_wake(ds_reader_t *reader) {
+    int64_t now = esp_timer_get_time();
+    aquarium_power_begin(POWER_ACT_SENSOR, now);
+    onewire_set_active(s_bus, true);
+    ds_result_t result = ds_reader_step(reader, now);
+    int64_t read_time = (now - reader->sample_start_us) / 1000;
     
-    while (1) {
-        int64_t start = esp_timer_get_time();
-        float temp = read_ds18b20_temperature();
-        int64_t read_time = (esp_timer_get_time() - start) / 1000;
-        
-        if (!isnan(temp)) {
-            g_last_temperature = temp;
-            g_temperature_valid = true;
+    if (result == DS_RESULT_OK) {
+        int wanted = DS18B20_RESOLUTION_MIN;
+        uint32_t interval = TEMP_UPDATE_INTERVAL_MAX_MS;
+        for (int i = 0; i < g_sensor_count; i++) {
+            aquarium_sample_t *s = &g_sensors[i];
+            if (!(reader->read_mask & (1u << i))) {
+                ESP_LOGW(TAG, "⚠️ Sensor %d read failed", i);
+                continue;
+            }
+            temp_centi_t temp = reader->temps[i];
+#if FILTER_ENABLE
+            int cur_bits = reader->resolution ? reader->resolution : DS18B20_RESOLUTION_MAX;
+            aquarium_filter_set_measurement_noise(&g_filters[i], ds_filter_noise(cur_bits));
+            aquarium_filter_set_process_noise(&g_filters[i], (uint16_t)(FILTER_PROCESS_NOISE *
+                                              reader->interval_ms / TEMP_UPDATE_INTERVAL_MS));
+            if (!aquarium_filter_update(&g_filters[i], reader->temps[i], &temp)) {
+                ESP_LOGW(TAG, "⚠️ [%d] Spike rejected (%d centi-°C, keeping %d)",
+                         i, reader->temps[i], temp);
+            }
+#endif
+            int delta = temp - s->temp_centi;
+            int bits = ds_pick_resolution(temp, delta, s->valid);
+            if (bits > wanted) wanted = bits;
+            uint32_t sensor_interval = ds_pick_interval(temp, delta, s->valid, reader->interval_ms);
+            if (sensor_interval < interval) interval = sensor_interval;
             
-            ESP_LOGI(TAG, "🌡️ %.1f°C (read: %lldms)", temp, read_time);
-            aquarium_matter_update_temperature(temp);
-        } else {
-            ESP_LOGW(TAG, "⚠️ Read failed (took %lldms)", read_time);
+            s->temp_centi = temp;
+            s->valid = true;
+            if (i == AQUARIUM_PRIMARY_SENSOR) {
+                aquarium_trend_result_t trend;
+                aquarium_trend_push(&s_trend, (int32_t)(reader->slot_us / 1000000), temp, &trend);
+                int32_t slope = trend.valid ? trend.slope_centi_h : 0;
+                s->trend_centi_h = (int16_t)(slope > INT16_MAX ? INT16_MAX : slope < -INT16_MAX ? -INT16_MAX : slope);
+                s->eta_s = aquarium_trend_eta_s(&trend, TEMP_MIN_NORMAL, TEMP_MAX_NORMAL, TREND_MIN_SLOPE);
+                if (s->eta_s >= 0 && s->eta_s < ADAPT_ETA_FAST_S) {
+                    interval = TEMP_UPDATE_INTERVAL_MS;
+                }
+            }
+            s->timestamp_us = reader->read_us[i];
+            s->read_latency_us = (uint32_t)(reader->read_us[i] - reader->sample_start_us);
+            aquarium_sample_publish(&g_samples[i], s);
+            int tenths = temp_centi_to_tenths(s->temp_centi);
+            ESP_LOGI(TAG, "🌡️ [%d] %d.%d°C (read: %lldms, %d-bit)", i, tenths / 10, tenths % 10,
+                     read_time, reader->resolution ? reader->resolution : DS18B20_RESOLUTION_MAX);
         }
+        ds_reader_plan_resolution(reader, wanted);
+        // A sensor that missed this sample does not vote: keep the interval
+        if (reader->read_mask != (1u << g_sensor_count) - 1 && interval > reader->interval_ms) {
+            interval = reader->interval_ms;
+        }
+        ds_reader_plan_interval(reader, interval, now);
         
-        update_led(g_last_temperature);
+        const aquarium_sample_t *primary = &g_sensors[AQUARIUM_PRIMARY_SENSOR];
+        if (reader->read_mask & (1u << AQUARIUM_PRIMARY_SENSOR)) {
+            xSemaphoreTake(s_history_lock, portMAX_DELAY);
+            aquarium_history_append(&s_history, reader->slot_us, primary->temp_centi);
+            xSemaphoreGive(s_history_lock);
+            aquarium_matter_update_temperature(primary->temp_centi);
+            aquarium_matter_update_trend(primary->trend_centi_h, primary->eta_s);
+            aquarium_ui_notify_sample();
+        }
         
-        // Wait for next interval
-        vTaskDelay(pdMS_TO_TICKS(TEMP_UPDATE_INTERVAL_MS));
+        if (g_conv_stats.samples % 100 == 0) {
+            ESP_LOGI(TAG, "Conversions: %lu, avg %llums, saved %llums vs 12-bit",
+                     (unsigned long)g_conv_stats.samples,
+                     g_conv_stats.conversion_ms_total / g_conv_stats.samples,
+                     g_conv_stats.conversion_ms_saved);
+            ESP_LOGI(TAG, "Schedule: jitter avg %lluus, max %luus, %lu overruns, %lu skipped, interval %lums",
+                     g_sched_stats.jitter_total_us / g_sched_stats.slots,
+                     (unsigned long)g_sched_stats.jitter_max_us,
+                     (unsigned long)g_sched_stats.overruns,
+                     (unsigned long)g_sched_stats.skipped_slots,
+                     (unsigned long)g_sched_stats.interval_ms);
+            aquarium_power_stats_t power;
+            aquarium_power_get_stats(now, &power);
+            ESP_LOGI(TAG, "Power: %lu wakes, idle %llu%% (sensor %lu, ui %lu wakes)",
+                     (unsigned long)power.wakes,
+                     power.idle_us * 100 / (power.idle_us + power.active_us + 1),
+                     (unsigned long)power.act_wakes[POWER_ACT_SENSOR],
+                     (unsigned long)power.act_wakes[POWER_ACT_UI]);
+#if AQUARIUM_ALARM_MODE
+            ESP_LOGI(TAG, "Alarm mode: %lu full reads, %lu quiet, %lu alarm slots",
+                     (unsigned long)g_sched_stats.full_reads,
+                     (unsigned long)g_sched_stats.quiet_slots,
+                     (unsigned long)g_sched_stats.alarm_slots);
+#endif
+            
+            aquarium_history_window_t hour;
+            if (aquarium_history_get_window(now - 3600LL * 1000000, now, &hour)) {
+                ESP_LOGI(TAG, "Last hour: min %d.%02d, avg %d.%02d, max %d.%02d (%lu samples)",
+                         hour.min / 100, hour.min % 100, hour.avg / 100, hour.avg % 100,
+                         hour.max / 100, hour.max % 100, (unsigned long)hour.count);
+            }
+        }
+        update_led(primary);
+    } else if (result == DS_RESULT_FAILED) {
+        ESP_LOGW(TAG, "⚠️ Read failed (took %lldms)", read_time);
+        ds_reader_plan_interval(reader, TEMP_UPDATE_INTERVAL_MS, now);
+        update_led(&g_sensors[AQUARIUM_PRIMARY_SENSOR]);
+    }
+    
+    // Sleep until the machine's next deadline (conversion done, retry, next
+    // sample). The conversion runs in the probes, so the SoC may sleep too.
+    onewire_set_active(s_bus, false);
+    int64_t idle_from = esp_timer_get_time();
+    int64_t wait_us = reader->deadline_us - idle_from;
+    esp_timer_start_once(s_wake_timer, wait_us > 0 ? (uint64_t)wait_us : 0);
+    stats_publish();
+    aquarium_power_end(POWER_ACT_SENSOR, idle_from);
+    return result;
+}
+
+static void aquarium_task(void *arg) {
+    (void)arg;
+    ESP_LOGI(TAG, "Temperature monitoring started");
+#if TEMP_ADAPTIVE_INTERVAL
+    ESP_LOGI(TAG, "   Interval: %d..%d sec (adaptive)",
+             TEMP_UPDATE_INTERVAL_MS / 1000, TEMP_UPDATE_INTERVAL_MAX_MS / 1000);
+#else
+    ESP_LOGI(TAG, "   Interval: %d sec", TEMP_UPDATE_INTERVAL_MS / 1000);
+#endif
+    
+    ds_reader_t reader;
+    ds_reader_init(&reader, esp_timer_get_time());
+    g_sched_stats.interval_ms = reader.interval_ms;
+    stats_publish();
+    
+    while (1) {
+        aquarium_task_wake(&reader);
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
     }
 }
 
@@ -284,10 +807,45 @@ static void aquarium_task(void *arg) {
 
 void aquarium_controller_init(void) {
     ESP_LOGI(TAG, "Controller init - GPIO%d", DS18B20_GPIO);
+    
+    led_gradient_init();
+    
+    esp_err_t err = ESP_FAIL;
+#if DS18B20_USE_SIM
+    // Bench mode: three simulated probes (water, sump, ambient)
+    ESP_ERROR_CHECK(onewire_new_sim_bus(&s_bus));
+    const int16_t sim_temps[] = { 25 * 16 + 8, 24 * 16 + 12, 22 * 16 };
+    for (int i = 0; i < 3; i++) {
+        int idx = onewire_sim_add_ds18b20(s_bus, 0xA0001 + i);
+        onewire_sim_set_temperature(s_bus, idx, sim_temps[i]);
+    }
+    err = ESP_OK;
+#elif DS18B20_USE_RMT
+    err = onewire_new_rmt_bus(DS18B20_GPIO, &s_bus);
+#endif
+    if (err != ESP_OK) {
+        ESP_ERROR_CHECK(onewire_new_gpio_bus(DS18B20_GPIO, &s_bus));
+    }
+    ESP_LOGI(TAG, "1-Wire transport: %s", s_bus->name);
 }
 
 void aquarium_start(void) {
+    const aquarium_trend_config_t trend_cfg = {
+        .window_s = TREND_WINDOW_S,
+        .min_samples = TREND_MIN_SAMPLES,
+        .ewma_shift = TREND_EWMA_SHIFT,
+    };
+    aquarium_trend_init(&s_trend, &trend_cfg);
+    aquarium_history_init(&s_history);
+    s_history_lock = xSemaphoreCreateMutex();
+    
+    const esp_timer_create_args_t timer_args = {
+        .callback = &wake_timer_cb,
+        .name = "ds18b20_wake",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&timer_args, &s_wake_timer));
+    
     // Higher priority (6) to reduce WiFi/Matter interference
     // ESP32-C6 is single core, so use core 0
-    xTaskCreatePinnedToCore(aquarium_task, "aquarium", 4096, NULL, 6, NULL, 0);
+    xTaskCreatePinnedToCore(aquarium_task, "aquarium", 4096, NULL, 6, &s_aquarium_task, 0);
 }
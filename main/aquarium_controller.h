@@ -3,10 +3,10 @@
  * @brief Aquarium Temperature Controller for ESP32-C6-LCD-1.47
  * 
  * Features:
- * - DS18B20 temperature sensor on GPIO3
+ * - DS18B20 temperature sensors on GPIO3 (several probes per bus)
  * - RGB LED control based on temperature (18% power)
  * - Matter/HomeKit integration
- * - 5 second update interval
+ * - 5-60 s update interval, adaptive (TEMP_UPDATE_INTERVAL_MS..MAX_MS)
  */
 
 #ifndef AQUARIUM_CONTROLLER_H
@@ -14,26 +14,129 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "aquarium_sample.h"
+#include "aquarium_history.h"
+#include "aquarium_filter.h"
+#include "aquarium_trend.h"
 
-// Temperature thresholds
-#define TEMP_MIN_NORMAL 23.0f  // Below this: RED LED
-#define TEMP_MAX_NORMAL 28.0f  // Above this: RED LED
+// Temperature thresholds (centi-degC)
+#define TEMP_MIN_NORMAL 2300  // Below this: RED LED
+#define TEMP_MAX_NORMAL 2800  // Above this: RED LED
 
 // DS18B20 configuration
 #define DS18B20_GPIO GPIO_NUM_3
 
-// Update interval (milliseconds)
+// Alarm mode: TH/TL are programmed from the thresholds and each slot only
+// runs Convert T + Alarm Search; scratchpads are read (and UI/Matter
+// updated) when a probe flags an alarm or the heartbeat expires
+#ifndef AQUARIUM_ALARM_MODE
+#define AQUARIUM_ALARM_MODE     0
+#endif
+#define ALARM_HEARTBEAT_MS      60000
+
+// 1-Wire transport: 1 = RMT (falls back to bit-bang if init fails), 0 = bit-bang
+#define DS18B20_USE_RMT 1
+
+// 1 = simulated probes instead of the real bus (bench testing without hardware)
+#define DS18B20_USE_SIM 0
+
+// Probes per bus (water, sump, ambient, spare). Found by ROM search,
+// ordered by ROM code. The primary sensor drives the LED, UI and Matter.
+#define AQUARIUM_MAX_SENSORS    4
+#define AQUARIUM_PRIMARY_SENSOR 0
+
+// Sample filter between the bus and publication: median of
+// FILTER_MEDIAN_WINDOW, then a Kalman stage rejecting jumps beyond
+// FILTER_GATE_SIGMA (noise figures in centi-degC squared)
+#define FILTER_ENABLE           1
+#define FILTER_MEDIAN_WINDOW    3
+#define FILTER_PROCESS_NOISE    2       // Q: real drift per TEMP_UPDATE_INTERVAL_MS
+#define FILTER_MEAS_NOISE       36      // R at 12-bit, about 1 LSB (6 centi) squared
+#define FILTER_GATE_SIGMA       4
+#define FILTER_MAX_REJECTS      3       // Then the jump is real: follow it
+
+// Trend of the primary sensor: least-squares slope over TREND_WINDOW_S.
+// A slope of at least TREND_MIN_SLOPE gives a time-to-threshold; the UI
+// warns once that is below TREND_WARN_S (e.g. heater died, water cooling).
+#define TREND_WINDOW_S          1200
+#define TREND_MIN_SAMPLES       12
+#define TREND_EWMA_SHIFT        3
+#define TREND_MIN_SLOPE         10      // centi-degC per hour
+#define TREND_WARN_S            (6 * 3600)
+
+// Update interval (milliseconds). Samples sit on a grid of slots.
 #define TEMP_UPDATE_INTERVAL_MS 5000
 
-// LED brightness (0.0 - 1.0)
-#define LED_BRIGHTNESS 0.18f  // 18% power
+// Adaptive interval: doubles per flat sample up to TEMP_UPDATE_INTERVAL_MAX_MS,
+// back to TEMP_UPDATE_INTERVAL_MS at once on a change, near a limit, on a
+// trend warning or a failed read. 0 = always TEMP_UPDATE_INTERVAL_MS.
+#define TEMP_ADAPTIVE_INTERVAL  1
+#define TEMP_UPDATE_INTERVAL_MAX_MS 60000
+
+// Slots missed by an overrun: 0 = skip to the next slot on the grid,
+// 1 = run the missed slot at once (the grid is kept either way)
+#define TEMP_SCHED_CATCH_UP 0
+
+// Pulsing status dot. Every pulse frame is a POWER_ACT_UI wake, UI_PULSE_FPS
+// times a second, so the light sleep between samples (CONFIG_PM_ENABLE)
+// depends on the display state machine (aquarium_display.c) dimming the
+// screen after DISPLAY_DIM_AFTER_MS, which stops the pulse. 0 = static dot.
+#define AQUARIUM_STATUS_PULSE   1
+
+// LED brightness (percent)
+#define LED_BRIGHTNESS_PCT 18  // 18% power
+
+typedef struct {
+    uint32_t samples;               // Completed samples
+    uint32_t samples_at_bits[4];    // Per resolution: 9, 10, 11, 12 bits
+    uint64_t conversion_ms_total;   // Sum of conversion waits
+    uint64_t conversion_ms_saved;   // Bus/wait time saved vs always 12-bit
+} aquarium_conversion_stats_t;
+
+typedef struct {
+    uint32_t slots;                 // Sample slots started
+    uint32_t overruns;              // Samples that ran past the next slot
+    uint32_t skipped_slots;         // Slots dropped by the skip policy
+    uint32_t jitter_last_us;        // Slot start - scheduled time
+    uint32_t jitter_max_us;
+    uint64_t jitter_total_us;       // Average = total / slots
+    uint32_t full_reads;            // Slots that read every scratchpad
+    uint32_t quiet_slots;           // Alarm mode: no alarm, nothing read
+    uint32_t alarm_slots;           // Alarm mode: a probe flagged an alarm
+    uint32_t interval_ms;           // Current slot spacing (adaptive)
+    uint32_t fast_snaps;            // Stretched interval cut back to the minimum
+} aquarium_sched_stats_t;
 
 // Function prototypes
 void aquarium_controller_init(void);
 void aquarium_start(void);
 
-// Get last valid temperature (for UI)
-float aquarium_get_last_temperature(void);
-bool aquarium_is_temperature_valid(void);
+// Number of sensors found on the bus
+int aquarium_get_sensor_count(void);
+
+// Copy the latest sample of a sensor (lock-free, any task). Returns false if
+// the index is not present.
+bool aquarium_get_sample(int index, aquarium_sample_t *out);
+
+// Publication number of a sensor's sample: unchanged = nothing new to show
+uint32_t aquarium_get_sample_seq(int index);
+
+// History of the primary sensor (centi-degC). Safe from any task; the
+// lock is held while blocks are decoded, so keep ranges short on the UI.
+int aquarium_history_get_last(int n, aquarium_history_point_t *out);
+int aquarium_history_get_range(int64_t from_us, int64_t to_us, aquarium_history_point_t *out, int max);
+bool aquarium_history_get_window(int64_t from_us, int64_t to_us, aquarium_history_window_t *out);
+
+// Statistics below are safe from any task: a consistent copy as of the
+// aquarium task's last wake-up, taken under a short critical section
+
+// Filter counters of a sensor (rejected spikes, restarts)
+bool aquarium_get_filter_stats(int index, aquarium_filter_stats_t *out);
+
+// Sampling schedule counters (jitter, overruns)
+void aquarium_get_sched_stats(aquarium_sched_stats_t *out);
+
+// Adaptive-resolution counters (average conversion time = total / samples)
+void aquarium_get_conversion_stats(aquarium_conversion_stats_t *out);
 
 #endif // AQUARIUM_CONTROLLER_H
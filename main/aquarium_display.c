@@ -0,0 +1,196 @@
+/**
+ * @file aquarium_display.c
+ * @brief Display power states: active -> dimmed -> off (backlight 0 + SLPIN)
+ */
+
+#include "aquarium_display.h"
+#include "aquarium_controller.h"
+#include "aquarium_ui.h"
+#include "ST7789.h"
+#include "LVGL_Driver.h"
+#include "driver/gpio.h"
+#include "esp_sleep.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include <stdatomic.h>
+
+static const char *TAG = "DISPLAY";
+
+// Button re-armed once released, checked at this pace while pressed
+#define DISPLAY_BUTTON_POLL_MS  50
+
+static aquarium_display_state_t s_state = DISPLAY_ACTIVE;
+static int64_t s_last_activity_us;
+static int64_t s_deadline_us;               // FADING_OFF / WAKING: next step
+static atomic_bool s_wake_request;
+static atomic_bool s_button_armed;
+static uint32_t s_seen_seq;
+static bool s_alarm;
+
+static void button_isr(void *arg) {
+    (void)arg;
+    // Level interrupt (it also wakes from light sleep): off until released
+    gpio_intr_disable(DISPLAY_WAKE_GPIO);
+    atomic_store(&s_button_armed, false);
+    atomic_store(&s_wake_request, true);
+    BaseType_t woken = pdFALSE;
+    LVGL_Wake_FromISR(&woken);
+    if (woken) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+// Anything the keeper should see keeps the display on
+static bool display_alarm(const aquarium_sample_t *s) {
+    if (!s->valid) {
+        return true;
+    }
+    if (s->temp_centi < TEMP_MIN_NORMAL || s->temp_centi > TEMP_MAX_NORMAL) {
+        return true;
+    }
+    return s->eta_s >= 0 && s->eta_s < TREND_WARN_S;
+}
+
+static uint32_t ms_until(int64_t deadline_us, int64_t now_us) {
+    if (deadline_us <= now_us) {
+        return 0;
+    }
+    return (uint32_t)((deadline_us - now_us + 999) / 1000);
+}
+
+static void display_set_state(aquarium_display_state_t state) {
+    static const char *const names[] = { "active", "dimmed", "fading off", "off", "waking" };
+    ESP_LOGI(TAG, "Display %s", names[state]);
+    s_state = state;
+}
+
+// LVGL task, lock held: advance the state machine, return ms until the next step
+static uint32_t display_service(void) {
+    int64_t now = esp_timer_get_time();
+    uint32_t poll_ms = LV_NO_TIMER_READY;
+
+    if (!atomic_load(&s_button_armed)) {
+        if (gpio_get_level(DISPLAY_WAKE_GPIO)) {
+            atomic_store(&s_button_armed, true);
+            gpio_intr_enable(DISPLAY_WAKE_GPIO);
+        } else {
+            poll_ms = DISPLAY_BUTTON_POLL_MS;
+        }
+    }
+
+    uint32_t seq = aquarium_get_sample_seq(AQUARIUM_PRIMARY_SENSOR);
+    if (seq != s_seen_seq) {
+        aquarium_sample_t sample;
+        s_seen_seq = seq;
+        if (aquarium_get_sample(AQUARIUM_PRIMARY_SENSOR, &sample)) {
+            s_alarm = display_alarm(&sample);
+        }
+    }
+
+    bool wake = atomic_exchange(&s_wake_request, false) || s_alarm;
+    if (wake) {
+        s_last_activity_us = now;
+    }
+    int64_t idle_us = now - s_last_activity_us;
+    uint32_t next_ms = LV_NO_TIMER_READY;
+
+    switch (s_state) {
+        case DISPLAY_ACTIVE:
+            if (idle_us >= (int64_t)DISPLAY_DIM_AFTER_MS * 1000) {
+                BK_Fade(DISPLAY_DIM_PCT, DISPLAY_FADE_MS);
+                aquarium_ui_set_dimmed(true);
+                display_set_state(DISPLAY_DIMMED);
+                next_ms = ms_until(s_last_activity_us + (int64_t)DISPLAY_OFF_AFTER_MS * 1000, now);
+            } else {
+                next_ms = ms_until(s_last_activity_us + (int64_t)DISPLAY_DIM_AFTER_MS * 1000, now);
+            }
+            break;
+
+        case DISPLAY_DIMMED:
+        case DISPLAY_FADING_OFF:
+            if (wake) {
+                // The fade in progress (if any) is simply retargeted
+                BK_Fade(DISPLAY_BRIGHTNESS_PCT, DISPLAY_WAKE_FADE_MS);
+                aquarium_ui_set_dimmed(false);
+                display_set_state(DISPLAY_ACTIVE);
+                next_ms = DISPLAY_DIM_AFTER_MS;
+            } else if (s_state == DISPLAY_DIMMED) {
+                if (idle_us >= (int64_t)DISPLAY_OFF_AFTER_MS * 1000) {
+                    BK_Fade(0, DISPLAY_FADE_MS);
+                    s_deadline_us = now + (int64_t)DISPLAY_FADE_MS * 1000;
+                    display_set_state(DISPLAY_FADING_OFF);
+                    next_ms = DISPLAY_FADE_MS;
+                } else {
+                    next_ms = ms_until(s_last_activity_us + (int64_t)DISPLAY_OFF_AFTER_MS * 1000, now);
+                }
+            } else if (now >= s_deadline_us) {
+                // Dark now: stop drawing, then the panel
+                aquarium_ui_set_active(false);
+                LCD_Sleep(true);
+                display_set_state(DISPLAY_OFF);
+            } else {
+                next_ms = ms_until(s_deadline_us, now);
+            }
+            break;
+
+        case DISPLAY_OFF:
+            if (wake) {
+                LCD_Sleep(false);
+                aquarium_ui_set_active(true);
+                s_deadline_us = now + (int64_t)DISPLAY_SLPOUT_MS * 1000;
+                display_set_state(DISPLAY_WAKING);
+                next_ms = DISPLAY_SLPOUT_MS;
+            }
+            break;
+
+        case DISPLAY_WAKING:
+            if (now >= s_deadline_us) {
+                BK_Fade(DISPLAY_BRIGHTNESS_PCT, DISPLAY_WAKE_FADE_MS);
+                aquarium_ui_set_dimmed(false);
+                display_set_state(DISPLAY_ACTIVE);
+                next_ms = DISPLAY_DIM_AFTER_MS;
+            } else {
+                next_ms = ms_until(s_deadline_us, now);
+            }
+            break;
+    }
+    return next_ms < poll_ms ? next_ms : poll_ms;
+}
+
+void aquarium_display_init(void) {
+    BK_Light(DISPLAY_BRIGHTNESS_PCT);
+    s_last_activity_us = esp_timer_get_time();
+    s_state = DISPLAY_ACTIVE;
+
+    const gpio_config_t button = {
+        .pin_bit_mask = 1ULL << DISPLAY_WAKE_GPIO,
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = GPIO_PULLUP_ENABLE,
+        .intr_type = GPIO_INTR_LOW_LEVEL,
+    };
+    ESP_ERROR_CHECK(gpio_config(&button));
+    esp_err_t err = gpio_install_isr_service(0);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
+        ESP_ERROR_CHECK(err);
+    }
+    ESP_ERROR_CHECK(gpio_isr_handler_add(DISPLAY_WAKE_GPIO, button_isr, NULL));
+    atomic_store(&s_button_armed, true);
+
+    // The button also ends light sleep
+    gpio_wakeup_enable(DISPLAY_WAKE_GPIO, GPIO_INTR_LOW_LEVEL);
+    esp_sleep_enable_gpio_wakeup();
+
+    LVGL_Set_Service(display_service);
+    ESP_LOGI(TAG, "Display power: %d%% -> %d%% after %ds -> off after %ds (button GPIO%d)",
+             DISPLAY_BRIGHTNESS_PCT, DISPLAY_DIM_PCT, DISPLAY_DIM_AFTER_MS / 1000,
+             DISPLAY_OFF_AFTER_MS / 1000, DISPLAY_WAKE_GPIO);
+}
+
+void aquarium_display_wake(void) {
+    atomic_store(&s_wake_request, true);
+    LVGL_Wake();
+}
+
+aquarium_display_state_t aquarium_display_get_state(void) {
+    return s_state;
+}
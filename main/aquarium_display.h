@@ -0,0 +1,46 @@
+/**
+ * @file aquarium_display.h
+ * @brief Display power states: active -> dimmed -> off (backlight 0 + SLPIN)
+ *
+ * Runs as the LVGL task's service hook, so every transition happens under
+ * the LVGL lock and the task only wakes when a transition is due.
+ * Brightness changes are LEDC hardware fades. Dimmed stops the UI's
+ * decorative animations. While off, the UI is suspended (no rendering,
+ * no SPI) but the screen objects stay; the panel keeps its frame memory
+ * and comes back without a rebuild.
+ *
+ * Wakes on the button, on an alarm (out of range, trend warning, sensor
+ * lost; the display stays on while it lasts) or aquarium_display_wake().
+ */
+
+#ifndef AQUARIUM_DISPLAY_H
+#define AQUARIUM_DISPLAY_H
+
+#include <stdbool.h>
+
+#define DISPLAY_BRIGHTNESS_PCT  50      // Active
+#define DISPLAY_DIM_PCT         8       // Dimmed
+#define DISPLAY_DIM_AFTER_MS    60000   // Inactivity before dimming
+#define DISPLAY_OFF_AFTER_MS    300000  // Inactivity before panel sleep
+#define DISPLAY_FADE_MS         1500    // Dim / off fade
+#define DISPLAY_WAKE_FADE_MS    250     // Back to full brightness
+#define DISPLAY_SLPOUT_MS       120     // ST7789: SLPOUT -> stable picture
+#define DISPLAY_WAKE_GPIO       9       // BOOT button, active low
+
+typedef enum {
+    DISPLAY_ACTIVE,
+    DISPLAY_DIMMED,
+    DISPLAY_FADING_OFF,     // Backlight fading to 0, panel still awake
+    DISPLAY_OFF,            // Backlight 0, SLPIN, UI suspended
+    DISPLAY_WAKING,         // SLPOUT sent, backlight fades in when stable
+} aquarium_display_state_t;
+
+// Backlight on, button armed, service hook registered. Before LVGL_Start_Task().
+void aquarium_display_init(void);
+
+// User activity from any task: back to full brightness, timers restart
+void aquarium_display_wake(void);
+
+aquarium_display_state_t aquarium_display_get_state(void);
+
+#endif // AQUARIUM_DISPLAY_H
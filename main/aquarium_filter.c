@@ -0,0 +1,100 @@
+/**
+ * @file aquarium_filter.c
+ * @brief Per-sensor outlier filter: sliding median, then a gated 1-D Kalman
+ *
+ * Kalman state is Q8 fixed point; the gain is Q16. Per sample: a sort of
+ * at most 7 values and a handful of 64-bit multiplies.
+ */
+
+#include "aquarium_filter.h"
+#include <string.h>
+
+void aquarium_filter_init(aquarium_filter_t *f, const aquarium_filter_config_t *cfg) {
+    memset(f, 0, sizeof(*f));
+    f->cfg = *cfg;
+    if (f->cfg.median_window < 1 || f->cfg.median_window > FILTER_MEDIAN_MAX) {
+        f->cfg.median_window = 1;
+    }
+    f->cfg.median_window |= 1;
+}
+
+static int16_t median_push(aquarium_filter_t *f, int16_t v) {
+    uint8_t n = f->cfg.median_window;
+    f->ring[f->ring_pos] = v;
+    f->ring_pos = (f->ring_pos + 1) % n;
+    if (f->ring_fill < n) {
+        f->ring_fill++;
+    }
+
+    // Insertion sort of a copy (<= 7 values)
+    int16_t s[FILTER_MEDIAN_MAX];
+    for (int i = 0; i < f->ring_fill; i++) {
+        int16_t x = f->ring[i];
+        int j = i;
+        while (j > 0 && s[j - 1] > x) {
+            s[j] = s[j - 1];
+            j--;
+        }
+        s[j] = x;
+    }
+    return s[f->ring_fill / 2];
+}
+
+static void kalman_restart(aquarium_filter_t *f, int16_t z) {
+    f->x_q8 = (int32_t)z << 8;
+    f->p_q8 = (int32_t)f->cfg.measurement_noise << 8;
+    f->reject_run = 0;
+}
+
+void aquarium_filter_set_measurement_noise(aquarium_filter_t *f, uint16_t r) {
+    f->cfg.measurement_noise = r;
+}
+
+void aquarium_filter_set_process_noise(aquarium_filter_t *f, uint16_t q) {
+    f->cfg.process_noise = q;
+}
+
+bool aquarium_filter_update(aquarium_filter_t *f, int16_t centi, int16_t *out) {
+    f->stats.samples++;
+    int16_t z = median_push(f, centi);
+
+    if (!f->primed) {
+        kalman_restart(f, z);
+        f->primed = true;
+        *out = z;
+        return true;
+    }
+
+    // Predict: constant level, variance grows by Q
+    int32_t p = f->p_q8 + ((int32_t)f->cfg.process_noise << 8);
+    int32_t r = (int32_t)f->cfg.measurement_noise << 8;
+    int32_t innov_q8 = ((int32_t)z << 8) - f->x_q8;
+
+    // Gate: innov^2 > g^2 * (P + R), all in Q8 units of centi^2
+    if (f->cfg.gate_sigma > 0) {
+        int64_t innov = innov_q8 / 256;
+        int64_t limit = (int64_t)f->cfg.gate_sigma * f->cfg.gate_sigma * (p + r);
+        if (innov * innov * 256 > limit) {
+            f->stats.rejected++;
+            if (++f->reject_run < f->cfg.max_rejects) {
+                f->p_q8 = p;
+                *out = (int16_t)((f->x_q8 + 128) >> 8);
+                return false;
+            }
+            // Persistent: the water really moved
+            f->stats.restarts++;
+            kalman_restart(f, z);
+            *out = z;
+            return true;
+        }
+    }
+    f->reject_run = 0;
+
+    // Update: K = P / (P + R)
+    int32_t k_q16 = (int32_t)(((int64_t)p << 16) / (p + r));
+    f->x_q8 += (int32_t)(((int64_t)k_q16 * innov_q8) >> 16);
+    f->p_q8 = p - (int32_t)(((int64_t)k_q16 * p) >> 16);
+
+    *out = (int16_t)((f->x_q8 + 128) >> 8);
+    return true;
+}
@@ -0,0 +1,59 @@
+/**
+ * @file aquarium_filter.h
+ * @brief Per-sensor outlier filter: sliding median, then a gated 1-D Kalman
+ *
+ * Integer only (centi-degC in, centi-degC out). The median removes single
+ * spikes; the Kalman stage smooths the rest and rejects samples whose
+ * innovation exceeds `gate_sigma` standard deviations. A run of rejected
+ * samples is taken as a real step and restarts the estimate there.
+ */
+
+#ifndef AQUARIUM_FILTER_H
+#define AQUARIUM_FILTER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define FILTER_MEDIAN_MAX   7
+
+typedef struct {
+    uint8_t median_window;      // Odd, 1..FILTER_MEDIAN_MAX (1 = no median)
+    uint16_t process_noise;     // Q: expected drift variance per sample (centi^2)
+    uint16_t measurement_noise; // R: sensor noise variance (centi^2)
+    uint8_t gate_sigma;         // Reject beyond this many sigma (0 = never)
+    uint8_t max_rejects;        // Consecutive rejects before restarting
+} aquarium_filter_config_t;
+
+typedef struct {
+    uint32_t samples;
+    uint32_t rejected;          // Innovation outside the gate
+    uint32_t restarts;          // Rejection runs taken as real steps
+} aquarium_filter_stats_t;
+
+typedef struct {
+    aquarium_filter_config_t cfg;
+    int16_t ring[FILTER_MEDIAN_MAX];
+    uint8_t ring_pos;
+    uint8_t ring_fill;
+    uint8_t reject_run;
+    bool primed;
+    int32_t x_q8;               // Estimate, centi-degC << 8
+    int32_t p_q8;               // Estimate variance, centi^2 << 8
+    aquarium_filter_stats_t stats;
+} aquarium_filter_t;
+
+void aquarium_filter_init(aquarium_filter_t *f, const aquarium_filter_config_t *cfg);
+
+// R follows the sensor resolution (quantization noise grows 4x per bit dropped)
+void aquarium_filter_set_measurement_noise(aquarium_filter_t *f, uint16_t r);
+
+// Q is drift per sample: it grows with the spacing between samples
+void aquarium_filter_set_process_noise(aquarium_filter_t *f, uint16_t q);
+
+/**
+ * Feed one reading.
+ * @return false if the sample was rejected (*out keeps the previous estimate)
+ */
+bool aquarium_filter_update(aquarium_filter_t *f, int16_t centi, int16_t *out);
+
+#endif // AQUARIUM_FILTER_H
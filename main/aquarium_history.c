@@ -0,0 +1,330 @@
+/**
+ * @file aquarium_history.c
+ * @brief Fixed-footprint temperature history (delta-encoded ring of blocks)
+ *
+ * A stable tank mostly produces zero deltas, which collapse into one
+ * growing run token; a one-LSB step (6 centi-degC at 12-bit) is one byte.
+ */
+
+#include "aquarium_history.h"
+#include <string.h>
+#include <assert.h>
+
+static_assert(sizeof(history_block_t) == 512, "history block must stay 512 bytes");
+
+#define VARINT_MAX 5
+
+// ============================================================================
+// Token Coding
+// ============================================================================
+
+static uint32_t zigzag(int32_t v) {
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static int32_t unzigzag(uint32_t v) {
+    return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+static int varint_put(uint8_t *p, uint32_t v) {
+    int n = 0;
+    while (v >= 0x80) {
+        p[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+static int varint_get(const uint8_t *p, uint32_t *v) {
+    uint32_t x = 0;
+    int n = 0;
+    do {
+        x |= (uint32_t)(p[n] & 0x7F) << (7 * n);
+    } while (p[n++] & 0x80);
+    *v = x;
+    return n;
+}
+
+#define TOKEN_DELTA(d)      (zigzag(d) << 1)
+#define TOKEN_RUN(n)        ((((uint32_t)(n) - 1) << 2) | 1)
+#define TOKEN_INTERVAL(ms)  (((uint32_t)(ms) << 2) | 3)
+
+// Longest spacing a token holds (30 bits, ~12.4 days)
+#define INTERVAL_MAX_MS     ((1u << 30) - 1)
+
+// ============================================================================
+// Block Iterator
+// ============================================================================
+
+typedef struct {
+    const history_block_t *b;
+    uint32_t emitted;
+    uint16_t pos;
+    uint32_t run_left;
+    uint32_t interval_ms;
+    int64_t t;
+    int16_t v;
+} block_iter_t;
+
+static void block_iter_init(block_iter_t *it, const history_block_t *b) {
+    it->b = b;
+    it->emitted = 0;
+    it->pos = 0;
+    it->run_left = 0;
+    it->interval_ms = b->interval_ms;
+    it->t = b->t0_us;
+    it->v = b->first;
+}
+
+// Step to the next sample (not called for the first one)
+static bool block_iter_advance(block_iter_t *it) {
+    const history_block_t *b = it->b;
+    while (it->run_left == 0) {
+        if (it->pos >= b->used) {
+            return false;
+        }
+        uint32_t tok;
+        it->pos += varint_get(&b->data[it->pos], &tok);
+        if ((tok & 1) == 0) {
+            it->v += (int16_t)unzigzag(tok >> 1);
+            it->t += (int64_t)it->interval_ms * 1000;
+            return true;
+        }
+        if ((tok & 3) == 1) {
+            it->run_left = (tok >> 2) + 1;
+        } else {
+            it->interval_ms = tok >> 2;
+        }
+    }
+    it->run_left--;
+    it->t += (int64_t)it->interval_ms * 1000;
+    return true;
+}
+
+static bool block_iter_next(block_iter_t *it, aquarium_history_point_t *out) {
+    if (it->emitted > 0 && !block_iter_advance(it)) {
+        return false;
+    }
+    it->emitted++;
+    out->time_us = it->t;
+    out->centi = it->v;
+    return true;
+}
+
+// Block by age: 0 = oldest
+static const history_block_t *block_at(const aquarium_history_t *h, int age) {
+    int idx = (h->head + 1 - h->used_blocks + age + HISTORY_BLOCK_COUNT) % HISTORY_BLOCK_COUNT;
+    return &h->blocks[idx];
+}
+
+// ============================================================================
+// Append
+// ============================================================================
+
+void aquarium_history_init(aquarium_history_t *h) {
+    memset(h, 0, sizeof(*h));
+    h->head = HISTORY_BLOCK_COUNT - 1;
+    h->run_off = -1;
+}
+
+static void start_block(aquarium_history_t *h, int64_t t, int16_t centi) {
+    h->head = (h->head + 1) % HISTORY_BLOCK_COUNT;
+    if (h->used_blocks < HISTORY_BLOCK_COUNT) {
+        h->used_blocks++;
+    }
+    history_block_t *b = &h->blocks[h->head];
+    b->t0_us = t;
+    b->interval_ms = h->interval_ms;
+    b->count = 1;
+    b->first = centi;
+    b->used = 0;
+    h->run_off = -1;
+    h->last_value = centi;
+    h->last_us = t;
+}
+
+void aquarium_history_append(aquarium_history_t *h, int64_t time_us, int16_t centi) {
+    if (h->used_blocks == 0) {
+        start_block(h, time_us, centi);
+        return;
+    }
+    history_block_t *b = &h->blocks[h->head];
+
+    // Snap to the expected slot, or record a new spacing
+    int64_t interval_us = (int64_t)h->interval_ms * 1000;
+    int64_t expected = h->last_us + interval_us;
+    int64_t off = time_us - expected;
+    bool on_grid = h->interval_ms > 0 && off <= interval_us / 4 && off >= -interval_us / 4;
+    uint32_t interval_ms = h->interval_ms;
+    if (!on_grid) {
+        int64_t dt_ms = (time_us - h->last_us + 500) / 1000;
+        if (dt_ms > INTERVAL_MAX_MS) {
+            // Too long a gap for a spacing token: restart at an absolute time
+            start_block(h, time_us, centi);
+            return;
+        }
+        interval_ms = dt_ms > 0 ? (uint32_t)dt_ms : 1;
+    }
+    int64_t t = h->last_us + (int64_t)interval_ms * 1000;
+    int32_t delta = (int32_t)centi - h->last_value;
+
+    // Same spacing, no change: grow the trailing run in place
+    if (on_grid && delta == 0 && h->run_off >= 0) {
+        // The run is the last token, so it may grow by a byte
+        uint32_t tok;
+        varint_get(&b->data[h->run_off], &tok);
+        uint8_t buf[VARINT_MAX];
+        int len = varint_put(buf, TOKEN_RUN((tok >> 2) + 2));
+        if (h->run_off + len <= HISTORY_BLOCK_DATA) {
+            memcpy(&b->data[h->run_off], buf, len);
+            b->used = h->run_off + len;
+            b->count++;
+            h->last_us = t;
+            return;
+        }
+    }
+
+    uint8_t buf[2 * VARINT_MAX];
+    int len = 0;
+    if (!on_grid) {
+        len += varint_put(&buf[len], TOKEN_INTERVAL(interval_ms));
+    }
+    int tok_off = len;
+    len += varint_put(&buf[len], delta == 0 ? TOKEN_RUN(1) : TOKEN_DELTA(delta));
+    h->interval_ms = interval_ms;
+
+    if (b->used + len > HISTORY_BLOCK_DATA) {
+        start_block(h, t, centi);
+        return;
+    }
+    memcpy(&b->data[b->used], buf, len);
+    h->run_off = delta == 0 ? (int16_t)(b->used + tok_off) : -1;
+    b->used += len;
+    b->count++;
+    h->last_value = centi;
+    h->last_us = t;
+}
+
+// ============================================================================
+// Queries
+// ============================================================================
+
+int aquarium_history_last(const aquarium_history_t *h, int n, aquarium_history_point_t *out) {
+    if (n <= 0) {
+        return 0;
+    }
+    // Walk back until enough samples are covered, then decode forward
+    uint32_t covered = 0;
+    int age = h->used_blocks;
+    while (age > 0 && covered < (uint32_t)n) {
+        age--;
+        covered += block_at(h, age)->count;
+    }
+    uint32_t skip = covered > (uint32_t)n ? covered - n : 0;
+
+    int count = 0;
+    for (; age < h->used_blocks; age++) {
+        block_iter_t it;
+        aquarium_history_point_t p;
+        block_iter_init(&it, block_at(h, age));
+        while (block_iter_next(&it, &p)) {
+            if (skip > 0) {
+                skip--;
+                continue;
+            }
+            out[count++] = p;
+        }
+    }
+    return count;
+}
+
+// Calls fn for every sample in [from_us, to_us]; stops early if fn returns false
+static void for_range(const aquarium_history_t *h, int64_t from_us, int64_t to_us,
+                      bool (*fn)(void *ctx, const aquarium_history_point_t *p), void *ctx) {
+    for (int age = 0; age < h->used_blocks; age++) {
+        // Blocks ending before the window are skipped without decoding
+        if (age + 1 < h->used_blocks && block_at(h, age + 1)->t0_us < from_us) {
+            continue;
+        }
+        const history_block_t *b = block_at(h, age);
+        if (b->t0_us > to_us) {
+            return;
+        }
+        block_iter_t it;
+        aquarium_history_point_t p;
+        block_iter_init(&it, b);
+        while (block_iter_next(&it, &p)) {
+            if (p.time_us > to_us) {
+                return;
+            }
+            if (p.time_us >= from_us && !fn(ctx, &p)) {
+                return;
+            }
+        }
+    }
+}
+
+typedef struct {
+    aquarium_history_point_t *out;
+    int count;
+    int max;
+} range_ctx_t;
+
+static bool range_collect(void *ctx, const aquarium_history_point_t *p) {
+    range_ctx_t *c = ctx;
+    c->out[c->count++] = *p;
+    return c->count < c->max;
+}
+
+int aquarium_history_range(const aquarium_history_t *h, int64_t from_us, int64_t to_us,
+                           aquarium_history_point_t *out, int max) {
+    range_ctx_t c = { .out = out, .count = 0, .max = max };
+    if (max > 0) {
+        for_range(h, from_us, to_us, range_collect, &c);
+    }
+    return c.count;
+}
+
+typedef struct {
+    uint32_t count;
+    int32_t min, max;
+    int64_t sum;
+} window_ctx_t;
+
+static bool window_accumulate(void *ctx, const aquarium_history_point_t *p) {
+    window_ctx_t *c = ctx;
+    if (p->centi < c->min) c->min = p->centi;
+    if (p->centi > c->max) c->max = p->centi;
+    c->sum += p->centi;
+    c->count++;
+    return true;
+}
+
+bool aquarium_history_window(const aquarium_history_t *h, int64_t from_us, int64_t to_us,
+                             aquarium_history_window_t *out) {
+    window_ctx_t c = { .count = 0, .min = INT16_MAX, .max = INT16_MIN, .sum = 0 };
+    for_range(h, from_us, to_us, window_accumulate, &c);
+    if (c.count == 0) {
+        return false;
+    }
+    int64_t half = c.count / 2;
+    out->count = c.count;
+    out->min = (int16_t)c.min;
+    out->max = (int16_t)c.max;
+    out->avg = (int16_t)((c.sum >= 0 ? c.sum + half : c.sum - half) / (int64_t)c.count);
+    return true;
+}
+
+void aquarium_history_get_info(const aquarium_history_t *h, aquarium_history_info_t *out) {
+    memset(out, 0, sizeof(*out));
+    for (int age = 0; age < h->used_blocks; age++) {
+        const history_block_t *b = block_at(h, age);
+        out->samples += b->count;
+        out->bytes += b->used;
+    }
+    if (h->used_blocks > 0) {
+        out->oldest_us = block_at(h, 0)->t0_us;
+        out->newest_us = h->last_us;
+    }
+}
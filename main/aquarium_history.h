@@ -0,0 +1,102 @@
+/**
+ * @file aquarium_history.h
+ * @brief Fixed-footprint temperature history (delta-encoded ring of blocks)
+ *
+ * Samples are centi-degC values. Each block holds an absolute first sample
+ * and a stream of varint tokens:
+ *
+ *   v & 1 == 0   one sample, delta = unzigzag(v >> 1)
+ *   v & 3 == 1   (v >> 2) + 1 samples with delta 0
+ *   v & 3 == 3   sample spacing becomes (v >> 2) ms
+ *
+ * Sample times are reconstructed from the spacing, to within a quarter
+ * of it. When the ring is full the oldest block is dropped.
+ *
+ * Not thread-safe: the owner serializes access (see aquarium_controller.c).
+ */
+
+#ifndef AQUARIUM_HISTORY_H
+#define AQUARIUM_HISTORY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// 128 blocks x 512 bytes = 64 KB. The days this covers depend on the water:
+// 7 days at the 5 s slots holds for typical drift (mostly zero-delta runs,
+// well under a byte per sample, and the adaptive interval stretches). The
+// worst case, every sample one 12-bit LSB off the last, costs a byte per
+// sample: about 3.6 days. Steps beyond 32 centi-degC take two bytes.
+#define HISTORY_BLOCK_COUNT     128
+#define HISTORY_BLOCK_DATA      488     // 512 minus the block header
+
+typedef struct {
+    int64_t t0_us;              // Time of the first sample
+    uint32_t interval_ms;       // Sample spacing at the first sample
+    uint32_t count;             // Samples in the block
+    int16_t first;              // First sample (absolute)
+    uint16_t used;              // Bytes of data[] in use
+    uint8_t data[HISTORY_BLOCK_DATA];
+} history_block_t;
+
+typedef struct {
+    history_block_t blocks[HISTORY_BLOCK_COUNT];
+    uint16_t head;              // Block being appended to
+    uint16_t used_blocks;       // Blocks holding data
+    int16_t run_off;            // Offset of a trailing zero-run token, -1 if none
+    int16_t last_value;
+    uint32_t interval_ms;
+    int64_t last_us;            // Reconstructed time of the last sample
+} aquarium_history_t;
+
+typedef struct {
+    int64_t time_us;
+    int16_t centi;              // 1/100 degC
+} aquarium_history_point_t;
+
+typedef struct {
+    uint32_t count;
+    int16_t min;
+    int16_t max;
+    int16_t avg;                // Rounded to nearest
+} aquarium_history_window_t;
+
+typedef struct {
+    uint32_t samples;           // Samples held
+    uint32_t bytes;             // Token bytes in use
+    int64_t oldest_us;          // Time span covered
+    int64_t newest_us;
+} aquarium_history_info_t;
+
+void aquarium_history_init(aquarium_history_t *h);
+
+/**
+ * Append a sample. Samples further than a quarter of the current spacing
+ * from where the next one is expected record a new spacing (gaps, interval
+ * changes), so times must not go backwards. A gap of 2^30 ms (~12.4 days)
+ * or more starts a new block.
+ */
+void aquarium_history_append(aquarium_history_t *h, int64_t time_us, int16_t centi);
+
+/**
+ * Last n samples, oldest first.
+ * @return number of points stored in out
+ */
+int aquarium_history_last(const aquarium_history_t *h, int n, aquarium_history_point_t *out);
+
+/**
+ * Samples with from_us <= time <= to_us, oldest first, at most max.
+ * @return number of points stored in out
+ */
+int aquarium_history_range(const aquarium_history_t *h, int64_t from_us, int64_t to_us,
+                           aquarium_history_point_t *out, int max);
+
+/**
+ * Min/max/avg over from_us <= time <= to_us.
+ * @return false if the window holds no sample
+ */
+bool aquarium_history_window(const aquarium_history_t *h, int64_t from_us, int64_t to_us,
+                             aquarium_history_window_t *out);
+
+void aquarium_history_get_info(const aquarium_history_t *h, aquarium_history_info_t *out);
+
+#endif // AQUARIUM_HISTORY_H
@@ -0,0 +1,116 @@
+/**
+ * @file aquarium_power.c
+ * @brief Light sleep between samples: esp_pm locks per activity + accounting
+ */
+
+#include "aquarium_power.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+#include <stdbool.h>
+#include <string.h>
+
+#if CONFIG_PM_ENABLE
+#include "esp_pm.h"
+#endif
+
+static const char *TAG = "POWER";
+
+// DFS range: full speed while an activity holds its lock, XTAL otherwise
+#define POWER_MAX_FREQ_MHZ  CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ
+#define POWER_MIN_FREQ_MHZ  40
+
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t s_active_mask;
+static int64_t s_since_us;                  // Start of the current idle/active period
+static int64_t s_act_since_us[POWER_ACT_COUNT];
+static aquarium_power_stats_t s_stats;
+
+#if CONFIG_PM_ENABLE
+static esp_pm_lock_handle_t s_pm_locks[POWER_ACT_COUNT];
+static const char *const s_lock_names[POWER_ACT_COUNT] = { "aq_sensor", "aq_ui" };
+#endif
+
+void aquarium_power_init(int64_t now_us) {
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_active_mask = 0;
+    s_since_us = now_us;
+
+#if CONFIG_PM_ENABLE
+    const esp_pm_config_t pm_config = {
+        .max_freq_mhz = POWER_MAX_FREQ_MHZ,
+        .min_freq_mhz = POWER_MIN_FREQ_MHZ,
+#if CONFIG_FREERTOS_USE_TICKLESS_IDLE
+        .light_sleep_enable = true,
+#endif
+    };
+    esp_err_t err = esp_pm_configure(&pm_config);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "⚠️ esp_pm_configure failed: %s", esp_err_to_name(err));
+    }
+    for (int i = 0; i < POWER_ACT_COUNT; i++) {
+        ESP_ERROR_CHECK(esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, s_lock_names[i], &s_pm_locks[i]));
+    }
+#if CONFIG_FREERTOS_USE_TICKLESS_IDLE
+    ESP_LOGI(TAG, "Power management: %d..%d MHz, automatic light sleep",
+             POWER_MIN_FREQ_MHZ, POWER_MAX_FREQ_MHZ);
+#else
+    ESP_LOGW(TAG, "⚠️ Power management: %d..%d MHz, no light sleep (needs CONFIG_FREERTOS_USE_TICKLESS_IDLE)",
+             POWER_MIN_FREQ_MHZ, POWER_MAX_FREQ_MHZ);
+#endif
+#else
+    ESP_LOGI(TAG, "Power management disabled (CONFIG_PM_ENABLE), accounting only");
+#endif
+}
+
+void aquarium_power_begin(aquarium_power_act_t act, int64_t now_us) {
+    taskENTER_CRITICAL(&s_lock);
+    bool held = s_active_mask & (1u << act);
+    if (!held) {
+        if (s_active_mask == 0) {
+            s_stats.wakes++;
+            s_stats.idle_us += now_us - s_since_us;
+            s_since_us = now_us;
+        }
+        s_active_mask |= 1u << act;
+        s_stats.act_wakes[act]++;
+        s_act_since_us[act] = now_us;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+#if CONFIG_PM_ENABLE
+    if (!held) {
+        esp_pm_lock_acquire(s_pm_locks[act]);
+    }
+#endif
+}
+
+void aquarium_power_end(aquarium_power_act_t act, int64_t now_us) {
+    taskENTER_CRITICAL(&s_lock);
+    bool held = s_active_mask & (1u << act);
+    if (held) {
+        s_stats.act_us[act] += now_us - s_act_since_us[act];
+        s_active_mask &= ~(1u << act);
+        if (s_active_mask == 0) {
+            s_stats.active_us += now_us - s_since_us;
+            s_since_us = now_us;
+        }
+    }
+    taskEXIT_CRITICAL(&s_lock);
+#if CONFIG_PM_ENABLE
+    if (held) {
+        esp_pm_lock_release(s_pm_locks[act]);
+    }
+#endif
+}
+
+void aquarium_power_get_stats(int64_t now_us, aquarium_power_stats_t *out) {
+    taskENTER_CRITICAL(&s_lock);
+    *out = s_stats;
+    if (s_active_mask == 0) {
+        out->idle_us += now_us - s_since_us;
+    } else {
+        out->active_us += now_us - s_since_us;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+}
@@ -0,0 +1,54 @@
+/**
+ * @file aquarium_power.h
+ * @brief Light sleep between samples: esp_pm locks per activity + accounting
+ *
+ * Each activity (1-Wire/LED/Matter work of the aquarium task, LVGL
+ * rendering) holds its own CPU_FREQ_MAX lock only while it runs. With no
+ * lock held, tickless idle lets the SoC enter light sleep; WiFi stays
+ * associated in modem sleep and wakes for the AP's DTIM beacons.
+ *
+ * The UI only lets the SoC sleep while it has nothing to animate: the
+ * status pulse (AQUARIUM_STATUS_PULSE) takes POWER_ACT_UI at UI_PULSE_FPS
+ * until aquarium_display.c dims the screen and stops it.
+ *
+ * The counters track what the schedule allows: how often the device
+ * leaves the all-idle state and how long it stays there. They are kept
+ * whether or not CONFIG_PM_ENABLE is set, so the schedule can be checked
+ * on the host and on a build without power management.
+ */
+
+#ifndef AQUARIUM_POWER_H
+#define AQUARIUM_POWER_H
+
+#include <stdint.h>
+
+typedef enum {
+    POWER_ACT_SENSOR,       // Aquarium task: bus, LED, history, Matter
+    POWER_ACT_UI,           // LVGL timers, rendering, flush
+    POWER_ACT_COUNT,
+} aquarium_power_act_t;
+
+typedef struct {
+    uint32_t wakes;                         // All idle -> something active
+    uint64_t idle_us;                       // Time with no activity (sleep possible)
+    uint64_t active_us;                     // Time with at least one activity
+    uint32_t act_wakes[POWER_ACT_COUNT];    // Per activity: begin() calls
+    uint64_t act_us[POWER_ACT_COUNT];       // Per activity: time between begin/end
+} aquarium_power_stats_t;
+
+/**
+ * Configure DFS + automatic light sleep (CONFIG_PM_ENABLE) and create the
+ * locks. Call once before the tasks start. `now_us` starts the accounting.
+ */
+void aquarium_power_init(int64_t now_us);
+
+// An activity starts: take its lock. Calls do not nest per activity.
+void aquarium_power_begin(aquarium_power_act_t act, int64_t now_us);
+
+// The activity is about to block: release its lock
+void aquarium_power_end(aquarium_power_act_t act, int64_t now_us);
+
+// Snapshot; `now_us` closes the current idle/active period
+void aquarium_power_get_stats(int64_t now_us, aquarium_power_stats_t *out);
+
+#endif // AQUARIUM_POWER_H
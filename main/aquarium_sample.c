@@ -0,0 +1,55 @@
+/**
+ * @file aquarium_sample.c
+ * @brief Lock-free publication of sensor samples (latched seqlock)
+ *
+ *   publish: seq odd  -> write copy 0 -> seq even -> write copy 1
+ *   read:    copy [seq & 1] is the one the writer is not touching;
+ *            retry if seq moved while copying
+ *
+ * Payload words are relaxed atomics so the racy copy is well defined.
+ */
+
+#include "aquarium_sample.h"
+#include <string.h>
+
+static void copy_in(atomic_uint *dst, const uint32_t *src) {
+    for (size_t i = 0; i < AQUARIUM_SAMPLE_WORDS; i++) {
+        atomic_store_explicit(&dst[i], src[i], memory_order_relaxed);
+    }
+}
+
+void aquarium_sample_publish(aquarium_sample_slot_t *slot, const aquarium_sample_t *sample) {
+    uint32_t words[AQUARIUM_SAMPLE_WORDS] = { 0 };
+    uint32_t seq = atomic_load_explicit(&slot->seq, memory_order_relaxed);
+
+    aquarium_sample_t record = *sample;
+    record.seq = seq / 2 + 1;
+    memcpy(words, &record, sizeof(record));
+
+    // Readers move to copy 1 while copy 0 is rewritten...
+    atomic_store_explicit(&slot->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    copy_in(slot->words[0], words);
+
+    // ...and back to the new copy 0 while copy 1 catches up
+    atomic_store_explicit(&slot->seq, seq + 2, memory_order_release);
+    atomic_thread_fence(memory_order_release);
+    copy_in(slot->words[1], words);
+}
+
+uint32_t aquarium_sample_read(aquarium_sample_slot_t *slot, aquarium_sample_t *out) {
+    uint32_t words[AQUARIUM_SAMPLE_WORDS];
+    uint32_t seq;
+
+    do {
+        seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        const atomic_uint *src = slot->words[seq & 1];
+        for (size_t i = 0; i < AQUARIUM_SAMPLE_WORDS; i++) {
+            words[i] = atomic_load_explicit(&src[i], memory_order_relaxed);
+        }
+        atomic_thread_fence(memory_order_acquire);
+    } while (atomic_load_explicit(&slot->seq, memory_order_relaxed) != seq);
+
+    memcpy(out, words, sizeof(*out));
+    return seq / 2;
+}
@@ -0,0 +1,64 @@
+/**
+ * @file aquarium_sample.h
+ * @brief Lock-free publication of sensor samples (single writer, many readers)
+ *
+ * The aquarium task publishes, the LVGL timer and other consumers read.
+ * A latched seqlock: two copies of the record and a sequence counter. The
+ * writer updates one copy while readers use the other, so a reader that
+ * preempts the writer on the single core never waits; a reader preempted
+ * by the writer simply retries.
+ */
+
+#ifndef AQUARIUM_SAMPLE_H
+#define AQUARIUM_SAMPLE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+// Temperatures travel as centi-degC integers (2496 = 24.96 degC): no soft-float
+// on the C6 between scratchpad and LED, UI, Matter and logs
+typedef int16_t temp_centi_t;
+
+// Tenths for display, rounded half away from zero (2496 -> 250 = 25.0)
+static inline int temp_centi_to_tenths(temp_centi_t c) {
+    return c >= 0 ? (c + 5) / 10 : (c - 5) / 10;
+}
+
+typedef struct {
+    int64_t timestamp_us;       // esp_timer time the reading was taken
+    temp_centi_t temp_centi;    // Last valid reading (kept on read failure)
+    int16_t trend_centi_h;      // Slope in centi-degC per hour (primary sensor)
+    int32_t eta_s;              // Seconds to the limit it heads for, -1 = none
+    uint32_t read_latency_us;   // Convert T start -> scratchpad read
+    uint32_t seq;               // Publication number (0 = nothing published yet)
+    uint8_t rom[8];             // 64-bit ROM code (family 0x28 ... CRC)
+    bool valid;                 // At least one good reading so far
+} aquarium_sample_t;
+
+#define AQUARIUM_SAMPLE_WORDS ((sizeof(aquarium_sample_t) + 3) / 4)
+
+typedef struct {
+    atomic_uint seq;                                // Bumped twice per publish
+    atomic_uint words[2][AQUARIUM_SAMPLE_WORDS];    // Copy [seq & 1] is stable
+} aquarium_sample_slot_t;
+
+/**
+ * Publish a new record. Only one task may write a slot. out->seq is ignored
+ * and replaced by the publication number.
+ */
+void aquarium_sample_publish(aquarium_sample_slot_t *slot, const aquarium_sample_t *sample);
+
+/**
+ * Copy the latest record (never torn). Safe from any task, never blocks.
+ * @return publication number, 0 if nothing was published yet
+ */
+uint32_t aquarium_sample_read(aquarium_sample_slot_t *slot, aquarium_sample_t *out);
+
+// Publication number without copying: compare with a previous read to skip
+// work when nothing changed
+static inline uint32_t aquarium_sample_seq(aquarium_sample_slot_t *slot) {
+    return atomic_load_explicit(&slot->seq, memory_order_acquire) / 2;
+}
+
+#endif // AQUARIUM_SAMPLE_H
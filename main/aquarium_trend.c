@@ -0,0 +1,107 @@
+/**
+ * @file aquarium_trend.c
+ * @brief Rate-of-change estimator: sliding least-squares slope and EWMA
+ *
+ * With x = t - base and n samples in the window:
+ *
+ *   slope = (n*Sxy - Sx*Sy) / (n*Sxx - Sx^2)
+ *
+ * Moving the origin by b keeps the sums exact:
+ *   Sxx -= 2b*Sx - n*b^2,  Sxy -= b*Sy,  Sx -= n*b
+ */
+
+#include "aquarium_trend.h"
+#include <string.h>
+
+void aquarium_trend_init(aquarium_trend_t *tr, const aquarium_trend_config_t *cfg) {
+    memset(tr, 0, sizeof(*tr));
+    tr->cfg = *cfg;
+}
+
+static void trend_rebase(aquarium_trend_t *tr, int32_t new_base) {
+    int64_t b = (int64_t)new_base - tr->base_s;
+    int64_t n = tr->count;
+    tr->sxx -= 2 * b * tr->sx - n * b * b;
+    tr->sxy -= b * tr->sy;
+    tr->sx -= n * b;
+    tr->base_s = new_base;
+}
+
+static void trend_drop_oldest(aquarium_trend_t *tr) {
+    int64_t x = (int64_t)tr->t_s[tr->head] - tr->base_s;
+    int64_t y = tr->y[tr->head];
+    tr->sx -= x;
+    tr->sy -= y;
+    tr->sxx -= x * x;
+    tr->sxy -= x * y;
+    tr->head = (tr->head + 1) % TREND_RING_SIZE;
+    tr->count--;
+}
+
+void aquarium_trend_push(aquarium_trend_t *tr, int32_t t_s, int16_t centi, aquarium_trend_result_t *out) {
+    // EWMA
+    if (!tr->primed) {
+        tr->ewma_q8 = (int32_t)centi << 8;
+        tr->primed = true;
+    } else {
+        tr->ewma_q8 += (((int32_t)centi << 8) - tr->ewma_q8) >> tr->cfg.ewma_shift;
+    }
+
+    // Window: age and capacity
+    while (tr->count > 0 &&
+           (tr->count == TREND_RING_SIZE || t_s - tr->t_s[tr->head] > (int32_t)tr->cfg.window_s)) {
+        trend_drop_oldest(tr);
+    }
+    if (tr->count == 0) {
+        tr->sx = tr->sy = tr->sxx = tr->sxy = 0;
+        tr->base_s = t_s;
+    } else {
+        trend_rebase(tr, tr->t_s[tr->head]);
+    }
+
+    int idx = (tr->head + tr->count) % TREND_RING_SIZE;
+    tr->t_s[idx] = t_s;
+    tr->y[idx] = centi;
+    tr->count++;
+    int64_t x = (int64_t)t_s - tr->base_s;
+    tr->sx += x;
+    tr->sy += centi;
+    tr->sxx += x * x;
+    tr->sxy += x * centi;
+
+    out->ewma = (int16_t)((tr->ewma_q8 + 128) >> 8);
+    out->samples = tr->count;
+    out->valid = false;
+    out->slope_centi_h = 0;
+
+    int64_t n = tr->count;
+    int64_t den = n * tr->sxx - tr->sx * tr->sx;
+    if (tr->count < tr->cfg.min_samples || den <= 0) {
+        return;
+    }
+    int64_t num = (n * tr->sxy - tr->sx * tr->sy) * 3600;
+    int64_t half = den / 2;
+    out->slope_centi_h = (int32_t)((num >= 0 ? num + half : num - half) / den);
+    out->valid = true;
+}
+
+int32_t aquarium_trend_eta_s(const aquarium_trend_result_t *res, int16_t low, int16_t high,
+                             int32_t min_slope_centi_h) {
+    if (!res->valid) {
+        return TREND_NO_ETA;
+    }
+    int32_t slope = res->slope_centi_h;
+    int32_t gap;
+    if (slope <= -min_slope_centi_h) {
+        gap = res->ewma - low;
+        slope = -slope;
+    } else if (slope >= min_slope_centi_h && slope > 0) {
+        gap = high - res->ewma;
+    } else {
+        return TREND_NO_ETA;
+    }
+    if (gap <= 0) {
+        return 0;
+    }
+    return (int32_t)((int64_t)gap * 3600 / slope);
+}
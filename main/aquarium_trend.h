@@ -0,0 +1,58 @@
+/**
+ * @file aquarium_trend.h
+ * @brief Rate-of-change estimator: sliding least-squares slope and EWMA
+ *
+ * The regression sums (n, Sx, Sy, Sxx, Sxy) are updated when a sample
+ * enters or leaves the window and rebased to the oldest sample, all in
+ * exact 64-bit integer math: O(1) per sample, no rescans. The ring only
+ * remembers what has to be subtracted later.
+ */
+
+#ifndef AQUARIUM_TREND_H
+#define AQUARIUM_TREND_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define TREND_RING_SIZE     256
+
+#define TREND_NO_ETA        (-1)
+
+typedef struct {
+    uint32_t window_s;          // Regression window (also capped by the ring)
+    uint16_t min_samples;       // Fewer: no slope reported
+    uint8_t ewma_shift;         // EWMA weight 1 / 2^shift
+} aquarium_trend_config_t;
+
+typedef struct {
+    aquarium_trend_config_t cfg;
+    int32_t t_s[TREND_RING_SIZE];
+    int16_t y[TREND_RING_SIZE];
+    uint16_t head;              // Oldest entry
+    uint16_t count;
+    int32_t base_s;             // Regression x origin (oldest sample)
+    int64_t sx, sy, sxx, sxy;
+    int32_t ewma_q8;            // centi-degC << 8
+    bool primed;                // EWMA seeded
+} aquarium_trend_t;
+
+typedef struct {
+    bool valid;                 // Enough samples for a slope
+    int16_t ewma;               // Smoothed level (centi-degC)
+    int32_t slope_centi_h;      // Least-squares slope (centi-degC per hour)
+    uint16_t samples;
+} aquarium_trend_result_t;
+
+void aquarium_trend_init(aquarium_trend_t *tr, const aquarium_trend_config_t *cfg);
+
+void aquarium_trend_push(aquarium_trend_t *tr, int32_t t_s, int16_t centi, aquarium_trend_result_t *out);
+
+/**
+ * Seconds until the smoothed level reaches the limit it is heading for
+ * (low when cooling, high when warming). 0 if already beyond it,
+ * TREND_NO_ETA if the slope is invalid or flatter than min_slope_centi_h.
+ */
+int32_t aquarium_trend_eta_s(const aquarium_trend_result_t *res, int16_t low, int16_t high,
+                             int32_t min_slope_centi_h);
+
+#endif // AQUARIUM_TREND_H
@@ -7,13 +7,20 @@
 #include "aquarium_ui.h"
 #include "aquarium_controller.h"
 #include "lvgl.h"
+#include "LVGL_Driver.h"
 #include "LVGL_UI/nemo_img.h"
 #include "esp_log.h"
 #include <stdio.h>
-#include <math.h>
+#include <stdlib.h>
+#include <string.h>
 
 static const char *TAG = "UI";
 
+// The pulse is an endless animation: the LVGL task (and the chip) wakes UI_PULSE_FPS times a second
+// while it runs, so it stops with the backlight dimmed or the panel asleep (decor_update)
+#define UI_STATUS_PULSE   AQUARIUM_STATUS_PULSE
+#define UI_PULSE_FPS      8     // Decorative: smooth enough for a 1 s fade, 1/4 of the refreshes
+
 // UI elements
 static lv_obj_t *nemo_img_obj = NULL;
 static lv_obj_t *temp_int_label = NULL;
@@ -27,6 +34,7 @@ static lv_obj_t *status_text = NULL;
 #define COLOR_CYAN        lv_color_hex(0x00D4FF)  // Same for temp and decimal
 #define COLOR_GREEN       lv_color_hex(0x22C55E)
 #define COLOR_RED         lv_color_hex(0xEF4444)
+#define COLOR_AMBER       lv_color_hex(0xF59E0B)  // Trend warning
 #define COLOR_GRAY        lv_color_hex(0x555555)  // CELSIUS darker like mockup
 
 // Fonts - Custom thin fonts for temperature
@@ -35,60 +43,192 @@ LV_FONT_DECLARE(font_temp_36);  // Montserrat Thin 36px
 LV_FONT_DECLARE(lv_font_montserrat_14);
 
 
+#if UI_STATUS_PULSE
 // Pulse animation for status dot
 static void pulse_anim_cb(void *var, int32_t v) {
     lv_obj_set_style_opa((lv_obj_t*)var, v, 0);
 }
 
-static void ui_update_timer_cb(lv_timer_t *timer) {
-    (void)timer;
+static bool s_pulse_running = false;
+
+static void pulse_set(bool on) {
+    if (on == s_pulse_running) {
+        return;
+    }
+    s_pulse_running = on;
+    if (!on) {
+        lv_anim_del(status_dot, pulse_anim_cb);
+        lv_obj_set_style_opa(status_dot, LV_OPA_COVER, 0);
+        return;
+    }
+    lv_anim_t a;
+    lv_anim_init(&a);
+    lv_anim_set_var(&a, status_dot);
+    lv_anim_set_values(&a, 255, 128);
+    lv_anim_set_time(&a, 1000);
+    lv_anim_set_playback_time(&a, 1000);
+    lv_anim_set_repeat_count(&a, LV_ANIM_REPEAT_INFINITE);
+    lv_anim_set_max_fps(&a, UI_PULSE_FPS);
+    lv_anim_set_exec_cb(&a, pulse_anim_cb);
+    lv_anim_start(&a);
+}
+#endif
+
+static bool s_active = true;            // Panel awake, updates running
+static bool s_dimmed = false;           // Backlight dimmed
+
+// Decorative animations only run while they can be seen
+static void decor_update(void) {
+#if UI_STATUS_PULSE
+    pulse_set(s_active && !s_dimmed);
+#endif
+}
+
+// ========== STATIC LAYER ==========
+// Nemo and CELSIUS never change. No dynamic widget's redraw area (coords +
+// ext draw size) reaches them, so an update repaints only the flat
+// background under that widget and the static objects are rendered once,
+// at boot: no cached layer needed. Moving things so that they overlap
+// makes every update redraw the static object too; warn about it.
+// aquarium_bench counts the static pixels each update redraws (static_px).
+static void ui_check_static_layer(void) {
+    lv_obj_t *const statics[] = { nemo_img_obj, celsius_label };
+    lv_obj_t *const dynamics[] = { temp_int_label, temp_dec_label, status_dot, status_text };
+
+    lv_obj_update_layout(lv_scr_act());
+    for (size_t d = 0; d < sizeof(dynamics) / sizeof(dynamics[0]); d++) {
+        lv_area_t redraw;
+        lv_obj_get_coords(dynamics[d], &redraw);
+        lv_coord_t ext = _lv_obj_get_ext_draw_size(dynamics[d]);
+        lv_area_increase(&redraw, ext, ext);
+        for (size_t s = 0; s < sizeof(statics) / sizeof(statics[0]); s++) {
+            if (_lv_area_is_on(&redraw, &statics[s]->coords)) {
+                ESP_LOGW(TAG, "⚠️ Dynamic widget %u overlaps static object %u: redrawn on every update",
+                         (unsigned)d, (unsigned)s);
+            }
+        }
+    }
+}
+
+// ========== BINDING: sample -> view -> changed widget properties ==========
+// LVGL invalidates on every setter, even when the value is unchanged, so the
+// update compares against what is on screen and only touches what differs.
+// An unchanged reading (most samples) redraws nothing.
+
+// What the screen shows for one sample
+typedef struct {
+    char temp_int[8];
+    char temp_dec[8];
+    lv_color_t temp_color;
+    char status[24];
+    lv_color_t status_color;
+} ui_view_t;
+
+static ui_view_t s_shown;
+static bool s_shown_valid = false;          // s_shown matches the widgets
+
+// Publication shown on screen (UINT32_MAX: nothing drawn yet)
+static uint32_t s_shown_seq = UINT32_MAX;
+
+// Runs on every new sample (aquarium_ui_notify_sample); the period is only a fallback
+#define UI_UPDATE_FALLBACK_MS 10000
+static lv_timer_t *s_update_timer = NULL;
+
+static void ui_view_from_sample(const aquarium_sample_t *sensor, bool valid, ui_view_t *v) {
+    if (!valid) {
+        snprintf(v->temp_int, sizeof(v->temp_int), "--");
+        snprintf(v->temp_dec, sizeof(v->temp_dec), ".-°");
+        v->temp_color = COLOR_GRAY;
+        snprintf(v->status, sizeof(v->status), "SENSOR?");
+        v->status_color = COLOR_RED;
+        return;
+    }
     
-    float temp = aquarium_get_last_temperature();
-    bool valid = aquarium_is_temperature_valid();
+    // Round to tenths once, then split (24.96 shows as 25.0)
+    int temp = sensor->temp_centi;
+    int tenths = temp_centi_to_tenths(temp);
+    int temp_int = tenths / 10;
+    int temp_frac = abs(tenths % 10);
+    snprintf(v->temp_int, sizeof(v->temp_int), "%s%d", (tenths < 0 && temp_int == 0) ? "-" : "", temp_int);
+    snprintf(v->temp_dec, sizeof(v->temp_dec), ".%d°", temp_frac);
     
-    if (!valid || isnan(temp)) {
-        lv_label_set_text(temp_int_label, "--");
-        lv_label_set_text(temp_dec_label, ".-°");
-        lv_obj_set_style_text_color(temp_int_label, COLOR_GRAY, 0);
-        lv_obj_set_style_text_color(temp_dec_label, COLOR_GRAY, 0);
-        lv_label_set_text(status_text, "SENSOR?");
-        lv_obj_set_style_text_color(status_text, COLOR_RED, 0);
-        lv_obj_set_style_bg_color(status_dot, COLOR_RED, 0);
-    } else {
-        int temp_int = (int)temp;
-        int temp_frac = (int)((temp - temp_int) * 10);
-        if (temp_frac < 0) temp_frac = -temp_frac;
-        
-        char buf_int[8], buf_dec[16];
-        snprintf(buf_int, sizeof(buf_int), "%d", temp_int);
-        snprintf(buf_dec, sizeof(buf_dec), ".%d°", temp_frac);
-        
-        lv_label_set_text(temp_int_label, buf_int);
-        lv_label_set_text(temp_dec_label, buf_dec);
-        
-        // Re-align decimal after integer
-        lv_obj_align_to(temp_dec_label, temp_int_label, LV_ALIGN_OUT_RIGHT_BOTTOM, 0, -12);
-        
-        if (temp < TEMP_MIN_NORMAL) {
-            lv_obj_set_style_text_color(temp_int_label, COLOR_RED, 0);
-            lv_obj_set_style_text_color(temp_dec_label, COLOR_RED, 0);
-            lv_label_set_text(status_text, "COLD!");
-            lv_obj_set_style_text_color(status_text, COLOR_RED, 0);
-            lv_obj_set_style_bg_color(status_dot, COLOR_RED, 0);
-        } else if (temp > TEMP_MAX_NORMAL) {
-            lv_obj_set_style_text_color(temp_int_label, COLOR_RED, 0);
-            lv_obj_set_style_text_color(temp_dec_label, COLOR_RED, 0);
-            lv_label_set_text(status_text, "HOT!");
-            lv_obj_set_style_text_color(status_text, COLOR_RED, 0);
-            lv_obj_set_style_bg_color(status_dot, COLOR_RED, 0);
+    if (temp < TEMP_MIN_NORMAL) {
+        v->temp_color = COLOR_RED;
+        snprintf(v->status, sizeof(v->status), "COLD!");
+        v->status_color = COLOR_RED;
+    } else if (temp > TEMP_MAX_NORMAL) {
+        v->temp_color = COLOR_RED;
+        snprintf(v->status, sizeof(v->status), "HOT!");
+        v->status_color = COLOR_RED;
+    } else if (sensor->eta_s >= 0 && sensor->eta_s < TREND_WARN_S) {
+        // In range but heading out: "COLD IN 2H" / "HOT IN 45M"
+        int minutes = sensor->eta_s / 60;
+        const char *what = sensor->trend_centi_h < 0 ? "COLD" : "HOT";
+        if (minutes >= 60) {
+            snprintf(v->status, sizeof(v->status), "%s IN %dH", what, (minutes + 30) / 60);
         } else {
-            lv_obj_set_style_text_color(temp_int_label, COLOR_CYAN, 0);
-            lv_obj_set_style_text_color(temp_dec_label, COLOR_CYAN, 0);
-            lv_label_set_text(status_text, "OPTIMAL");
-            lv_obj_set_style_text_color(status_text, COLOR_GREEN, 0);
-            lv_obj_set_style_bg_color(status_dot, COLOR_GREEN, 0);
+            snprintf(v->status, sizeof(v->status), "%s IN %dM", what, minutes);
         }
+        v->temp_color = COLOR_CYAN;
+        v->status_color = COLOR_AMBER;
+    } else {
+        v->temp_color = COLOR_CYAN;
+        snprintf(v->status, sizeof(v->status), "OPTIMAL");
+        v->status_color = COLOR_GREEN;
+    }
+}
+
+static bool ui_text_changed(const char *shown, const char *text) {
+    return !s_shown_valid || strcmp(shown, text) != 0;
+}
+
+static bool ui_color_changed(lv_color_t shown, lv_color_t color) {
+    return !s_shown_valid || shown.full != color.full;
+}
+
+static void ui_view_apply(const ui_view_t *v) {
+    bool int_changed = ui_text_changed(s_shown.temp_int, v->temp_int);
+    if (int_changed) {
+        lv_label_set_text(temp_int_label, v->temp_int);
+    }
+    if (ui_text_changed(s_shown.temp_dec, v->temp_dec)) {
+        lv_label_set_text(temp_dec_label, v->temp_dec);
+    }
+    if (int_changed) {
+        // The integer width changed: re-align the decimal after it
+        lv_obj_align_to(temp_dec_label, temp_int_label, LV_ALIGN_OUT_RIGHT_BOTTOM, 0, -12);
+    }
+    if (ui_color_changed(s_shown.temp_color, v->temp_color)) {
+        lv_obj_set_style_text_color(temp_int_label, v->temp_color, 0);
+        lv_obj_set_style_text_color(temp_dec_label, v->temp_color, 0);
+    }
+    if (ui_text_changed(s_shown.status, v->status)) {
+        lv_label_set_text(status_text, v->status);
+    }
+    if (ui_color_changed(s_shown.status_color, v->status_color)) {
+        lv_obj_set_style_text_color(status_text, v->status_color, 0);
+        lv_obj_set_style_bg_color(status_dot, v->status_color, 0);
     }
+    s_shown = *v;
+    s_shown_valid = true;
+}
+
+static void ui_update_timer_cb(lv_timer_t *timer) {
+    (void)timer;
+    
+    // Nothing published since the last redraw: labels are already current
+    uint32_t seq = aquarium_get_sample_seq(AQUARIUM_PRIMARY_SENSOR);
+    if (seq == s_shown_seq) {
+        return;
+    }
+    
+    aquarium_sample_t sensor = { .valid = false };
+    bool valid = aquarium_get_sample(AQUARIUM_PRIMARY_SENSOR, &sensor) && sensor.valid;
+    s_shown_seq = sensor.seq;
+    
+    ui_view_t view;
+    ui_view_from_sample(&sensor, valid, &view);
+    ui_view_apply(&view);
 }
 
 
@@ -140,15 +280,7 @@ void aquarium_ui_init(void) {
     lv_obj_align(status_dot, LV_ALIGN_BOTTOM_MID, -40, -35);
     
     // Pulse animation
-    lv_anim_t a;
-    lv_anim_init(&a);
-    lv_anim_set_var(&a, status_dot);
-    lv_anim_set_values(&a, 255, 128);
-    lv_anim_set_time(&a, 1000);
-    lv_anim_set_playback_time(&a, 1000);
-    lv_anim_set_repeat_count(&a, LV_ANIM_REPEAT_INFINITE);
-    lv_anim_set_exec_cb(&a, pulse_anim_cb);
-    lv_anim_start(&a);
+    decor_update();
     
     // ========== STATUS TEXT ==========
     status_text = lv_label_create(scr);
@@ -158,8 +290,40 @@ void aquarium_ui_init(void) {
     lv_obj_set_style_text_letter_space(status_text, 2, 0);
     lv_obj_align_to(status_text, status_dot, LV_ALIGN_OUT_RIGHT_MID, 8, 0);
     
-    // Update timer (500ms - sufficient for 5s temp updates)
-    lv_timer_create(ui_update_timer_cb, 500, NULL);
+    // Update timer: made ready by the controller on each sample
+    s_update_timer = lv_timer_create(ui_update_timer_cb, UI_UPDATE_FALLBACK_MS, NULL);
     
+    ui_check_static_layer();
     ESP_LOGI(TAG, "Neon Glow UI ready");
 }
+
+void aquarium_ui_set_active(bool active) {
+    if (s_update_timer == NULL) {
+        return;
+    }
+    s_active = active;
+    if (active) {
+        // Catch up with samples published while suspended
+        lv_timer_resume(s_update_timer);
+        lv_timer_ready(s_update_timer);
+    } else {
+        // Nothing left to invalidate: LVGL stops rendering on its own
+        lv_timer_pause(s_update_timer);
+    }
+    decor_update();
+}
+
+void aquarium_ui_set_dimmed(bool dimmed) {
+    s_dimmed = dimmed;
+    decor_update();
+}
+
+void aquarium_ui_notify_sample(void) {
+    if (s_update_timer == NULL) {
+        return;
+    }
+    LVGL_Lock(-1);
+    lv_timer_ready(s_update_timer);
+    LVGL_Unlock();
+    LVGL_Wake();
+}
@@ -6,6 +6,19 @@
 #ifndef AQUARIUM_UI_H
 #define AQUARIUM_UI_H
 
+#include <stdbool.h>
+
+// Build the screen. Call before LVGL_Start_Task().
 void aquarium_ui_init(void);
 
+// A new sample was published: redraw now. Safe from any task (takes the LVGL lock).
+void aquarium_ui_notify_sample(void);
+
+// Suspend (panel asleep) or resume updates and animations. The screen
+// objects stay; resuming redraws the latest sample. LVGL task only.
+void aquarium_ui_set_active(bool active);
+
+// Backlight dimmed: decorative animations stop (values keep updating). LVGL task only.
+void aquarium_ui_set_dimmed(bool dimmed);
+
 #endif
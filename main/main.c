@@ -5,8 +5,9 @@
  * Features:
  * - DS18B20 temperature sensor (5 sec interval)
  * - RGB LED at 18% brightness
- * - Display at 50% brightness
+ * - Display at 50% brightness, dims and sleeps when unattended
  * - Matter/HomeKit integration
+ * - Light sleep between samples (CONFIG_PM_ENABLE)
  * 
  * Manufacturer: Claude&Silviu
  * Model: Senzor Apa
@@ -16,15 +17,15 @@
 #include "RGB.h"
 #include "Wireless.h"
 #include "aquarium_controller.h"
+#include "aquarium_power.h"
 #include "aquarium_ui.h"
+#include "aquarium_display.h"
 #include "Matter/aquarium_matter.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 
 static const char *TAG = "MAIN";
 
-// Display brightness (0-100)
-#define DISPLAY_BRIGHTNESS 50
-
 void app_main(void)
 {
     ESP_LOGI(TAG, "");
@@ -32,14 +33,16 @@ void app_main(void)
     ESP_LOGI(TAG, "   by Claude&Silviu");
     ESP_LOGI(TAG, "");
     
+    // Power management (before any driver takes a PM lock)
+    aquarium_power_init(esp_timer_get_time());
+    
     // RGB LED (first - no dependencies)
     RGB_Init();
     ESP_LOGI(TAG, "✓ RGB LED (18%% brightness)");
     
     // Display (before WiFi - uses SPI2)
     LCD_Init();
-    BK_Light(DISPLAY_BRIGHTNESS);
-    ESP_LOGI(TAG, "✓ Display (%d%% brightness)", DISPLAY_BRIGHTNESS);
+    ESP_LOGI(TAG, "✓ LCD panel");
     
     // LVGL
     LVGL_Init();
@@ -50,8 +53,12 @@ void app_main(void)
     // UI
     aquarium_ui_init();
     
-    // Force first UI render before WiFi/Matter (which take time)
-    lv_timer_handler();
+    // Display power states (dims, then sleeps; button or alarm wakes it)
+    aquarium_display_init();
+    ESP_LOGI(TAG, "✓ Display (%d%% brightness)", DISPLAY_BRIGHTNESS_PCT);
+    
+    // LVGL task: first render now, before WiFi/Matter (which take time)
+    LVGL_Start_Task();
     
     // WiFi (needed for Matter)
     ESP_LOGI(TAG, "");
@@ -74,15 +81,16 @@ void app_main(void)
     ESP_LOGI(TAG, "");
     ESP_LOGI(TAG, "========================================");
     ESP_LOGI(TAG, "🐠 READY!");
-    ESP_LOGI(TAG, "   Temperature: every 5 seconds");
+#if TEMP_ADAPTIVE_INTERVAL
+    ESP_LOGI(TAG, "   Temperature: every %d-%d s, adaptive",
+             TEMP_UPDATE_INTERVAL_MS / 1000, TEMP_UPDATE_INTERVAL_MAX_MS / 1000);
+#else
+    ESP_LOGI(TAG, "   Temperature: every %d s", TEMP_UPDATE_INTERVAL_MS / 1000);
+#endif
     ESP_LOGI(TAG, "   Range: 23°C - 28°C");
     ESP_LOGI(TAG, "   Pairing code: 20202021");
     ESP_LOGI(TAG, "========================================");
     ESP_LOGI(TAG, "");
     
-    // LVGL main loop
-    while (1) {
-        vTaskDelay(pdMS_TO_TICKS(10));
-        lv_timer_handler();
-    }
+    // LVGL runs in its own task from here on; app_main may return
 }